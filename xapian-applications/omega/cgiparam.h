@@ -37,6 +37,9 @@ extern void decode_post();
 /* decode the query as a GET */
 extern void decode_get();
 
+/* decode the query from a URL-encoded string (a query string or POST body) */
+extern void decode_string(const std::string& s);
+
 extern std::multimap<std::string, std::string> cgi_params;
 
 #endif // OMEGA_INCLUDED_CGIPARAM_H
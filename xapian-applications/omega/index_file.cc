@@ -9,6 +9,7 @@
  * Copyright 2012 Mihai Bivol
  * Copyright 2019 Bruno Baruffaldi
  * Copyright 2020 Parth Kapadia
+ * Copyright 2026 agent
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License as
@@ -31,8 +32,10 @@
 #include "index_file.h"
 
 #include <algorithm>
+#include <deque>
 #include <iostream>
 #include <limits>
+#include <sstream>
 #include <string>
 #include <map>
 #include <vector>
@@ -41,11 +44,16 @@
 #include "safeunistd.h"
 #include <cassert>
 #include <cerrno>
+#include <csignal>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include "safefcntl.h"
+#include "safesyswait.h"
 #include <ctime>
+#ifdef HAVE_FORK
+# include <poll.h>
+#endif
 
 #include <xapian.h>
 
@@ -62,6 +70,7 @@
 #include "msxmlparser.h"
 #include "opendocmetaparser.h"
 #include "opendocparser.h"
+#include "parseint.h"
 #include "pkglibbindir.h"
 #include "runfilter.h"
 #include "sample.h"
@@ -91,6 +100,7 @@ static dup_action_type dup_action;
 static bool ignore_exclusions;
 static bool description_as_sample;
 static bool date_terms;
+static bool index_spelling;
 
 static time_t last_altered_max;
 static size_t sample_size;
@@ -106,6 +116,53 @@ static Failed failed;
 
 map<string, Filter> commands;
 
+/// The maximum number of files to extract text from in parallel.
+static unsigned jobs = 1;
+
+/** Set in a process forked to index a single file.
+ *
+ *  Changes which need to persist beyond the current file are appended to
+ *  job_report for the parent process to act on, instead of being made
+ *  directly.
+ */
+static bool in_job = false;
+
+static string job_report;
+
+/// Codes used in job_report.
+enum {
+    JOB_OUTPUT = 'O',
+    JOB_FAILED = 'F',
+    JOB_DISABLE_FILTER = 'X',
+    JOB_DOCUMENT = 'D',
+    JOB_COMMIT_AND_EXIT = 'C',
+    JOB_ERROR = 'E'
+};
+
+/// Append @a s to report @a out.
+static void
+report_string(string& out, const string& s)
+{
+    out += str(s.size());
+    out += ':';
+    out += s;
+}
+
+/// Read a string appended by report_string() from a report.
+static bool
+read_report_string(const char** p, const char* end, string& s)
+{
+    auto colon = static_cast<const char*>(memchr(*p, ':', end - *p));
+    if (!colon) return false;
+    size_t len;
+    if (!parse_unsigned(string(*p, colon).c_str(), len)) return false;
+    ++colon;
+    if (size_t(end - colon) < len) return false;
+    s.assign(colon, len);
+    *p = colon + len;
+    return true;
+}
+
 static void
 mark_as_seen(Xapian::docid did)
 {
@@ -119,7 +176,13 @@ void
 skip(const string& urlterm, const string& context, const string& msg,
      off_t size, time_t last_mod, unsigned flags)
 {
-    failed.add(urlterm, last_mod, size);
+    if (in_job) {
+	job_report += char(JOB_FAILED);
+	report_string(job_report, str(last_mod));
+	report_string(job_report, str(size));
+    } else {
+	failed.add(urlterm, last_mod, size);
+    }
 
     if (!verbose || (flags & SKIP_SHOW_FILENAME)) {
 	if (!verbose && (flags & SKIP_VERBOSE_ONLY)) return;
@@ -129,6 +192,17 @@ skip(const string& urlterm, const string& context, const string& msg,
     cout << "Skipping - " << msg << endl;
 }
 
+/// Don't try the filter for @a filter_entry again for this run.
+static void
+disable_filter(const string& filter_entry)
+{
+    if (in_job) {
+	job_report += char(JOB_DISABLE_FILTER);
+	report_string(job_report, filter_entry);
+    }
+    commands[filter_entry] = Filter();
+}
+
 static void
 skip_cmd_failed(const string& urlterm, const string& context,
 		const char* const cmd[],
@@ -420,7 +494,7 @@ index_init(const string& dbpath, const Xapian::Stem& stemmer,
 	   bool overwrite, bool retry_failed_,
 	   bool delete_removed_documents, bool verbose_, bool use_ctime_,
 	   bool spelling, bool ignore_exclusions_, bool description_as_sample_,
-	   bool date_terms_)
+	   bool date_terms_, unsigned jobs_)
 {
     root = root_;
     site_term = site_term_;
@@ -435,6 +509,8 @@ index_init(const string& dbpath, const Xapian::Stem& stemmer,
     ignore_exclusions = ignore_exclusions_;
     description_as_sample = description_as_sample_;
     date_terms = date_terms_;
+    index_spelling = spelling;
+    jobs = jobs_;
 
     if (!overwrite) {
 	db = Xapian::WritableDatabase(dbpath, Xapian::DB_CREATE_OR_OPEN);
@@ -717,60 +793,17 @@ index_add_document(const string& urlterm, time_t last_altered,
     }
 }
 
-void
-index_mimetype(const string& file, const string& urlterm, const string& url,
-	       const string& ext,
-	       string mimetype,
-	       DirectoryIterator& d,
-	       string pathterm,
-	       string record)
+static void
+extract_and_index(const string& file, const string& urlterm,
+		  const string& url, const string& ext,
+		  const string& mimetype,
+		  DirectoryIterator& d,
+		  string pathterm,
+		  string record,
+		  const string& context,
+		  time_t last_altered,
+		  Xapian::docid did)
 {
-    string context(file, root.size(), string::npos);
-
-    // FIXME: We could be cleverer here and check mtime too when use_ctime is
-    // set - if the ctime has changed but the mtime is unchanged, we can just
-    // update the existing Document and avoid having to re-extract text, etc.
-    time_t last_altered = use_ctime ? d.get_ctime() : d.get_mtime();
-
-    Xapian::docid did = 0;
-    if (index_check_existing(urlterm, last_altered, did))
-	return;
-
-    if (!retry_failed) {
-	// We only store and check the mtime (last modified) - a change to the
-	// metadata won't generally cause a previous failure to now work
-	// (FIXME: except permissions).
-	time_t failed_last_mod;
-	off_t failed_size;
-	if (failed.contains(urlterm, failed_last_mod, failed_size)) {
-	    if (d.get_mtime() <= failed_last_mod &&
-		d.get_size() == failed_size) {
-		if (verbose)
-		    cout << "failed to extract text on earlier run" << endl;
-		return;
-	    }
-	    // The file has changed, so remove the entry for it.  If it fails
-	    // again on this attempt, we'll add a new one.
-	    failed.del(urlterm);
-	}
-    }
-
-    // If we didn't get the mime type from the extension, call libmagic to get
-    // it.
-    if (mimetype.empty()) {
-	mimetype = d.get_magic_mimetype();
-	if (mimetype.empty()) {
-	    skip(urlterm, file.substr(root.size()),
-		 "Unknown extension and unrecognised format",
-		 d.get_size(), d.get_mtime(), SKIP_SHOW_FILENAME);
-	    return;
-	}
-    }
-
-    if (verbose)
-	cout << "Indexing \"" << file.substr(root.size()) << "\" as "
-	     << mimetype << " ... " << flush;
-
     // Use `file` as the basis, as we don't want URL encoding in these terms,
     // but need to switch over the initial part so we get `/~olly/foo/bar` not
     // `/home/olly/public_html/foo/bar`.
@@ -825,7 +858,7 @@ index_mimetype(const string& file, const string& urlterm, const string& url,
 		    } else {
 			filter_entry = mimetype;
 		    }
-		    commands[filter_entry] = Filter();
+		    disable_filter(filter_entry);
 		}
 		return;
 	    }
@@ -1584,7 +1617,12 @@ index_mimetype(const string& file, const string& urlterm, const string& url,
 	}
 	newdocument.add_boolean_term(ext_term);
 
-	index_add_document(urlterm, last_altered, did, newdocument);
+	if (in_job) {
+	    job_report += char(JOB_DOCUMENT);
+	    report_string(job_report, newdocument.serialise());
+	} else {
+	    index_add_document(urlterm, last_altered, did, newdocument);
+	}
     } catch (const ReadError&) {
 	skip(urlterm, context, string("can't read file: ") + strerror(errno),
 	     d.get_size(), d.get_mtime());
@@ -1599,7 +1637,7 @@ index_mimetype(const string& file, const string& urlterm, const string& url,
 	m += filter_entry;
 	m += "\" not installed";
 	skip(urlterm, context, m, d.get_size(), d.get_mtime());
-	commands[filter_entry] = Filter();
+	disable_filter(filter_entry);
     } catch (const FileNotFound&) {
 	skip(urlterm, context, "File removed during indexing",
 	     d.get_size(), d.get_mtime(),
@@ -1617,9 +1655,601 @@ index_mimetype(const string& file, const string& urlterm, const string& url,
     }
 }
 
+#if defined HAVE_FORK && defined HAVE_WAITPID
+/// A file being indexed by a job process.
+struct Job {
+    /// Set once the job's report has been read (or the process died).
+    bool finished = false;
+
+    /// Output from this process to show before the job's output.
+    string output;
+
+    /// The job_report from the process.
+    string report;
+
+    string urlterm;
+
+    string context;
+
+    off_t size;
+
+    time_t last_mod;
+
+    time_t last_altered;
+
+    Xapian::docid did;
+};
+
+/** A forked process which indexes files for us.
+ *
+ *  These are started as needed and then kept running until indexing is
+ *  finished, so any assistant processes they start are reused for later
+ *  files too.
+ */
+struct JobProcess {
+    pid_t pid = -1;
+
+    /// Pipe to send files to index to, or -1 if the process isn't running.
+    int to_fd = -1;
+
+    /// Pipe to read reports from, or -1 if the process isn't running.
+    int from_fd = -1;
+
+    /// Data read from from_fd which isn't a complete report yet.
+    string buf;
+
+    /// The job this process is working on, or nullptr if it's idle.
+    Job* job = nullptr;
+};
+
+/// Jobs in the order they were started.
+static deque<Job> pending_jobs;
+
+/// The number of entries in pending_jobs which haven't finished yet.
+static size_t running_jobs = 0;
+
+/// The job processes.
+static vector<JobProcess> job_processes;
+
+/** Buffer for output while jobs are pending.
+ *
+ *  This is used for cout when jobs > 1 so that output appears in the same
+ *  order as it would without --jobs.
+ */
+static stringbuf job_output;
+
+/// cout's original streambuf, if we've replaced it with job_output.
+static streambuf* real_cout_buf = nullptr;
+
+/// Write @a len bytes from @a p to @a fd.
+static bool
+write_all(int fd, const char* p, size_t len)
+{
+    while (len) {
+	ssize_t r = write(fd, p, len);
+	if (r < 0) {
+	    if (errno == EINTR) continue;
+	    return false;
+	}
+	p += r;
+	len -= r;
+    }
+    return true;
+}
+
+/// Write out and clear any buffered output.
+static void
+flush_job_output()
+{
+    if (!real_cout_buf) return;
+    cout.rdbuf(real_cout_buf);
+    cout << job_output.str() << flush;
+    job_output.str(string());
+    cout.rdbuf(&job_output);
+}
+
+/// Stop job process @a proc, killing it first if @a kill_it is true.
+static void
+stop_job_process(JobProcess& proc, bool kill_it)
+{
+    if (proc.pid < 0) return;
+    if (kill_it) kill(proc.pid, SIGTERM);
+    // Closing the pipe tells the process to exit once it's idle.
+    close(proc.to_fd);
+    close(proc.from_fd);
+    while (waitpid(proc.pid, NULL, 0) < 0 && errno == EINTR) { }
+    proc.pid = -1;
+    proc.to_fd = proc.from_fd = -1;
+    proc.buf.clear();
+    if (proc.job) {
+	proc.job->finished = true;
+	proc.job = nullptr;
+	--running_jobs;
+    }
+}
+
+/** Kill any jobs which are still running and discard their results.
+ *
+ *  Our own buffered output is still written out.
+ */
+static void
+abandon_jobs()
+{
+    for (auto& proc : job_processes) {
+	stop_job_process(proc, proc.job != nullptr);
+    }
+    if (!real_cout_buf) return;
+    cout.rdbuf(real_cout_buf);
+    real_cout_buf = nullptr;
+    for (auto& job : pending_jobs) {
+	cout << job.output;
+    }
+    cout << job_output.str() << flush;
+    job_output.str(string());
+    pending_jobs.clear();
+}
+
+/** Wait for at least one running job to produce more of its report.
+ *
+ *  Reports are read from all running jobs as they become available so that
+ *  a job never blocks writing its report while we wait for another.
+ */
+static void
+read_job_reports()
+{
+    vector<struct pollfd> fds;
+    vector<JobProcess*> fd_procs;
+    for (auto& proc : job_processes) {
+	if (!proc.job) continue;
+	struct pollfd pfd;
+	pfd.fd = proc.from_fd;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	fds.push_back(pfd);
+	fd_procs.push_back(&proc);
+    }
+    if (poll(fds.data(), fds.size(), -1) < 0) {
+	if (errno == EINTR) return;
+	throw CommitAndExit("poll() failed", errno);
+    }
+    for (size_t i = 0; i != fds.size(); ++i) {
+	if (fds[i].revents == 0) continue;
+	JobProcess& proc = *fd_procs[i];
+	char buf[4096];
+	ssize_t r = read(proc.from_fd, buf, sizeof(buf));
+	if (r < 0 && errno == EINTR) continue;
+	if (r <= 0) {
+	    // The process died (or there was an error reading from it) so the
+	    // job's report will be incomplete and fail to parse.
+	    stop_job_process(proc, false);
+	    continue;
+	}
+	proc.buf.append(buf, r);
+	// Each report is sent using report_string().
+	const char* p = proc.buf.data();
+	if (!read_report_string(&p, p + proc.buf.size(), proc.job->report)) {
+	    continue;
+	}
+	proc.buf.erase(0, p - proc.buf.data());
+	proc.job->finished = true;
+	proc.job = nullptr;
+	--running_jobs;
+    }
+}
+
+/// Act on the report from a job which has finished.
+static void
+handle_job_report(const Job& job)
+{
+    cout.rdbuf(real_cout_buf);
+    cout << job.output;
+    const char* p = job.report.data();
+    const char* end = p + job.report.size();
+    string s;
+    time_t last_mod;
+    off_t size;
+    bool complete = !job.report.empty();
+    while (complete && p != end) {
+	switch (*p++) {
+	    case JOB_OUTPUT:
+		if (!read_report_string(&p, end, s)) break;
+		cout << s;
+		continue;
+	    case JOB_FAILED:
+		if (!read_report_string(&p, end, s) ||
+		    !parse_signed(s.c_str(), last_mod) ||
+		    !read_report_string(&p, end, s) ||
+		    !parse_signed(s.c_str(), size)) {
+		    break;
+		}
+		failed.add(job.urlterm, last_mod, size);
+		continue;
+	    case JOB_DISABLE_FILTER:
+		if (!read_report_string(&p, end, s)) break;
+		commands[s] = Filter();
+		continue;
+	    case JOB_DOCUMENT: {
+		if (!read_report_string(&p, end, s)) break;
+		Xapian::Document doc = Xapian::Document::unserialise(s);
+		if (index_spelling) {
+		    // The job can't add to the spelling data, but every
+		    // unprefixed term comes from indexing text without a
+		    // prefix, which is what TermGenerator adds as spellings.
+		    for (auto t = doc.termlist_begin();
+			 t != doc.termlist_end(); ++t) {
+			const string& term = *t;
+			if (term[0] >= 'A' && term[0] <= 'Z') continue;
+			db.add_spelling(term, t.get_wdf());
+		    }
+		}
+		index_add_document(job.urlterm, job.last_altered, job.did,
+				   doc);
+		continue;
+	    }
+	    case JOB_COMMIT_AND_EXIT:
+		if (!read_report_string(&p, end, s)) break;
+		abandon_jobs();
+		throw CommitAndExit(s);
+	    case JOB_ERROR:
+		if (!read_report_string(&p, end, s)) break;
+		abandon_jobs();
+		throw s;
+	}
+	// Unknown code or truncated report.
+	complete = false;
+    }
+    if (!complete) {
+	// The job died before completing its report.
+	skip(job.urlterm, job.context, "indexing process failed",
+	     job.size, job.last_mod);
+    }
+    cout << flush;
+    cout.rdbuf(&job_output);
+}
+
+/** Wait for jobs until no more than the specified numbers remain.
+ *
+ *  Documents are added to the database in the order the jobs were started.
+ */
+static void
+wait_for_jobs(size_t max_running, size_t max_pending)
+{
+    while (true) {
+	while (!pending_jobs.empty() && pending_jobs.front().finished) {
+	    Job job = std::move(pending_jobs.front());
+	    pending_jobs.pop_front();
+	    handle_job_report(job);
+	}
+	if (pending_jobs.empty()) flush_job_output();
+	if (running_jobs <= max_running && pending_jobs.size() <= max_pending)
+	    break;
+	read_job_reports();
+    }
+}
+
+/** Position @a d on the entry @a leaf in directory @a dir.
+ *
+ *  A job process is sent files in the order the parent reads them from each
+ *  directory, so we usually just need to read on from the current position.
+ */
+static void
+find_directory_entry(DirectoryIterator& d, string& current_dir,
+		     const string& dir, const string& leaf)
+{
+    bool restarted = false;
+    if (dir != current_dir) {
+	current_dir.clear();
+	d.start(dir);
+	current_dir = dir;
+	restarted = true;
+    }
+    while (true) {
+	while (d.next()) {
+	    if (leaf == d.leafname()) return;
+	}
+	if (restarted) throw FileNotFound();
+	// The entry may be before our current position if another job process
+	// failed to find an earlier entry.
+	d.start(dir);
+	restarted = true;
+    }
+}
+
+/** Index files sent by the parent process - this function doesn't return.
+ *
+ *  Each file is sent using report_string(), and the report for it is sent
+ *  back the same way.  We exit when the parent closes @a in_fd.
+ */
+[[noreturn]] static void
+run_job_process(int in_fd, int out_fd)
+{
+    in_job = true;
+    if (index_spelling) {
+	// We add the spellings from the document in the parent process.
+	indexer.set_flags(Xapian::TermGenerator::flags(0),
+			  ~indexer.FLAG_SPELLING);
+    }
+    // The parent only passes us regular files, so following symlinks here
+    // just means we see the same file the parent did.
+    DirectoryIterator d(true);
+    string current_dir;
+    string buf;
+    while (true) {
+	string request;
+	const char* p = buf.data();
+	while (!read_report_string(&p, p + buf.size(), request)) {
+	    char data[4096];
+	    ssize_t r = read(in_fd, data, sizeof(data));
+	    if (r < 0 && errno == EINTR) continue;
+	    if (r <= 0) {
+		// Stop any assistant processes we started.
+		for (auto& cmd : commands) {
+		    if (cmd.second.worker) cmd.second.worker->stop();
+		}
+		// Each job process creates its own temporary directory if it
+		// needs one, since the filenames used within it are fixed.
+		remove_tmpdir();
+
+		// Exit without running destructors or atexit handlers, which
+		// would otherwise act on objects such as the database which we
+		// share with the parent process.
+		_exit(0);
+	    }
+	    buf.append(data, r);
+	    p = buf.data();
+	}
+	buf.erase(0, p - buf.data());
+
+	string file, urlterm, url, ext, mimetype, pathterm, record, context;
+	string leaf, s;
+	time_t last_altered = 0, last_mod = 0;
+	off_t size = 0;
+	Xapian::docid did = 0;
+	p = request.data();
+	const char* end = p + request.size();
+	if (!read_report_string(&p, end, file) ||
+	    !read_report_string(&p, end, urlterm) ||
+	    !read_report_string(&p, end, url) ||
+	    !read_report_string(&p, end, ext) ||
+	    !read_report_string(&p, end, mimetype) ||
+	    !read_report_string(&p, end, pathterm) ||
+	    !read_report_string(&p, end, record) ||
+	    !read_report_string(&p, end, context) ||
+	    !read_report_string(&p, end, leaf) ||
+	    !read_report_string(&p, end, s) ||
+	    !parse_signed(s.c_str(), last_altered) ||
+	    !read_report_string(&p, end, s) ||
+	    !parse_unsigned(s.c_str(), did) ||
+	    !read_report_string(&p, end, s) ||
+	    !parse_signed(s.c_str(), size) ||
+	    !read_report_string(&p, end, s) ||
+	    !parse_signed(s.c_str(), last_mod)) {
+	    _exit(1);
+	}
+
+	ostringstream out;
+	cout.rdbuf(out.rdbuf());
+	job_report.clear();
+	try {
+	    find_directory_entry(d, current_dir,
+				 file.substr(0, file.size() - leaf.size()),
+				 leaf);
+	    extract_and_index(file, urlterm, url, ext, mimetype, d, pathterm,
+			      record, context, last_altered, did);
+	} catch (const FileNotFound&) {
+	    skip(urlterm, context, "File removed during indexing",
+		 size, last_mod, SKIP_VERBOSE_ONLY | SKIP_SHOW_FILENAME);
+	} catch (const CommitAndExit& e) {
+	    job_report += char(JOB_COMMIT_AND_EXIT);
+	    report_string(job_report, e.what());
+	} catch (const Xapian::Error& e) {
+	    job_report += char(JOB_ERROR);
+	    report_string(job_report, e.get_description());
+	} catch (const exception& e) {
+	    job_report += char(JOB_ERROR);
+	    report_string(job_report, e.what());
+	} catch (const string& e) {
+	    job_report += char(JOB_ERROR);
+	    report_string(job_report, e);
+	} catch (const char* e) {
+	    job_report += char(JOB_ERROR);
+	    report_string(job_report, e);
+	} catch (...) {
+	    job_report += char(JOB_ERROR);
+	    report_string(job_report, "Caught unknown exception");
+	}
+
+	string report(1, char(JOB_OUTPUT));
+	report_string(report, out.str());
+	report += job_report;
+	string message;
+	report_string(message, report);
+	if (!write_all(out_fd, message.data(), message.size())) _exit(1);
+    }
+}
+
+/// Start job process @a proc.
+static void
+start_job_process(JobProcess& proc)
+{
+    int to_fds[2], from_fds[2];
+    if (pipe(to_fds) < 0) {
+	throw CommitAndExit("Failed to create pipe for job", errno);
+    }
+    if (pipe(from_fds) < 0) {
+	int pipe_errno = errno;
+	close(to_fds[0]);
+	close(to_fds[1]);
+	throw CommitAndExit("Failed to create pipe for job", pipe_errno);
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+	// Child process.
+	close(to_fds[1]);
+	close(from_fds[0]);
+	for (auto& other : job_processes) {
+	    if (other.pid < 0) continue;
+	    close(other.to_fd);
+	    close(other.from_fd);
+	}
+	run_job_process(to_fds[0], from_fds[1]);
+    }
+    int fork_errno = errno;
+    close(to_fds[0]);
+    close(from_fds[1]);
+    if (pid < 0) {
+	close(to_fds[1]);
+	close(from_fds[0]);
+	throw CommitAndExit("Failed to fork job", fork_errno);
+    }
+    proc.pid = pid;
+    proc.to_fd = to_fds[1];
+    proc.from_fd = from_fds[0];
+}
+
+/// Start a job to index a file.
+static void
+start_job(const string& file, const string& urlterm, const string& url,
+	  const string& ext, const string& mimetype,
+	  DirectoryIterator& d, const string& pathterm, const string& record,
+	  const string& context, time_t last_altered, Xapian::docid did)
+{
+    // Limit the number of jobs running, and also the number of finished
+    // jobs waiting for an earlier job to finish.
+    wait_for_jobs(jobs - 1, 2 * jobs - 1);
+
+    if (!real_cout_buf) {
+	real_cout_buf = cout.rdbuf(&job_output);
+	// Don't get killed by SIGPIPE if a job process dies while we're
+	// sending it a file.
+	signal(SIGPIPE, SIG_IGN);
+    }
+    if (job_processes.empty()) job_processes.resize(jobs);
+
+    string request;
+    report_string(request, file);
+    report_string(request, urlterm);
+    report_string(request, url);
+    report_string(request, ext);
+    report_string(request, mimetype);
+    report_string(request, pathterm);
+    report_string(request, record);
+    report_string(request, context);
+    report_string(request, d.leafname());
+    report_string(request, str(last_altered));
+    report_string(request, str(did));
+    report_string(request, str(d.get_size()));
+    report_string(request, str(d.get_mtime()));
+    string message;
+    report_string(message, request);
+
+    JobProcess* proc = nullptr;
+    for (auto& p : job_processes) {
+	if (!p.job) {
+	    proc = &p;
+	    break;
+	}
+    }
+    // wait_for_jobs() ensures at least one process is idle.
+    assert(proc);
+    if (proc->pid < 0) start_job_process(*proc);
+    if (!write_all(proc->to_fd, message.data(), message.size())) {
+	// The process must have died while idle, so start a new one.
+	stop_job_process(*proc, false);
+	start_job_process(*proc);
+	if (!write_all(proc->to_fd, message.data(), message.size())) {
+	    throw CommitAndExit("Failed to send file to job", errno);
+	}
+    }
+
+    Job job;
+    job.output = job_output.str();
+    job_output.str(string());
+    job.urlterm = urlterm;
+    job.context = context;
+    job.size = d.get_size();
+    job.last_mod = d.get_mtime();
+    job.last_altered = last_altered;
+    job.did = did;
+    pending_jobs.push_back(std::move(job));
+    proc->job = &pending_jobs.back();
+    ++running_jobs;
+}
+#endif
+
+void
+index_mimetype(const string& file, const string& urlterm, const string& url,
+	       const string& ext,
+	       string mimetype,
+	       DirectoryIterator& d,
+	       string pathterm,
+	       string record)
+{
+    string context(file, root.size(), string::npos);
+
+    // FIXME: We could be cleverer here and check mtime too when use_ctime is
+    // set - if the ctime has changed but the mtime is unchanged, we can just
+    // update the existing Document and avoid having to re-extract text, etc.
+    time_t last_altered = use_ctime ? d.get_ctime() : d.get_mtime();
+
+    Xapian::docid did = 0;
+    if (index_check_existing(urlterm, last_altered, did))
+	return;
+
+    if (!retry_failed) {
+	// We only store and check the mtime (last modified) - a change to the
+	// metadata won't generally cause a previous failure to now work
+	// (FIXME: except permissions).
+	time_t failed_last_mod;
+	off_t failed_size;
+	if (failed.contains(urlterm, failed_last_mod, failed_size)) {
+	    if (d.get_mtime() <= failed_last_mod &&
+		d.get_size() == failed_size) {
+		if (verbose)
+		    cout << "failed to extract text on earlier run" << endl;
+		return;
+	    }
+	    // The file has changed, so remove the entry for it.  If it fails
+	    // again on this attempt, we'll add a new one.
+	    failed.del(urlterm);
+	}
+    }
+
+    // If we didn't get the mime type from the extension, call libmagic to get
+    // it.
+    if (mimetype.empty()) {
+	mimetype = d.get_magic_mimetype();
+	if (mimetype.empty()) {
+	    skip(urlterm, file.substr(root.size()),
+		 "Unknown extension and unrecognised format",
+		 d.get_size(), d.get_mtime(), SKIP_SHOW_FILENAME);
+	    return;
+	}
+    }
+
+    if (verbose)
+	cout << "Indexing \"" << file.substr(root.size()) << "\" as "
+	     << mimetype << " ... " << flush;
+
+#if defined HAVE_FORK && defined HAVE_WAITPID
+    if (jobs > 1) {
+	start_job(file, urlterm, url, ext, mimetype, d, pathterm, record,
+		  context, last_altered, did);
+	return;
+    }
+#endif
+    extract_and_index(file, urlterm, url, ext, mimetype, d, pathterm, record,
+		      context, last_altered, did);
+}
+
 void
 index_handle_deletion()
 {
+#if defined HAVE_FORK && defined HAVE_WAITPID
+    // Any documents still being indexed need to be marked as seen first.
+    wait_for_jobs(0, 0);
+#endif
+
     if (updated.empty() || old_docs_not_seen == 0) return;
 
     if (verbose) {
@@ -1649,12 +2279,19 @@ index_handle_deletion()
 void
 index_commit()
 {
+#if defined HAVE_FORK && defined HAVE_WAITPID
+    wait_for_jobs(0, 0);
+#endif
     db.commit();
 }
 
 void
 index_done()
 {
+#if defined HAVE_FORK && defined HAVE_WAITPID
+    abandon_jobs();
+#endif
+
     // If we created a temporary directory then delete it.
     remove_tmpdir();
 }
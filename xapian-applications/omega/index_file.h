@@ -133,7 +133,7 @@ index_init(const std::string& dbpath, const Xapian::Stem& stemmer,
 	   bool overwrite, bool retry_failed_,
 	   bool delete_removed_documents, bool verbose_, bool use_ctime_,
 	   bool spelling, bool ignore_exclusions_, bool description_as_sample,
-	   bool date_terms);
+	   bool date_terms, unsigned jobs);
 
 void
 index_remove_failed_entry(const std::string& urlterm);
@@ -40,6 +40,7 @@
 #include "utils.h"
 #include "cgiparam.h"
 #include "query.h"
+#include "serve.h"
 #include "str.h"
 #include "stringutils.h"
 #include "expand.h"
@@ -87,13 +88,22 @@ map_dbname_to_dir(const string &database_name)
     return database_dir + database_name;
 }
 
+/// Databases kept open between requests when serving, indexed by name.
+static map<string, Xapian::Database> open_dbs;
+
 static void
 add_database(const string& this_dbname)
 {
     if (!dbname.empty()) dbname += '/';
     dbname += this_dbname;
 
-    Xapian::Database this_db(map_dbname_to_dir(this_dbname));
+    Xapian::Database this_db;
+    auto it = open_dbs.find(this_dbname);
+    if (it != open_dbs.end()) {
+	this_db = it->second;
+    } else {
+	this_db = Xapian::Database(map_dbname_to_dir(this_dbname));
+    }
     db.add_database(this_db);
 
     size_t this_db_size = this_db.size();
@@ -104,13 +114,12 @@ add_database(const string& this_dbname)
     }
 }
 
-// Get database(s) to search.
-template<typename IT>
-void
-parse_db_params(const pair<IT, IT>& dbs)
+// Call f for each database name in DB parameters.
+template<typename IT, typename F>
+static void
+for_each_db_param(const pair<IT, IT>& dbs, F f)
 {
-    dbname.resize(0);
-    // Only add a repeated db once.
+    // Only use a repeated db once.
     set<string> seen;
     for (auto i = dbs.first; i != dbs.second; ++i) {
 	const string& v = i->second;
@@ -120,7 +129,7 @@ parse_db_params(const pair<IT, IT>& dbs)
 	    q = v.find('/', p);
 	    string s(v, p, q - p);
 	    if (!s.empty() && seen.find(s) == seen.end()) {
-		add_database(s);
+		f(s);
 		seen.insert(s);
 	    }
 	    if (q == string::npos) break;
@@ -129,6 +138,56 @@ parse_db_params(const pair<IT, IT>& dbs)
     }
 }
 
+// Get database(s) to search.
+template<typename IT>
+static void
+parse_db_params(const pair<IT, IT>& dbs)
+{
+    dbname.resize(0);
+    for_each_db_param(dbs, add_database);
+}
+
+// Open a database to keep open between requests, or update it to the latest
+// revision if it's already open.
+static void
+keep_database_open(const string& this_dbname)
+{
+    try {
+	auto it = open_dbs.find(this_dbname);
+	if (it == open_dbs.end()) {
+	    open_dbs.emplace(this_dbname,
+			     Xapian::Database(map_dbname_to_dir(this_dbname)));
+	} else {
+	    it->second.reopen();
+	}
+    } catch (const Xapian::Error&) {
+	// Leave handling the request to report the problem.
+	open_dbs.erase(this_dbname);
+    }
+}
+
+// When serving, make sure the databases and template a request will use are
+// open and read before we fork to handle it, so that work is shared between
+// requests.
+static void
+prepare_request()
+{
+    bool any_db = false;
+    for_each_db_param(cgi_params.equal_range("DB"),
+		      [&any_db](const string& name) {
+			  keep_database_open(name);
+			  any_db = true;
+		      });
+    if (!any_db) keep_database_open(default_db);
+
+    auto val = cgi_params.find("FMT");
+    if (val != cgi_params.end() && !val->second.empty()) {
+	preload_template(val->second);
+    } else {
+	preload_template(default_template);
+    }
+}
+
 #define FILTER_CODE \
     "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz_-"
 
@@ -174,54 +233,10 @@ filters_append(const string& bterm, const string* prev)
     old_filters += filter_sep;
 }
 
-int main(int argc, char *argv[])
-try {
-    {
-	// Check for SERVER_PROTOCOL=INCLUDED, which is set when we're being
-	// included in a page via a server-side include directive.  In this
-	// case we suppress sending a Content-Type: header.
-	const char* p = getenv("SERVER_PROTOCOL");
-	if (p && strcmp(p, "INCLUDED") == 0) {
-	    suppress_http_headers = true;
-	}
-    }
-
-    read_config_file();
-
-    option["flag_default"] = "true";
-
-    // set default thousands and decimal separators: e.g. "16,729 hits" "1.4K"
-    option["decimal"] = ".";
-    option["thousand"] = ",";
-
-    // set the default stemming language
-    option["stemmer"] = DEFAULT_STEM_LANGUAGE;
-
-    // FIXME: set cout to linebuffered not stdout.  Or just flush regularly...
-    // setvbuf(stdout, NULL, _IOLBF, 0);
-
-    const char * method = getenv("REQUEST_METHOD");
-    if (method == NULL) {
-	if (argc > 1 && (argv[1][0] != '-' || strchr(argv[1], '='))) {
-	    // omega 'P=information retrieval' DB=papers
-	    // check for a leading '-' on the first arg so "omega --version",
-	    // "omega --help", and similar take the next branch
-	    decode_argv(argv + 1);
-	} else {
-	    // Seems we're running from the command line so give version
-	    // and allow a query to be entered for testing
-	    cout << PROGRAM_NAME " - " PACKAGE " " VERSION "\n";
-	    if (argc > 1) exit(0);
-	    cout << "Enter NAME=VALUE lines, end with blank line\n";
-	    decode_test();
-	}
-    } else {
-	if (*method == 'P')
-	    decode_post();
-	else
-	    decode_get();
-    }
-
+// Handle the request with parameters in cgi_params.
+static void
+handle_request()
+{
     try {
 	parse_db_params(cgi_params.equal_range("DB"));
 	if (dbname.empty()) {
@@ -726,24 +741,102 @@ try {
     }
 
     parse_omegascript();
-} catch (const Xapian::Error &e) {
-    if (!set_content_type && !suppress_http_headers)
-	cout << "Content-Type: text/html\n\n";
-    cout << "Exception: " << html_escape(e.get_description()) << endl;
-} catch (const std::exception &e) {
-    if (!set_content_type && !suppress_http_headers)
-	cout << "Content-Type: text/html\n\n";
-    cout << "Exception: std::exception " << html_escape(e.what()) << endl;
-} catch (const string &s) {
-    if (!set_content_type && !suppress_http_headers)
-	cout << "Content-Type: text/html\n\n";
-    cout << "Exception: " << html_escape(s) << endl;
-} catch (const char *s) {
+}
+
+// Report the exception currently being handled.
+static void
+report_exception()
+{
     if (!set_content_type && !suppress_http_headers)
 	cout << "Content-Type: text/html\n\n";
-    cout << "Exception: " << html_escape(s) << endl;
+    try {
+	throw;
+    } catch (const Xapian::Error &e) {
+	cout << "Exception: " << html_escape(e.get_description()) << endl;
+    } catch (const std::exception &e) {
+	cout << "Exception: std::exception " << html_escape(e.what()) << endl;
+    } catch (const string &s) {
+	cout << "Exception: " << html_escape(s) << endl;
+    } catch (const char *s) {
+	cout << "Exception: " << html_escape(s) << endl;
+    } catch (...) {
+	cout << "Caught unknown exception" << endl;
+    }
+}
+
+int main(int argc, char *argv[])
+try {
+    {
+	// Check for SERVER_PROTOCOL=INCLUDED, which is set when we're being
+	// included in a page via a server-side include directive.  In this
+	// case we suppress sending a Content-Type: header.
+	const char* p = getenv("SERVER_PROTOCOL");
+	if (p && strcmp(p, "INCLUDED") == 0) {
+	    suppress_http_headers = true;
+	}
+    }
+
+    read_config_file();
+
+    option["flag_default"] = "true";
+
+    // set default thousands and decimal separators: e.g. "16,729 hits" "1.4K"
+    option["decimal"] = ".";
+    option["thousand"] = ",";
+
+    // set the default stemming language
+    option["stemmer"] = DEFAULT_STEM_LANGUAGE;
+
+    // FIXME: set cout to linebuffered not stdout.  Or just flush regularly...
+    // setvbuf(stdout, NULL, _IOLBF, 0);
+
+    if (argc > 1 && startswith(argv[1], "--serve=")) {
+	// omega --serve=[HOST:]PORT [--workers=N]
+	unsigned workers = 4;
+	if (argc > 2) {
+	    const char* p = argv[2];
+	    if (argc > 3 || !startswith(p, "--workers=") ||
+		!parse_unsigned(p + CONST_STRLEN("--workers="), workers) ||
+		workers == 0) {
+		cerr << "Usage: " << argv[0]
+		     << " --serve=[HOST:]PORT [--workers=N]" << endl;
+		return 1;
+	    }
+	}
+	// We're the web server, so always send headers.
+	suppress_http_headers = false;
+	try {
+	    serve_http(argv[1] + CONST_STRLEN("--serve="), workers,
+		       prepare_request, handle_request, report_exception);
+	} catch (const string& e) {
+	    cerr << PROGRAM_NAME ": " << e << endl;
+	    return 1;
+	}
+    }
+
+    const char * method = getenv("REQUEST_METHOD");
+    if (method == NULL) {
+	if (argc > 1 && (argv[1][0] != '-' || strchr(argv[1], '='))) {
+	    // omega 'P=information retrieval' DB=papers
+	    // check for a leading '-' on the first arg so "omega --version",
+	    // "omega --help", and similar take the next branch
+	    decode_argv(argv + 1);
+	} else {
+	    // Seems we're running from the command line so give version
+	    // and allow a query to be entered for testing
+	    cout << PROGRAM_NAME " - " PACKAGE " " VERSION "\n";
+	    if (argc > 1) exit(0);
+	    cout << "Enter NAME=VALUE lines, end with blank line\n";
+	    decode_test();
+	}
+    } else {
+	if (*method == 'P')
+	    decode_post();
+	else
+	    decode_get();
+    }
+
+    handle_request();
 } catch (...) {
-    if (!set_content_type && !suppress_http_headers)
-	cout << "Content-Type: text/html\n\n";
-    cout << "Caught unknown exception" << endl;
+    report_exception();
 }
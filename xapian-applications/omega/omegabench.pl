@@ -0,0 +1,115 @@
+#!/usr/bin/perl
+# omegabench: Time OmegaScript template evaluation
+#
+# Copyright (C) 2026 agent
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License as
+# published by the Free Software Foundation; either version 2 of the
+# License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301
+# USA
+
+# Usage: omegabench.pl [PAGES [RUNS]]
+#
+# Builds a database of 1000 documents, then times omega rendering a page of
+# 100 hits with several fields per hit.  Each run of omega renders the hit
+# list PAGES times (default 50) so that template evaluation dominates the
+# startup cost, and the fastest of RUNS runs (default 5) is reported.
+#
+# Set OMEGA and SCRIPTINDEX in the environment to benchmark other builds.
+
+use strict;
+use warnings;
+
+use File::Path qw(remove_tree);
+use Time::HiRes qw(time);
+
+sub print_to_file {
+  my ($filename, $contents) = @_;
+  open my $fh, '>', $filename or die $!;
+  print $fh $contents;
+  close $fh or die $!;
+}
+
+my $omega = $ENV{OMEGA} // './omega';
+my $scriptindex = $ENV{SCRIPTINDEX} // './scriptindex';
+
+my $pages = shift @ARGV // 50;
+my $runs = shift @ARGV // 5;
+
+$ENV{SERVER_PROTOCOL} = 'INCLUDED';
+$ENV{LSAN_OPTIONS} = 'leak_check_at_exit=0';
+
+my $bench_db = 'bench-db';
+my $bench_template = 'bench-template';
+my $bench_indexscript = 'bench-indexscript';
+my $bench_data = 'bench-data';
+
+my $OMEGA_CONFIG_FILE = 'bench-omega.conf';
+$ENV{OMEGA_CONFIG_FILE} = $OMEGA_CONFIG_FILE;
+print_to_file $OMEGA_CONFIG_FILE, <<__END__ ;
+database_dir .
+template_dir .
+log_dir .
+default_template $bench_template
+default_db $bench_db
+__END__
+
+print_to_file $bench_indexscript, <<'__END__' ;
+id : boolean=Q unique=Q
+title : field index=S
+url : field
+size : field
+text : index field
+__END__
+
+my @words = qw(alpha bravo charlie delta echo foxtrot golf hotel india juliet
+	       kilo lima mike november oscar papa quebec romeo sierra tango);
+my $data = '';
+for my $i (1 .. 1000) {
+  my @text = map { $words[($i * 7 + $_ * 3) % @words] } 0 .. 40;
+  $data .= "id=$i\ntitle=Document $i $words[$i % @words]\n";
+  $data .= "url=http://example.org/doc/$i.html\nsize=" . ($i * 397) . "\n";
+  $data .= "text=common @text\n\n";
+}
+print_to_file $bench_data, $data;
+
+remove_tree($bench_db);
+system($scriptindex, $bench_db, $bench_indexscript, $bench_data) == 0
+  or die "$scriptindex failed: $?";
+
+print_to_file $bench_template, <<"__END__" ;
+\$set{thousand,\$.}\$set{decimal,.}\$setmap{prefix,title,S}
+\$foreach{\$range{1,$pages},
+<ol start="\$add{\$topdoc,1}">
+\$hitlist{<li class="\$if{\$eq{\$mod{\$hit,2},0},even,odd}">
+<a href="\$html{\$field{url}}">\$html{\$or{\$field{title},\$field{url},Untitled}}</a>
+\$percentage% [\$filesize{\$field{size}}]
+\$html{\$truncate{\$field{text},60}}
+\$list{\$map{\$terms,\$prettyterm{\$_}},<b>,</b> <b>,</b>}
+</li>
+}</ol>
+}
+__END__
+
+my $best;
+for my $run (1 .. $runs) {
+  my $start = time;
+  my $out = `$omega P=common HITSPERPAGE=100`;
+  my $elapsed = time - $start;
+  die "$omega failed: $?" if $?;
+  die "Unexpected output from $omega" unless $out =~ /<li class="odd">/;
+  $best = $elapsed if !defined $best || $elapsed < $best;
+}
+
+printf "%d pages of 100 hits: %.3fs (%.3fms per page)\n",
+  $pages, $best, $best * 1000 / $pages;
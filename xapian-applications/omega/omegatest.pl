@@ -738,6 +738,18 @@ print_to_file $test_template, '$include{$cgi{template}}-$opt{data}';
 testcase("Exception: Couldn't read format template 'non_existent.template' (No such file or directory)", 'template=non_existent.template');
 testcase("Exception: Couldn't read format template '../secret/file' (name contains '..')", 'template=../secret/file');
 
+# Feature tests for $def.
+# Check a macro can be used before it's defined if it's not evaluated then.
+print_to_file $test_template, '$if{$cgi{a},$m{x}}$def{m,<$1>}$m{y}$if{a,$m{z}}';
+testcase('<y><z>');
+testcase("Exception: Unknown function 'm'", 'a=1');
+# Check a macro which defines another macro works.  This used to crash.
+print_to_file $test_template, '$def{x,$1$def{y,Y$1}}$x{A}$y{B}';
+testcase('AYB');
+# Check a macro can redefine a built-in command.
+print_to_file $test_template, '$url{a b}$def{url,U$1}$url{a b}';
+testcase('a%20bUa b');
+
 # Feature tests for $foreach.
 print_to_file $test_template, '$foreach{$split{.,$cgi{a}},$chr{$add{$_,64}}}';
 testcase('OMEGA', 'a=15.13.5.7.1');
@@ -1501,6 +1513,41 @@ testcase('|DocNotFoundError: Document 2 not found', 'id=2');
 testcase('3|', 'id=3');
 testcase('4|', 'id=4');
 
+# Check `unique` gives the same results when records are indexed by worker
+# processes, which requires the lookups to happen in the order of the input.
+{
+  my $save_scriptindex = $scriptindex;
+  $scriptindex .= ' --jobs=3';
+  test_scriptindex 'UNIQUE action with --jobs',
+'id=1
+f=wan
+
+id=2
+f=too
+
+id=3
+f=free
+
+id=4
+f=fore
+
+id=1
+f=one
+
+id=2
+
+id=4
+f=
+
+id=3
+dummy=';
+  $scriptindex = $save_scriptindex;
+}
+testcase('1|one', 'id=1');
+testcase('|DocNotFoundError: Document 2 not found', 'id=2');
+testcase('3|', 'id=3');
+testcase('4|', 'id=4');
+
 # Test `unique` action warning.
 print_to_file $test_indexscript, "id : unique=Q boolean=W\nid f : field\n";
 test_scriptindex_warning 'unique without boolean',
@@ -1798,6 +1845,134 @@ print_to_file $test_template, '$hitlist{$list{$terms{T},|}/$field{tag1}|$field{t
 testcase('Tone/one|two|three', 'B=Tone');
 testcase('Tthree|Ttwo/one|two|three', 'B=Ttwo', 'B=Tthree');
 
+# Test omega --serve gives the same output as running omega as a CGI program.
+if ($^O ne 'MSWin32') {
+  require IO::Socket::INET;
+  my $port;
+  {
+    # Find a free port to use.
+    my $sock = IO::Socket::INET->new(Listen => 1,
+				     LocalAddr => '127.0.0.1',
+				     LocalPort => 0,
+				     Proto => 'tcp') or die $!;
+    $port = $sock->sockport;
+    close $sock;
+  }
+  my $server_pid = fork // die $!;
+  if ($server_pid == 0) {
+    # The server always sends headers, so don't ask the CGI path to omit them.
+    delete $ENV{SERVER_PROTOCOL};
+    exec(ref $omega ? @$omega : $omega, "--serve=127.0.0.1:$port") or die $!;
+  }
+
+  # Send $request to the server and return the response.
+  my $serve_request = sub {
+    my $request = shift;
+    my $sock;
+    for (1 .. 100) {
+      $sock = IO::Socket::INET->new(PeerAddr => '127.0.0.1',
+				    PeerPort => $port,
+				    Proto => 'tcp');
+      last if $sock;
+      # Give the server time to start listening.
+      select(undef, undef, undef, 0.1);
+    }
+    defined $sock or die "Couldn't connect to omega --serve: $!";
+    binmode $sock;
+    print $sock $request;
+    local $/ = undef;
+    my $response = <$sock>;
+    close $sock;
+    return $response // '';
+  };
+
+  # Run omega as a CGI program and return its output.
+  my $cgi_request = sub {
+    my ($method, $query_string, $body) = @_;
+    local $ENV{REQUEST_METHOD} = $method;
+    local $ENV{QUERY_STRING} = $query_string;
+    local $ENV{CONTENT_LENGTH} = length($body // '');
+    delete local $ENV{SERVER_PROTOCOL};
+    my $pid = open2(my $out, my $in, ref $omega ? @$omega : $omega) or die $!;
+    print $in $body if defined $body;
+    close $in;
+    local $/ = undef;
+    my $output = <$out>;
+    close $out;
+    waitpid($pid, 0);
+    return $output;
+  };
+
+  # Check the response to a request matches the CGI output.
+  #
+  # Parameters:
+  # * status: expected HTTP status
+  # * method: request method
+  # * query_string: query string
+  # * (optional) body: POST body
+  my $serve_testcase = sub {
+    my ($status, $method, $query_string, $body) = @_;
+    my $request = "$method /omega";
+    $request .= "?$query_string" if $method ne 'POST';
+    $request .= " HTTP/1.0\r\n";
+    if (defined $body) {
+      $request .= "Content-Type: application/x-www-form-urlencoded\r\n";
+      $request .= "Content-Length: " . length($body) . "\r\n";
+    }
+    $request .= "\r\n";
+    $request .= $body if defined $body;
+    my $response = $serve_request->($request);
+
+    my $cgi = $cgi_request->($method eq 'HEAD' ? 'GET' : $method,
+			     $method eq 'POST' ? '' : $query_string, $body);
+    my ($cgi_headers, $cgi_body) = split /\n\n/, $cgi, 2;
+    my $expected = "HTTP/1.0 $status\r\n";
+    for (split /\n/, $cgi_headers) {
+      $expected .= "$_\r\n" unless /^Status:/i;
+    }
+    $expected .= "Content-Length: " . length($cgi_body) . "\r\n";
+    $expected .= "Connection: close\r\n\r\n";
+    $expected .= $cgi_body if $method ne 'HEAD';
+    if ($response ne $expected) {
+      print "omega --serve $method $query_string:\n";
+      print "  expected: «${expected}»\n";
+      print "  received: «${response}»\n";
+      ++$failed;
+    }
+  };
+
+  print_to_file $test_template, '$querydescription';
+  $serve_testcase->('200 OK', 'GET', 'P=hello%20world');
+  $serve_testcase->('200 OK', 'HEAD', 'P=hello%20world');
+  $serve_testcase->('200 OK', 'POST', '', 'P=hello+world');
+
+  # The server keeps templates loaded, so use a new one for each testcase.
+  print_to_file "$test_template-404", '$httpheader{Status,404 Not Found}Not here';
+  $serve_testcase->('404 Not Found', 'GET', "FMT=$test_template-404");
+
+  print_to_file "$test_template-302", '$httpheader{Location,http://example.org/}';
+  $serve_testcase->('302 Found', 'GET', "FMT=$test_template-302");
+
+  # A template which can't be read gives an exception, which should be
+  # reported with a 500 status.
+  $serve_testcase->('500 Internal Server Error', 'GET', 'FMT=not-a-template');
+
+  my $response = $serve_request->("PUT /omega HTTP/1.0\r\n\r\n");
+  if ($response !~ m!^HTTP/1\.0 501 Not Implemented\r\n!) {
+    print "omega --serve PUT: unexpected response «${response}»\n";
+    ++$failed;
+  }
+  $response = $serve_request->("nonsense\r\n\r\n");
+  if ($response !~ m!^HTTP/1\.0 400 Bad Request\r\n!) {
+    print "omega --serve bad request: unexpected response «${response}»\n";
+    ++$failed;
+  }
+
+  kill 'TERM', $server_pid;
+  waitpid($server_pid, 0);
+  unlink "$test_template-404", "$test_template-302";
+}
+
 unlink $OMEGA_CONFIG_FILE, $test_indexscript, $test_template;
 remove_tree($test_db);
 if ($failed == 0) {
@@ -362,6 +362,7 @@ main(int argc, char **argv)
     bool description_as_sample = false;
     string baseurl;
     size_t depth_limit = 0;
+    unsigned jobs = 1;
     size_t title_size = TITLE_SIZE;
     size_t sample_size = SAMPLE_SIZE;
     empty_body_type empty_body = EMPTY_BODY_WARN;
@@ -394,6 +395,7 @@ main(int argc, char **argv)
 	{ "read-workers",	REQ_ARG,	NULL, OPT_READ_WORKERS },
 	{ "depth-limit",	REQ_ARG,	NULL, 'l' },
 	{ "follow",		NO_ARG,		NULL, 'f' },
+	{ "jobs",		REQ_ARG,	NULL, 'j' },
 	{ "ignore-exclusions",	NO_ARG,		NULL, 'i' },
 	{ "stemmer",		REQ_ARG,	NULL, 's' },
 	{ "spelling",		NO_ARG,		NULL, 'S' },
@@ -427,7 +429,7 @@ main(int argc, char **argv)
     string dbpath;
     int getopt_ret;
     while ((getopt_ret = gnu_getopt_long(argc, argv,
-					 "hvd:D:U:M:G:F:W:l:s:pfRSVe:im:E:T:C",
+					 "hvd:D:U:M:G:F:W:l:s:pfj:RSVe:im:E:T:C",
 					 longopts, NULL)) != -1) {
 	switch (getopt_ret) {
 	case 'h': {
@@ -481,6 +483,8 @@ main(int argc, char **argv)
 "                            are treated as comments and ignored.\n"
 "  -l, --depth-limit=LIMIT   set recursion limit (0 = unlimited)\n"
 "  -f, --follow              follow symbolic links\n"
+"  -j, --jobs=N              extract text from up to N files in parallel\n"
+"                            using a pool of N child processes (default: 1)\n"
 "  -i, --ignore-exclusions   ignore meta robots tags and similar exclusions\n"
 "  -S, --spelling            index data for spelling correction\n"
 "  -m, --max-size=N[SUFFIX]  maximum size of file to index (in bytes or with a\n"
@@ -555,6 +559,22 @@ main(int argc, char **argv)
 	case 'f': // Turn on following of symlinks
 	    follow_symlinks = true;
 	    break;
+	case 'j': {
+	    if (!parse_unsigned(optarg, jobs) || jobs == 0) {
+		cerr << PROG_NAME": bad number of jobs '" << optarg << "'"
+		     << endl;
+		return 1;
+	    }
+#if !defined HAVE_FORK || !defined HAVE_WAITPID
+	    if (jobs > 1) {
+		cerr << "--jobs isn't supported in this build because the "
+			"fork() and waitpid() functions weren't found at "
+			"configure time." << endl;
+		return 1;
+	    }
+#endif
+	    break;
+	}
 	case 'M': {
 	    const char * s = strrchr(optarg, ':');
 	    if (s == NULL) {
@@ -845,7 +865,7 @@ main(int argc, char **argv)
 		   sample_size, title_size, max_ext_len,
 		   overwrite, retry_failed, delete_removed_documents, verbose,
 		   use_ctime, spelling, ignore_exclusions,
-		   description_as_sample, date_terms);
+		   description_as_sample, date_terms, jobs);
 	index_directory(root, baseurl, depth_limit, mime_map);
 	index_handle_deletion();
 	index_commit();
@@ -29,6 +29,7 @@
 #include <algorithm>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <random>
 #include <set>
 #include <unordered_map>
@@ -948,8 +949,6 @@ static int percent;
 static double weight;
 static Xapian::doccount collapsed;
 
-static string print_caption(const string& fmt, vector<string>& param);
-
 enum tagval {
 CMD_,
 CMD_add,
@@ -1241,87 +1240,176 @@ T(weight,	   0, 0, N, 0), // weight of the current hit
 
 #undef T // Leaving T defined screws up Sun's C++ compiler!
 
-static vector<string> macros;
+/// Map from command names (including macros) to their attributes.
+static map<string, const func_attrib*> func_map;
 
-// Call write() repeatedly until all data is written or we get a
-// non-recoverable error.
-static ssize_t
-write_all(int fd, const char * buf, size_t count)
+/// Incremented each time $def changes func_map.
+static unsigned func_map_generation = 0;
+
+static const func_attrib*
+find_func(const string& name)
 {
-    while (count) {
-	ssize_t r = write(fd, buf, count);
-	if (rare(r < 0)) {
-	    if (errno == EINTR) continue;
-	    return r;
+    if (func_map.empty()) {
+	for (auto p = func_tab; p->name != NULL; ++p) {
+	    func_map[string(p->name)] = &(p->a);
 	}
-	buf += r;
-	count -= r;
     }
-    return 0;
+    auto i = func_map.find(name);
+    return i == func_map.end() ? NULL : i->second;
 }
 
-// mersenne twister for RNG
-static mt19937 rng;
-static bool seed_set = false;
+namespace {
 
-static string eval(const string& fmt, vector<string>& param);
+/** An OmegaScript template parsed ready for evaluation.
+ *
+ *  The text is split up into literal text, parameter references and
+ *  commands when the template is constructed, and the arguments of each
+ *  command are parsed too.  Evaluating the template (e.g. for each hit in
+ *  $hitlist{}) then doesn't need to rescan the text or look up the name of
+ *  each command.
+ *
+ *  Errors in the template are reported when evaluation reaches them, just as
+ *  if we were interpreting the text directly.
+ */
+class Template {
+  public:
+    /// A command and its arguments.
+    struct Command {
+	/// The command name.
+	string name;
 
-/** Implements $foreach{} and $map{}. */
-static string
-foreach(const string& list,
-	const string& pat,
-	vector<string>& param,
-	char sep = '\0')
+	/// The command's attributes, or NULL if it wasn't defined.
+	mutable const func_attrib* func;
+
+	/// The value of func_map_generation when func was looked up.
+	mutable unsigned func_generation;
+
+	/// Were the arguments given in braces?
+	bool has_args = false;
+
+	/// The text between the braces.
+	string raw_args;
+
+	/// If non-empty, the error to report because the braces don't match.
+	string missing_brace;
+
+	/// Were the arguments split at commas?
+	bool split = true;
+
+	/// The arguments.
+	vector<string> args;
+
+	/// The arguments parsed (only if split).
+	vector<shared_ptr<const Template>> arg_templates;
+
+	/// Set args and arg_templates from raw_args.
+	void set_args(bool split_);
+
+	/// Return the command's attributes.
+	const func_attrib* get_func() const {
+	    if (func_generation != func_map_generation) {
+		func = find_func(name);
+		func_generation = func_map_generation;
+	    }
+	    if (!func) {
+		throw "Unknown function '" + name + "'";
+	    }
+	    return func;
+	}
+    };
+
+    enum segment_type { LITERAL, PARAM, COMMAND, ERROR };
+
+    struct Segment {
+	segment_type type;
+
+	/// The text for LITERAL, or the error message for ERROR.
+	string text;
+
+	/// The parameter number for PARAM.
+	unsigned param = 0;
+
+	/// The command for COMMAND.
+	unique_ptr<Command> command;
+
+	explicit Segment(segment_type type_) : type(type_) { }
+    };
+
+    vector<Segment> segments;
+
+    explicit Template(const string& fmt);
+
+  private:
+    void add_literal(const string& s, size_t pos, size_t len = string::npos) {
+	if (len == 0) return;
+	if (segments.empty() || segments.back().type != LITERAL)
+	    segments.emplace_back(LITERAL);
+	segments.back().text.append(s, pos, len);
+    }
+};
+
+void
+Template::Command::set_args(bool split_)
 {
-    string result;
-    string saved_arg0 = std::move(param[0]);
-    string::size_type i = 0, j;
+    split = split_;
+    args.clear();
+    arg_templates.clear();
+    if (!has_args) return;
+    if (!split) {
+	args.push_back(raw_args);
+	return;
+    }
+    string::size_type p = string::npos, q = 0;
+    int nest = 0;
     while (true) {
-	j = list.find('\t', i);
-	param[0].assign(list, i, j - i);
-	result += eval(pat, param);
-	if (j == string::npos) break;
-	if (sep) result += sep;
-	i = j + 1;
+	p = raw_args.find_first_of(",{}", p + 1);
+	if (p == string::npos) break;
+	if (raw_args[p] == '{') {
+	    ++nest;
+	} else if (raw_args[p] == '}') {
+	    --nest;
+	} else if (nest == 0) {
+	    args.push_back(raw_args.substr(q, p - q));
+	    q = p + 1;
+	}
+    }
+    args.push_back(raw_args.substr(q));
+    for (auto&& arg : args) {
+	arg_templates.push_back(make_shared<const Template>(arg));
     }
-    param[0] = std::move(saved_arg0);
-    return result;
 }
 
-static string
-eval(const string& fmt, vector<string>& param)
+Template::Template(const string& fmt)
 {
-    static map<string, const struct func_attrib *> func_map;
-    if (func_map.empty()) {
-	for (auto p = func_tab; p->name != NULL; ++p) {
-	    func_map[string(p->name)] = &(p->a);
-	}
-    }
-    string res;
     string::size_type p = 0, q;
-    while ((q = fmt.find('$', p)) != string::npos) try {
-	res.append(fmt, p, q - p);
+    while ((q = fmt.find('$', p)) != string::npos) {
+	add_literal(fmt, p, q - p);
 	string::size_type code_start = q; // note down for error reporting
 	q++;
-	if (q >= fmt.size()) break;
+	if (q >= fmt.size()) {
+	    // A '$' at the end of the template results in the text since the
+	    // previous command being repeated, followed by the '$'.
+	    add_literal(fmt, p);
+	    return;
+	}
 	unsigned char ch = fmt[q];
 	switch (ch) {
 	    // Magic sequences:
 	    // '$$' -> '$', '$(' -> '{', '$)' -> '}', '$.' -> ','
 	    case '$':
-		res += '$';
+		add_literal("$", 0);
 		p = q + 1;
 		continue;
 	    case '(':
-		res += '{';
+		add_literal("{", 0);
 		p = q + 1;
 		continue;
 	    case ')':
-		res += '}';
+		add_literal("}", 0);
 		p = q + 1;
 		continue;
 	    case '.':
-		res += ',';
+		add_literal(",", 0);
 		p = q + 1;
 		continue;
 	    case '_':
@@ -1329,8 +1417,8 @@ eval(const string& fmt, vector<string>& param)
 		// FALL THRU
 	    case '1': case '2': case '3': case '4': case '5':
 	    case '6': case '7': case '8': case '9':
-		ch -= '0';
-		if (ch < param.size()) res += param[ch];
+		segments.emplace_back(PARAM);
+		segments.back().param = ch - '0';
 		p = q + 1;
 		continue;
 	    case 'a': case 'b': case 'c': case 'd': case 'e': case 'f':
@@ -1346,64 +1434,161 @@ eval(const string& fmt, vector<string>& param)
 	    case '{':
 		break;
 	    default:
-		string msg = "Unknown $ code in: $";
-		msg.append(fmt, q, string::npos);
-		throw msg;
+		segments.emplace_back(ERROR);
+		segments.back().text = "Unknown $ code in: $";
+		segments.back().text.append(fmt, q, string::npos);
+		return;
 	}
 	p = find_if(fmt.begin() + q, fmt.end(), p_notid) - fmt.begin();
-	string var(fmt, q, p - q);
-	map<string, const struct func_attrib *>::const_iterator func;
-	func = func_map.find(var);
-	if (func == func_map.end()) {
-	    throw "Unknown function '" + var + "'";
-	}
-	vector<string> args;
+	segments.emplace_back(COMMAND);
+	segments.back().command.reset(new Command);
+	Command& command = *segments.back().command;
+	command.name.assign(fmt, q, p - q);
+	command.func = find_func(command.name);
+	command.func_generation = func_map_generation;
 	if (fmt[p] == '{') {
 	    q = p + 1;
 	    int nest = 1;
 	    while (true) {
-		p = fmt.find_first_of(",{}", p + 1);
-		if (p == string::npos)
-		    throw "missing } in " + fmt.substr(code_start);
+		p = fmt.find_first_of("{}", p + 1);
+		if (p == string::npos) {
+		    // Report this once the command name has been checked.
+		    command.missing_brace = "missing } in " +
+					    fmt.substr(code_start);
+		    return;
+		}
 		if (fmt[p] == '{') {
 		    ++nest;
-		} else {
-		    if (nest == 1) {
-			// should we split the args
-			if (func->second->minargs != N) {
-			    args.push_back(fmt.substr(q, p - q));
-			    q = p + 1;
-			}
-		    }
-		    if (fmt[p] == '}' && --nest == 0) break;
+		} else if (--nest == 0) {
+		    break;
 		}
 	    }
-	    if (func->second->minargs == N)
-		args.push_back(fmt.substr(q, p - q));
+	    command.has_args = true;
+	    command.raw_args.assign(fmt, q, p - q);
 	    ++p;
 	}
+	// Commands which aren't defined yet can only become macros, which
+	// split their arguments.
+	command.set_args(!command.func || command.func->minargs != N);
+    }
+    add_literal(fmt, p);
+}
+
+}
+
+static vector<shared_ptr<const Template>> macros;
+
+// Call write() repeatedly until all data is written or we get a
+// non-recoverable error.
+static ssize_t
+write_all(int fd, const char * buf, size_t count)
+{
+    while (count) {
+	ssize_t r = write(fd, buf, count);
+	if (rare(r < 0)) {
+	    if (errno == EINTR) continue;
+	    return r;
+	}
+	buf += r;
+	count -= r;
+    }
+    return 0;
+}
+
+// mersenne twister for RNG
+static mt19937 rng;
+static bool seed_set = false;
+
+static string eval(const Template& fmt, vector<string>& param);
+
+static string eval(const string& fmt, vector<string>& param);
+
+static string print_caption(const Template& fmt, vector<string>& param);
+
+/** Implements $foreach{} and $map{}. */
+static string
+foreach(const string& list,
+	const Template& pat,
+	vector<string>& param,
+	char sep = '\0')
+{
+    string result;
+    string saved_arg0 = std::move(param[0]);
+    string::size_type i = 0, j;
+    while (true) {
+	j = list.find('\t', i);
+	param[0].assign(list, i, j - i);
+	result += eval(pat, param);
+	if (j == string::npos) break;
+	if (sep) result += sep;
+	i = j + 1;
+    }
+    param[0] = std::move(saved_arg0);
+    return result;
+}
+
+static string
+eval(const Template& fmt, vector<string>& param)
+{
+    string res;
+    for (auto&& segment : fmt.segments) try {
+	switch (segment.type) {
+	    case Template::LITERAL:
+		res += segment.text;
+		continue;
+	    case Template::PARAM:
+		if (segment.param < param.size()) res += param[segment.param];
+		continue;
+	    case Template::ERROR:
+		throw segment.text;
+	    case Template::COMMAND:
+		break;
+	}
+	const Template::Command* command = segment.command.get();
+	auto func = command->get_func();
+	if (!command->missing_brace.empty()) throw command->missing_brace;
+
+	unique_ptr<Template::Command> resplit;
+	if (command->split != (func->minargs != N)) {
+	    // The command has been redefined by $def since we parsed it, and
+	    // splits its arguments differently.
+	    resplit.reset(new Template::Command(*command));
+	    resplit->set_args(!command->split);
+	    command = resplit.get();
+	}
+	const auto& arg_templates = command->arg_templates;
 
-	if (func->second->minargs != N) {
-	    if (int(args.size()) < func->second->minargs)
-		throw "too few arguments to $" + var;
-	    if (func->second->maxargs != N &&
-		int(args.size()) > func->second->maxargs)
-		throw "too many arguments to $" + var;
+	vector<string> args;
+	if (func->minargs == N) {
+	    args = command->args;
+	} else {
+	    auto n_args = command->args.size();
+	    if (int(n_args) < func->minargs)
+		throw "too few arguments to $" + command->name;
+	    if (func->maxargs != N &&
+		int(n_args) > func->maxargs)
+		throw "too many arguments to $" + command->name;
 
 	    vector<string>::size_type n;
-	    if (func->second->evalargs != N)
-		n = func->second->evalargs;
+	    if (func->evalargs != N)
+		n = func->evalargs;
 	    else
-		n = args.size();
+		n = n_args;
 
-	    for (vector<string>::size_type j = 0; j < n; ++j)
-		args[j] = eval(args[j], param);
+	    args.reserve(n_args);
+	    for (vector<string>::size_type j = 0; j < n_args; ++j) {
+		if (j < n) {
+		    args.push_back(eval(*arg_templates[j], param));
+		} else {
+		    args.push_back(command->args[j]);
+		}
+	    }
 	}
-	if (func->second->ensure == 'Q' || func->second->ensure == 'M')
+	if (func->ensure == 'Q' || func->ensure == 'M')
 	    ensure_query_parsed();
-	if (func->second->ensure == 'M') ensure_match();
+	if (func->ensure == 'M') ensure_match();
 	string value;
-	switch (func->second->tag) {
+	switch (func->tag) {
 	    case CMD_:
 		break;
 	    case CMD_add: {
@@ -1443,8 +1628,8 @@ eval(const string& fmt, vector<string>& param)
 	    }
 	    case CMD_and: {
 		value = "true";
-		for (auto&& arg : args) {
-		    if (eval(arg, param).empty()) {
+		for (auto&& arg : arg_templates) {
+		    if (eval(*arg, param).empty()) {
 			value.resize(0);
 			break;
 		    }
@@ -1530,11 +1715,11 @@ eval(const string& fmt, vector<string>& param)
 		for (size_t i = 0; i < args.size(); i += 2) {
 		    if (i == args.size() - 1) {
 			// Handle optional "else" value.
-			value = eval(args[i], param);
+			value = eval(*arg_templates[i], param);
 			break;
 		    }
-		    if (!eval(args[i], param).empty()) {
-			value = eval(args[i + 1], param);
+		    if (!eval(*arg_templates[i], param).empty()) {
+			value = eval(*arg_templates[i + 1], param);
 			break;
 		    }
 		}
@@ -1590,8 +1775,9 @@ eval(const string& fmt, vector<string>& param)
 		fa->evalargs = N; // FIXME: or 0?
 		fa->ensure = 0;
 
-		macros.push_back(args[1]);
+		macros.push_back(arg_templates[1]);
 		func_map[args[0]] = fa;
+		++func_map_generation;
 		break;
 	    }
 	    case CMD_defaultop:
@@ -1730,7 +1916,7 @@ eval(const string& fmt, vector<string>& param)
 		break;
 	    case CMD_foreach:
 		if (!args[0].empty()) {
-		    value = foreach(args[0], args[1], param);
+		    value = foreach(args[0], *arg_templates[1], param);
 		}
 		break;
 	    case CMD_freq: {
@@ -1837,7 +2023,7 @@ eval(const string& fmt, vector<string>& param)
 #endif
 		auto save_hit_no = hit_no;
 		for (hit_no = topdoc; hit_no < last; ++hit_no)
-		    value += print_caption(args[0], param);
+		    value += print_caption(*arg_templates[0], param);
 		hit_no = save_hit_no;
 		break;
 	    }
@@ -1879,9 +2065,9 @@ eval(const string& fmt, vector<string>& param)
 		break;
 	    case CMD_if:
 		if (args.size() > 1 && !args[0].empty())
-		    value = eval(args[1], param);
+		    value = eval(*arg_templates[1], param);
 		else if (args.size() > 2)
-		    value = eval(args[2], param);
+		    value = eval(*arg_templates[2], param);
 		break;
 	    case CMD_include: {
 		if (args.size() == 1) {
@@ -1890,7 +2076,7 @@ eval(const string& fmt, vector<string>& param)
 		    bool fallback = false;
 		    value = eval_file(args[0], &fallback);
 		    if (fallback) {
-			value = eval(args[1], param);
+			value = eval(*arg_templates[1], param);
 		    }
 		}
 		break;
@@ -1918,7 +2104,7 @@ eval(const string& fmt, vector<string>& param)
 			value += '"';
 		    } else {
 			new_args[0] = std::move(elt);
-			value += eval(args[1], new_args);
+			value += eval(*arg_templates[1], new_args);
 		    }
 		    if (j == string::npos) break;
 		    value += ',';
@@ -1953,14 +2139,14 @@ eval(const string& fmt, vector<string>& param)
 				    string key(k, prefix.size());
 				    if (args.size() > 1 && !args[1].empty()) {
 					new_args[0] = std::move(key);
-					key = eval(args[1], new_args);
+					key = eval(*arg_templates[1], new_args);
 				    }
 				    return key;
 				},
 				[&](const string& v) {
 				    if (args.size() > 2 && !args[2].empty()) {
 					new_args[0] = v;
-					return eval(args[2], new_args);
+					return eval(*arg_templates[2], new_args);
 				    }
 				    string r(1, '"');
 				    string elt = v;
@@ -2056,14 +2242,14 @@ eval(const string& fmt, vector<string>& param)
 				    string key = k;
 				    if (args.size() > 2 && !args[2].empty()) {
 					new_args[0] = std::move(key);
-					key = eval(args[2], new_args);
+					key = eval(*arg_templates[2], new_args);
 				    }
 				    return key;
 				},
 				[&](const string& v) {
 				    if (args.size() > 3 && !args[3].empty()) {
 					new_args[0] = v;
-					return eval(args[3], new_args);
+					return eval(*arg_templates[3], new_args);
 				    }
 				    string r(1, '"');
 				    string elt = v;
@@ -2204,7 +2390,7 @@ eval(const string& fmt, vector<string>& param)
 		break;
 	    case CMD_map:
 		if (!args[0].empty()) {
-		    value = foreach(args[0], args[1], param, '\t');
+		    value = foreach(args[0], *arg_templates[1], param, '\t');
 		}
 		break;
 	    case CMD_match:
@@ -2301,8 +2487,8 @@ eval(const string& fmt, vector<string>& param)
 		}
 		break;
 	    case CMD_or: {
-		for (auto&& arg : args) {
-		    value = eval(arg, param);
+		for (auto&& arg : arg_templates) {
+		    value = eval(*arg, param);
 		    if (!value.empty()) break;
 		}
 		break;
@@ -2656,11 +2842,11 @@ eval(const string& fmt, vector<string>& param)
 		for (size_t i = 1; i < args.size(); i += 2) {
 		    if (i == args.size() - 1) {
 			// Handle optional "else" value.
-			value = eval(args[i], param);
+			value = eval(*arg_templates[i], param);
 			break;
 		    }
-		    if (val == eval(args[i], param)) {
-			value = eval(args[i + 1], param);
+		    if (val == eval(*arg_templates[i], param)) {
+			value = eval(*arg_templates[i + 1], param);
 			break;
 		    }
 		}
@@ -2877,10 +3063,10 @@ eval(const string& fmt, vector<string>& param)
 		break;
 	    default: {
 		args.insert(args.begin(), param[0]);
-		int macro_no = func->second->tag - CMD_MACRO;
+		int macro_no = func->tag - CMD_MACRO;
 		assert(macro_no >= 0 && unsigned(macro_no) < macros.size());
-		// throw "Unknown function '" + var + "'";
-		value = eval(macros[macro_no], args);
+		// throw "Unknown function '" + command->name + "'";
+		value = eval(*macros[macro_no], args);
 		break;
 	    }
 	}
@@ -2891,13 +3077,66 @@ eval(const string& fmt, vector<string>& param)
 	error_msg = e.get_description();
     }
 
-    res.append(fmt, p, string::npos);
     return res;
 }
 
+static string
+eval(const string& fmt, vector<string>& param)
+{
+    return eval(Template(fmt), param);
+}
+
+/// A template read by preload_template().
+struct PreloadedTemplate {
+    /// The parsed template.
+    shared_ptr<const Template> fmt;
+
+    /// Modification time of the template file when it was read.
+    time_t mtime;
+
+    /// Size of the template file when it was read.
+    off_t size;
+};
+
+/// Templates read by preload_template(), indexed by name.
+static map<string, PreloadedTemplate> preloaded_templates;
+
+void
+preload_template(const string& fmtfile)
+{
+    if (!vet_filename(fmtfile)) return;
+    string file = template_dir + fmtfile;
+    struct stat st;
+    if (stat(file.c_str(), &st) < 0) {
+	preloaded_templates.erase(fmtfile);
+	return;
+    }
+    auto i = preloaded_templates.find(fmtfile);
+    if (i != preloaded_templates.end() &&
+	i->second.mtime == st.st_mtime &&
+	i->second.size == st.st_size) {
+	// Unchanged since we read it.
+	return;
+    }
+    string fmt;
+    if (!load_file(file, fmt)) {
+	preloaded_templates.erase(fmtfile);
+	return;
+    }
+    preloaded_templates[fmtfile] = {make_shared<const Template>(fmt),
+				    st.st_mtime, st.st_size};
+}
+
 static string
 eval_file(const string& fmtfile, bool* p_not_found)
 {
+    auto t = preloaded_templates.find(fmtfile);
+    if (t != preloaded_templates.end()) {
+	vector<string> noargs;
+	noargs.resize(1);
+	return eval(*t->second.fmt, noargs);
+    }
+
     // Use -1 to indicate vet_filename() failed.
     int eno = -1;
     if (vet_filename(fmtfile)) {
@@ -2982,7 +3221,7 @@ pretty_term(string term)
 }
 
 static string
-print_caption(const string& fmt, vector<string>& param)
+print_caption(const Template& fmt, vector<string>& param)
 {
     q0 = *(mset[hit_no]);
 
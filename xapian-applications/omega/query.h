@@ -69,6 +69,15 @@ void add_query_string(const std::string& prefix, const std::string& s);
 
 void parse_omegascript();
 
+/** Read a template in advance.
+ *
+ *  Subsequent uses of template @a fmtfile will use the contents read here
+ *  rather than reading the file again.  If the template was already read and
+ *  the file's modification time and size are unchanged then the file isn't
+ *  reread.
+ */
+void preload_template(const std::string& fmtfile);
+
 std::string pretty_term(std::string term);
 
 class OmegaExpandDecider : public Xapian::ExpandDecider {
@@ -32,12 +32,14 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <unordered_set>
 #include <vector>
 #include <cstring>
 
 #include <cerrno>
+#include <csignal>
 #include <cstdio>
 #include <cstdlib>
 #include <ctime>
@@ -49,6 +51,8 @@
 #include "htmlparser.h"
 #include "loadfile.h"
 #include "parseint.h"
+#include "safesyswait.h"
+#include "safeunistd.h"
 #include "setenv.h"
 #include "str.h"
 #include "stringutils.h"
@@ -56,6 +60,7 @@
 #include "timegm.h"
 #include "utf8truncate.h"
 #include "values.h"
+#include "worker_comms.h"
 
 #include "gnu_getopt.h"
 
@@ -297,6 +302,16 @@ parsedate_supports_z()
 
 static bool index_spec_uses_unique = false;
 
+/** Text to add spellings from, or NULL to have the TermGenerator add them.
+ *
+ *  This is used by worker processes (see --jobs), which can't add spellings
+ *  to the database themselves.
+ */
+static vector<string>* spelling_texts = nullptr;
+
+/// Set by the "spell" action when spelling_texts is in use.
+static bool spelling_field = false;
+
 static map<string, vector<Action>> index_spec;
 
 // Like std::getline() but handle \r\n line endings too.
@@ -981,13 +996,12 @@ bad_hex_digit:
 static bool
 run_actions(vector<Action>::const_iterator action_it,
 	    vector<Action>::const_iterator action_end,
-	    Xapian::WritableDatabase& database,
 	    Xapian::TermGenerator& indexer,
 	    const string& old_value,
 	    bool& this_field_is_content, Xapian::Document& doc,
 	    map<string, list<string>>& fields,
 	    string& field, const char* fname,
-	    size_t line_no, Xapian::docid& docid)
+	    size_t line_no, vector<string>& unique_terms)
 {
     string value = old_value;
     while (action_it != action_end) {
@@ -1014,6 +1028,8 @@ run_actions(vector<Action>::const_iterator action_it,
 		indexer.index_text(value,
 				   action.get_num_arg(),
 				   action.get_string_arg());
+		if (spelling_field && action.get_string_arg().empty())
+		    spelling_texts->push_back(value);
 		break;
 	    case Action::INDEXNOPOS:
 		// No positional information so phrase searching won't work.
@@ -1021,6 +1037,8 @@ run_actions(vector<Action>::const_iterator action_it,
 		indexer.index_text_without_positions(value,
 						     action.get_num_arg(),
 						     action.get_string_arg());
+		if (spelling_field && action.get_string_arg().empty())
+		    spelling_texts->push_back(value);
 		break;
 	    case Action::BOOLEAN: {
 		// Do nothing if there's no text.
@@ -1106,7 +1124,11 @@ run_actions(vector<Action>::const_iterator action_it,
 		utf8_truncate(value, action.get_num_arg());
 		break;
 	    case Action::SPELL:
-		indexer.set_flags(indexer.FLAG_SPELLING);
+		if (spelling_texts) {
+		    spelling_field = true;
+		} else {
+		    indexer.set_flags(indexer.FLAG_SPELLING);
+		}
 		break;
 	    case Action::SPLIT: {
 		// Find the end of the actions which split should execute.
@@ -1134,23 +1156,21 @@ run_actions(vector<Action>::const_iterator action_it,
 				if (j > 0) {
 				    string val(value, 0, j);
 				    run_actions(action_it, split_end,
-						database, indexer,
-						val,
+						indexer, val,
 						this_field_is_content, doc,
 						fields,
 						field, fname, line_no,
-						docid);
+						unique_terms);
 				}
 			    } else if (i != j) {
 				string val(value, i, j - i);
 				if (!seen.get() || seen->insert(val).second) {
 				    run_actions(action_it, split_end,
-						database, indexer,
-						val,
+						indexer, val,
 						this_field_is_content, doc,
 						fields,
 						field, fname, line_no,
-						docid);
+						unique_terms);
 				}
 			    }
 			    if (j == string::npos) break;
@@ -1164,23 +1184,21 @@ run_actions(vector<Action>::const_iterator action_it,
 				if (j > 0) {
 				    string val(value, 0, j);
 				    run_actions(action_it, split_end,
-						database, indexer,
-						val,
+						indexer, val,
 						this_field_is_content, doc,
 						fields,
 						field, fname, line_no,
-						docid);
+						unique_terms);
 				}
 			    } else if (i != j) {
 				string val(value, i, j - i);
 				if (!seen.get() || seen->insert(val).second) {
 				    run_actions(action_it, split_end,
-						database, indexer,
-						val,
+						indexer, val,
 						this_field_is_content, doc,
 						fields,
 						field, fname, line_no,
-						docid);
+						unique_terms);
 				}
 			    }
 			    if (j == string::npos) break;
@@ -1218,10 +1236,10 @@ run_actions(vector<Action>::const_iterator action_it,
 
 		    for (auto&& val : split_values) {
 			run_actions(action_it, split_end,
-				    database, indexer, val,
+				    indexer, val,
 				    this_field_is_content, doc, fields,
 				    field, fname, line_no,
-				    docid);
+				    unique_terms);
 		    }
 		}
 
@@ -1294,10 +1312,7 @@ run_actions(vector<Action>::const_iterator action_it,
 		string t = action.get_string_arg();
 		if (prefix_needs_colon(t, value[0])) t += ':';
 		t += value;
-		Xapian::PostingIterator p = database.postlist_begin(t);
-		if (p != database.postlist_end(t)) {
-		    docid = *p;
-		}
+		unique_terms.push_back(std::move(t));
 		break;
 	    }
 	    case Action::VALUE:
@@ -1433,120 +1448,424 @@ run_actions(vector<Action>::const_iterator action_it,
     return true;
 }
 
-static void
-index_file(const char *fname, istream &stream,
-	   Xapian::WritableDatabase &database, Xapian::TermGenerator &indexer)
+/// What to do with a record after running the index script on it.
+enum record_action {
+    RECORD_SKIP, RECORD_DELETE, RECORD_INDEX
+};
+
+/** Read the next record from @a stream.
+ *
+ *  Each line of the record is put in @a record followed by '\n', as is the
+ *  blank line which ends it (if any), so process_record() counts lines in the
+ *  same way as if it was reading from @a stream.
+ *
+ *  @param line_no		The current line number in @a stream, which is
+ *				updated.
+ *  @param first_line_no	Set to the line number of the first line of the
+ *				record.
+ *
+ *  @return false if there are no more records.
+ */
+static bool
+read_record(istream& stream, size_t& line_no, string& record,
+	    size_t& first_line_no)
 {
     string line;
-    size_t line_no = 0;
-    while (!stream.eof() && getline_portable(stream, line)) {
+    do {
+	if (stream.eof() || !getline_portable(stream, line)) return false;
 	++line_no;
 	// Allow blank lines before the first record and multiple blank lines
 	// between records.
-	if (line.empty()) continue;
+    } while (line.empty());
+
+    first_line_no = line_no;
+    record.resize(0);
+    while (true) {
+	record += line;
+	record += '\n';
+	if (line.empty() || !getline_portable(stream, line)) break;
+	++line_no;
+    }
+    return true;
+}
 
-	Xapian::Document doc;
-	indexer.set_document(doc);
-	Xapian::docid docid = 0;
-	map<string, list<string>> fields;
-	bool seen_content = false;
-	skipping_record = false;
-	unique_unused = index_spec_uses_unique;
-	while (!line.empty()) {
-	    string::size_type eq = line.find('=');
-	    if (eq == string::npos && !line.empty()) {
-		report_location(DIAG_ERROR, fname, line_no);
-		cerr << "Expected = somewhere in this line\n";
-		exit(1);
-	    }
-	    string field(line, 0, eq);
-	    string value(line, eq + 1, string::npos);
-	    line.clear();
-	    while (getline_portable(stream, line)) {
-		++line_no;
-		if (line.empty() || line[0] != '=') break;
-		// Replace the '=' with a '\n'.
-		line[0] = '\n';
-		value += line;
-		line.erase();
-	    }
+/** Run the index script on a record.
+ *
+ *  @param doc		The document to build.
+ *  @param unique_terms	Terms generated by any UNIQUE actions are appended to
+ *			this.
+ */
+static record_action
+process_record(const char* fname, const string& record, size_t first_line_no,
+	       Xapian::TermGenerator& indexer,
+	       Xapian::Document& doc, vector<string>& unique_terms)
+{
+    istringstream stream(record);
+    string line;
+    getline_portable(stream, line);
+    size_t line_no = first_line_no;
+
+    indexer.set_document(doc);
+    map<string, list<string>> fields;
+    bool seen_content = false;
+    skipping_record = false;
+    unique_unused = index_spec_uses_unique;
+    while (!line.empty()) {
+	string::size_type eq = line.find('=');
+	if (eq == string::npos && !line.empty()) {
+	    report_location(DIAG_ERROR, fname, line_no);
+	    cerr << "Expected = somewhere in this line\n";
+	    exit(1);
+	}
+	string field(line, 0, eq);
+	string value(line, eq + 1, string::npos);
+	line.clear();
+	while (getline_portable(stream, line)) {
+	    ++line_no;
+	    if (line.empty() || line[0] != '=') break;
+	    // Replace the '=' with a '\n'.
+	    line[0] = '\n';
+	    value += line;
+	    line.erase();
+	}
 
-	    if (skipping_record) continue;
+	if (skipping_record) continue;
 
-	    // Default to not indexing spellings.
-	    indexer.set_flags(Xapian::TermGenerator::flags(0));
+	// Default to not indexing spellings.
+	indexer.set_flags(Xapian::TermGenerator::flags(0));
+	spelling_field = false;
 
-	    bool this_field_is_content = true;
-	    const vector<Action>& v = index_spec[field];
-	    run_actions(v.begin(), v.end(),
-			database, indexer, value,
-			this_field_is_content, doc, fields,
-			field, fname, line_no,
-			docid);
-	    if (this_field_is_content) seen_content = true;
+	bool this_field_is_content = true;
+	const vector<Action>& v = index_spec[field];
+	run_actions(v.begin(), v.end(),
+		    indexer, value,
+		    this_field_is_content, doc, fields,
+		    field, fname, line_no,
+		    unique_terms);
+	if (this_field_is_content) seen_content = true;
+    }
+
+    if (unique_unused) {
+	enum diag_type diag = DIAG_WARN;
+	switch (unique_missing) {
+	  case UNIQUE_ERROR:
+	    diag = DIAG_ERROR;
+	    /* FALLTHRU */
+	  case UNIQUE_WARN_NEW:
+	  case UNIQUE_WARN_SKIP:
+	    report_location(diag, fname, line_no);
+	    cerr << "UNIQUE action unused in this record\n";
+	  default:
+	    break;
 	}
+	switch (unique_missing) {
+	  case UNIQUE_ERROR:
+	    exit(1);
+	  case UNIQUE_SKIP:
+	  case UNIQUE_WARN_SKIP:
+	    skipping_record = true;
+	    break;
+	  case UNIQUE_NEW:
+	  case UNIQUE_WARN_NEW:
+	    break;
+	}
+    }
 
-	if (unique_unused) {
-	    enum diag_type diag = DIAG_WARN;
-	    switch (unique_missing) {
-	      case UNIQUE_ERROR:
-		diag = DIAG_ERROR;
-		/* FALLTHRU */
-	      case UNIQUE_WARN_NEW:
-	      case UNIQUE_WARN_SKIP:
-		report_location(diag, fname, line_no);
-		cerr << "UNIQUE action unused in this record\n";
-	      default:
-		break;
-	    }
-	    switch (unique_missing) {
-	      case UNIQUE_ERROR:
-		exit(1);
-	      case UNIQUE_SKIP:
-	      case UNIQUE_WARN_SKIP:
-		skipping_record = true;
-		break;
-	      case UNIQUE_NEW:
-	      case UNIQUE_WARN_NEW:
-		break;
-	    }
+    if (skipping_record) return RECORD_SKIP;
+
+    // If we haven't seen any fields (other than unique identifiers) then the
+    // document is to be deleted.
+    if (!seen_content) return RECORD_DELETE;
+
+    string data;
+    for (auto&& i : fields) {
+	for (auto&& field_val : i.second) {
+	    data += i.first;
+	    data += '=';
+	    data += field_val;
+	    data += '\n';
+	}
+    }
+
+    // Put the data in the document
+    doc.set_data(data);
+    return RECORD_INDEX;
+}
+
+/// Update the database for a record processed by process_record().
+static void
+apply_record(Xapian::WritableDatabase& database, record_action action,
+	     const Xapian::Document& doc, const vector<string>& unique_terms)
+{
+    if (action == RECORD_SKIP) {
+	++skipcount;
+	return;
+    }
+
+    // If a record already exists with the same value for a unique field, it
+    // will be replaced with (or deleted by) the new record.
+    Xapian::docid docid = 0;
+    for (auto&& t : unique_terms) {
+	Xapian::PostingIterator p = database.postlist_begin(t);
+	if (p != database.postlist_end(t)) {
+	    docid = *p;
+	}
+    }
+
+    if (action == RECORD_DELETE) {
+	if (docid) {
+	    database.delete_document(docid);
+	    if (verbose) cout << "Del: " << docid << '\n';
+	    ++delcount;
+	}
+	return;
+    }
+
+    // Add the document to the database
+    if (docid) {
+	database.replace_document(docid, doc);
+	if (verbose) cout << "Replace: " << docid << '\n';
+	++repcount;
+    } else {
+	docid = database.add_document(doc);
+	if (verbose) cout << "Add: " << docid << '\n';
+	++addcount;
+    }
+}
+
+/** A process running the index script on batches of records.
+ *
+ *  Each worker has at most one batch outstanding, and batches are given to
+ *  the workers in turn, so results are read back in input order.
+ */
+struct IndexWorker {
+    pid_t pid;
+
+    /// Records are sent to the worker on this.
+    FILE* to;
+
+    /// The worker sends back results on this.
+    FILE* from;
+};
+
+/// Worker processes, if --jobs was used.
+static vector<IndexWorker> workers;
+
+#if defined HAVE_FORK && defined HAVE_WAITPID
+/// The worker to send the next batch to.
+static size_t next_worker = 0;
+
+/// The number of batches sent which we haven't read the results of yet.
+static size_t batches_pending = 0;
+
+/// The number of records to send to a worker at once.
+const size_t BATCH_SIZE = 64;
+
+/// Sent after the last record of a batch, and after the last result.
+const unsigned long END_OF_BATCH = 0;
+
+[[noreturn]]
+static void
+worker_failed(IndexWorker& worker)
+{
+    int status;
+    while (waitpid(worker.pid, &status, 0) < 0 && errno == EINTR) { }
+    // If the worker exited normally it will have explained why.
+    if (!WIFEXITED(status)) {
+	cerr << "Worker process failed\n";
+    }
+    exit(1);
+}
+
+/// Run the index script on batches of records sent by the parent process.
+[[noreturn]]
+static void
+run_worker(FILE* from, FILE* to, Xapian::TermGenerator& indexer)
+{
+    vector<string> spellings;
+    spelling_texts = &spellings;
+    string fname;
+    vector<pair<unsigned long, string>> batch;
+    while (read_string(from, fname)) {
+	batch.clear();
+	while (true) {
+	    unsigned long first_line_no;
+	    if (!read_unsigned(from, first_line_no)) _exit(1);
+	    if (first_line_no == END_OF_BATCH) break;
+	    batch.emplace_back(first_line_no, string());
+	    if (!read_string(from, batch.back().second)) _exit(1);
 	}
 
-	if (skipping_record) {
-	    ++skipcount;
-	} else if (!seen_content) {
-	    // We haven't seen any fields (other than unique identifiers)
-	    // so the document is to be deleted.
-	    if (docid) {
-		database.delete_document(docid);
-		if (verbose) cout << "Del: " << docid << '\n';
-		++delcount;
+	for (auto&& record : batch) {
+	    Xapian::Document doc;
+	    vector<string> unique_terms;
+	    spellings.clear();
+	    auto action = process_record(fname.c_str(), record.second,
+					 record.first, indexer,
+					 doc, unique_terms);
+	    // Actions are sent offset by one to distinguish END_OF_BATCH.
+	    write_unsigned(to, unsigned(action) + 1);
+	    write_unsigned(to, unsigned(unique_terms.size()));
+	    for (auto&& t : unique_terms) write_string(to, t);
+	    write_unsigned(to, unsigned(spellings.size()));
+	    for (auto&& s : spellings) write_string(to, s);
+	    if (action == RECORD_INDEX) write_string(to, doc.serialise());
+	}
+	write_unsigned(to, END_OF_BATCH);
+	if (fflush(to) != 0) _exit(1);
+    }
+    // Exit without running destructors or atexit handlers, which would act
+    // on things shared with the parent process.
+    _exit(0);
+}
+
+/// Start @a n worker processes.
+static void
+start_workers(unsigned n, Xapian::TermGenerator& indexer)
+{
+    // Make sure any buffered output doesn't get written by the workers too.
+    cout.flush();
+    // We notice a worker dying when reading its results.
+    signal(SIGPIPE, SIG_IGN);
+    for (unsigned i = 0; i != n; ++i) {
+	int to_worker[2], from_worker[2];
+	if (pipe(to_worker) < 0 || pipe(from_worker) < 0) {
+	    cerr << "Failed to create pipe: " << strerror(errno) << '\n';
+	    exit(1);
+	}
+	pid_t pid = fork();
+	if (pid == 0) {
+	    // Child process.
+	    close(to_worker[1]);
+	    close(from_worker[0]);
+	    for (auto&& worker : workers) {
+		close(fileno(worker.to));
+		close(fileno(worker.from));
 	    }
-	} else {
-	    string data;
-	    for (auto&& i : fields) {
-		for (auto&& field_val : i.second) {
-		    data += i.first;
-		    data += '=';
-		    data += field_val;
-		    data += '\n';
-		}
+	    run_worker(fdopen(to_worker[0], "r"), fdopen(from_worker[1], "w"),
+		       indexer);
+	}
+	if (pid < 0) {
+	    cerr << "Failed to fork worker process: " << strerror(errno)
+		 << '\n';
+	    exit(1);
+	}
+	close(to_worker[0]);
+	close(from_worker[1]);
+	workers.push_back({pid,
+			   fdopen(to_worker[1], "w"),
+			   fdopen(from_worker[0], "r")});
+    }
+}
+
+/// Tell the worker processes to exit and wait for them to do so.
+static void
+stop_workers()
+{
+    for (auto&& worker : workers) {
+	fclose(worker.to);
+	fclose(worker.from);
+	while (waitpid(worker.pid, NULL, 0) < 0 && errno == EINTR) { }
+    }
+    workers.clear();
+}
+
+/// Read and act on the results from the oldest pending batch.
+static void
+finish_batch(Xapian::WritableDatabase& database,
+	     Xapian::TermGenerator& indexer)
+{
+    size_t w = (next_worker + workers.size() - batches_pending) %
+	       workers.size();
+    IndexWorker& worker = workers[w];
+    --batches_pending;
+    vector<string> unique_terms;
+    string s;
+    while (true) {
+	unsigned code;
+	if (!read_unsigned(worker.from, code)) worker_failed(worker);
+	if (code == END_OF_BATCH) break;
+	auto action = record_action(code - 1);
+	unsigned n;
+	if (!read_unsigned(worker.from, n)) worker_failed(worker);
+	unique_terms.resize(n);
+	for (auto&& t : unique_terms) {
+	    if (!read_string(worker.from, t)) worker_failed(worker);
+	}
+	if (!read_unsigned(worker.from, n)) worker_failed(worker);
+	if (n) {
+	    // Workers can't add spellings to the database, so we do that
+	    // here with the indexer, which has the database set.
+	    Xapian::Document scratch;
+	    indexer.set_document(scratch);
+	    indexer.set_flags(indexer.FLAG_SPELLING);
+	    while (n--) {
+		if (!read_string(worker.from, s)) worker_failed(worker);
+		indexer.index_text_without_positions(s);
 	    }
+	}
+	Xapian::Document doc;
+	if (action == RECORD_INDEX) {
+	    if (!read_string(worker.from, s)) worker_failed(worker);
+	    doc = Xapian::Document::unserialise(s);
+	}
+	apply_record(database, action, doc, unique_terms);
+    }
+}
 
-	    // Put the data in the document
-	    doc.set_data(data);
+/// Send a batch of records to the next worker.
+static void
+send_batch(const char* fname,
+	   const vector<pair<size_t, string>>& batch,
+	   Xapian::WritableDatabase& database,
+	   Xapian::TermGenerator& indexer)
+{
+    if (batches_pending == workers.size()) {
+	// The next worker is the one with the oldest batch.
+	finish_batch(database, indexer);
+    }
+    IndexWorker& worker = workers[next_worker];
+    bool ok = write_string(worker.to, fname, strlen(fname));
+    for (auto&& record : batch) {
+	ok = ok && write_unsigned(worker.to,
+				  static_cast<unsigned long>(record.first));
+	ok = ok && write_string(worker.to, record.second);
+    }
+    ok = ok && write_unsigned(worker.to, END_OF_BATCH);
+    if (!ok || fflush(worker.to) != 0) worker_failed(worker);
+    next_worker = (next_worker + 1) % workers.size();
+    ++batches_pending;
+}
+#endif
 
-	    // Add the document to the database
-	    if (docid) {
-		database.replace_document(docid, doc);
-		if (verbose) cout << "Replace: " << docid << '\n';
-		++repcount;
-	    } else {
-		docid = database.add_document(doc);
-		if (verbose) cout << "Add: " << docid << '\n';
-		++addcount;
+static void
+index_file(const char *fname, istream &stream,
+	   Xapian::WritableDatabase &database, Xapian::TermGenerator &indexer)
+{
+    size_t line_no = 0;
+    string record;
+    size_t first_line_no;
+    if (!workers.empty()) {
+#if defined HAVE_FORK && defined HAVE_WAITPID
+	vector<pair<size_t, string>> batch;
+	while (read_record(stream, line_no, record, first_line_no)) {
+	    batch.emplace_back(first_line_no, std::move(record));
+	    if (batch.size() == BATCH_SIZE) {
+		send_batch(fname, batch, database, indexer);
+		batch.clear();
 	    }
 	}
+	if (!batch.empty()) send_batch(fname, batch, database, indexer);
+	while (batches_pending) finish_batch(database, indexer);
+#endif
+    } else {
+	while (read_record(stream, line_no, record, first_line_no)) {
+	    Xapian::Document doc;
+	    vector<string> unique_terms;
+	    auto action = process_record(fname, record, first_line_no,
+					 indexer, doc, unique_terms);
+	    apply_record(database, action, doc, unique_terms);
+	}
     }
 
     // Commit after each file to make sure all changes from that file make it
@@ -1570,6 +1889,8 @@ show_help(int exit_code)
 "\n"
 "Options:\n"
 "  -v, --verbose       display additional messages to aid debugging\n"
+"  -j, --jobs=N        run the index script on up to N records in parallel,\n"
+"                      each in a separate process (default: 1)\n"
 "      --overwrite     create the database anew (the default is to update if\n"
 "                      the database already exists)\n";
     print_stemmer_help("");
@@ -1583,6 +1904,7 @@ try {
     // If the database already exists, default to updating not overwriting.
     int database_mode = Xapian::DB_CREATE_OR_OPEN;
     verbose = false;
+    unsigned jobs = 1;
     Xapian::Stem stemmer("english");
 
     // Without this, strptime() seems to treat formats without a timezone as
@@ -1597,11 +1919,12 @@ try {
 	{ "stemmer",	REQ_ARG,	NULL, 's' },
 	{ "overwrite",	NO_ARG,		NULL, 'o' },
 	{ "verbose",	NO_ARG,		NULL, 'v' },
+	{ "jobs",	REQ_ARG,	NULL, 'j' },
 	{ 0, 0, NULL, 0 }
     };
 
     int getopt_ret;
-    while ((getopt_ret = gnu_getopt_long(argc, argv, "vs:hV",
+    while ((getopt_ret = gnu_getopt_long(argc, argv, "vj:s:hV",
 					 longopts, NULL)) != -1) {
 	switch (getopt_ret) {
 	    default:
@@ -1619,6 +1942,20 @@ try {
 	    case 'v':
 		verbose = true;
 		break;
+	    case 'j':
+		if (!parse_unsigned(optarg, jobs) || jobs == 0) {
+		    cerr << "Bad number of jobs '" << optarg << "'\n";
+		    return 1;
+		}
+#if !defined HAVE_FORK || !defined HAVE_WAITPID
+		if (jobs > 1) {
+		    cerr << "--jobs isn't supported in this build because the "
+			    "fork() and waitpid() functions weren't found at "
+			    "configure time.\n";
+		    return 1;
+		}
+#endif
+		break;
 	    case 's':
 		try {
 		    stemmer = Xapian::Stem(optarg);
@@ -1650,6 +1987,10 @@ try {
     // Set the database for spellings to be added to by the "spell" action.
     indexer.set_database(database);
 
+#if defined HAVE_FORK && defined HAVE_WAITPID
+    if (jobs > 1) start_workers(jobs, indexer);
+#endif
+
     addcount = 0;
     repcount = 0;
     delcount = 0;
@@ -1670,6 +2011,10 @@ try {
 	}
     }
 
+#if defined HAVE_FORK && defined HAVE_WAITPID
+    stop_workers();
+#endif
+
     cout << "records (added, replaced, deleted, skipped) = ("
 	 << addcount << ", "
 	 << repcount << ", "
@@ -0,0 +1,589 @@
+/** @file
+ * @brief Serve omega requests over HTTP from a persistent process
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <config.h>
+
+#include "serve.h"
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "safefcntl.h"
+#include "safeunistd.h"
+#include "safesyssocket.h"
+#include "safesyswait.h"
+
+#ifndef __WIN32__
+# include <netdb.h>
+# include <poll.h>
+#endif
+
+#include "cgiparam.h"
+#include "parseint.h"
+#include "setenv.h"
+#include "strcasecmp.h"
+#include "stringutils.h"
+
+using namespace std;
+
+#if defined HAVE_FORK && defined HAVE_WAITPID && !defined __WIN32__
+
+/// Maximum size of the request line and headers.
+static const size_t MAX_HEADER_SIZE = 64 * 1024;
+
+/// Maximum size of a request body.
+static const size_t MAX_BODY_SIZE = 1024 * 1024;
+
+/// Time in seconds a client has to send its whole request.
+static const int READ_TIMEOUT = 30;
+
+namespace {
+
+/// A parsed HTTP request.
+struct Request {
+    string method;
+
+    string path;
+
+    string query_string;
+
+    string protocol;
+
+    /// Header names (lower-cased) and values, in the order received.
+    vector<pair<string, string>> headers;
+
+    string body;
+
+    string remote_addr;
+};
+
+/// A client connection.
+struct Connection {
+    int fd;
+
+    /// The data read so far.
+    string buf;
+
+    /// When the client must have sent the whole request by.
+    chrono::steady_clock::time_point deadline;
+
+    string remote_addr;
+
+    /// The request, once it's been read completely.
+    Request req;
+
+    bool complete = false;
+};
+
+}
+
+static bool
+write_all(int fd, const char* p, size_t n)
+{
+    while (n) {
+	ssize_t r = write(fd, p, n);
+	if (r < 0) {
+	    if (errno == EINTR) continue;
+	    return false;
+	}
+	p += r;
+	n -= r;
+    }
+    return true;
+}
+
+static void
+send_error(int fd, const char* status)
+{
+    string response = "HTTP/1.0 ";
+    response += status;
+    response += "\r\nContent-Type: text/plain\r\n"
+		"Content-Length: ";
+    response += to_string(strlen(status) + 1);
+    response += "\r\nConnection: close\r\n\r\n";
+    response += status;
+    response += '\n';
+    (void)write_all(fd, response.data(), response.size());
+}
+
+/** Parse a request from the data read so far.
+ *
+ *  @return nullptr if @a buf holds a complete request, which has been parsed
+ *	    into @a req; "" if more data is needed; or else the HTTP status to
+ *	    report.
+ */
+static const char*
+parse_request(const string& buf, Request& req)
+{
+    size_t header_end = buf.find("\r\n\r\n");
+    size_t body_start;
+    if (header_end != string::npos) {
+	body_start = header_end + 4;
+    } else {
+	header_end = buf.find("\n\n");
+	if (header_end == string::npos) {
+	    if (buf.size() > MAX_HEADER_SIZE)
+		return "431 Request Header Fields Too Large";
+	    return "";
+	}
+	body_start = header_end + 2;
+    }
+
+    // Split the request line and headers into lines.
+    vector<string> lines;
+    size_t p = 0;
+    while (p < header_end) {
+	size_t q = buf.find('\n', p);
+	if (q > header_end) q = header_end;
+	size_t e = q;
+	if (e > p && buf[e - 1] == '\r') --e;
+	lines.emplace_back(buf, p, e - p);
+	p = q + 1;
+    }
+    if (lines.empty()) return "400 Bad Request";
+
+    // Request line: METHOD TARGET PROTOCOL
+    const string& line = lines[0];
+    size_t sp1 = line.find(' ');
+    size_t sp2 = line.rfind(' ');
+    if (sp1 == string::npos || sp2 == sp1) return "400 Bad Request";
+    req.method.assign(line, 0, sp1);
+    string target(line, sp1 + 1, sp2 - sp1 - 1);
+    req.protocol.assign(line, sp2 + 1, string::npos);
+    if (!startswith(req.protocol, "HTTP/")) return "400 Bad Request";
+    size_t qmark = target.find('?');
+    if (qmark == string::npos) {
+	req.path = std::move(target);
+    } else {
+	req.path.assign(target, 0, qmark);
+	req.query_string.assign(target, qmark + 1, string::npos);
+    }
+
+    size_t content_length = 0;
+    for (size_t i = 1; i != lines.size(); ++i) {
+	const string& header = lines[i];
+	size_t colon = header.find(':');
+	if (colon == string::npos) return "400 Bad Request";
+	string name(header, 0, colon);
+	for (char& ch : name) ch = C_tolower(ch);
+	size_t v = header.find_first_not_of(" \t", colon + 1);
+	string value;
+	if (v != string::npos) value.assign(header, v, string::npos);
+	if (name == "content-length") {
+	    if (!parse_unsigned(value.c_str(), content_length))
+		return "400 Bad Request";
+	    if (content_length > MAX_BODY_SIZE)
+		return "413 Content Too Large";
+	}
+	req.headers.emplace_back(std::move(name), std::move(value));
+    }
+
+    if (req.method == "POST") {
+	if (buf.size() - body_start < content_length) return "";
+	req.body.assign(buf, body_start, content_length);
+    } else if (req.method != "GET" && req.method != "HEAD") {
+	return "501 Not Implemented";
+    }
+    return nullptr;
+}
+
+/** Set up the environment a CGI program would see for @a req.
+ *
+ *  Omega reads a few of these itself, and templates can read them with
+ *  $env.
+ */
+static void
+set_cgi_environment(const Request& req)
+{
+    setenv("GATEWAY_INTERFACE", "CGI/1.1", 1);
+    setenv("REQUEST_METHOD", req.method.c_str(), 1);
+    setenv("SCRIPT_NAME", req.path.c_str(), 1);
+    setenv("QUERY_STRING", req.query_string.c_str(), 1);
+    setenv("SERVER_PROTOCOL", req.protocol.c_str(), 1);
+    setenv("REMOTE_ADDR", req.remote_addr.c_str(), 1);
+    if (req.method == "POST")
+	setenv("CONTENT_LENGTH", to_string(req.body.size()).c_str(), 1);
+    for (auto&& header : req.headers) {
+	string var;
+	if (header.first == "content-type") {
+	    var = "CONTENT_TYPE";
+	} else if (header.first == "content-length") {
+	    continue;
+	} else {
+	    var = "HTTP_";
+	    for (char ch : header.first) {
+		var += (ch == '-' ? '_' : C_toupper(ch));
+	    }
+	}
+	setenv(var.c_str(), header.second.c_str(), 1);
+    }
+}
+
+/** Convert CGI output to an HTTP response.
+ *
+ *  A "Status:" header gives the status line, otherwise a "Location:" header
+ *  means a redirect, otherwise the status is "200 OK".
+ */
+static string
+cgi_to_http(const string& output, bool head_only)
+{
+    string status;
+    string headers;
+    size_t p = 0;
+    bool redirect = false;
+    while (true) {
+	size_t q = output.find('\n', p);
+	if (q == string::npos) {
+	    // No blank line after the headers, so treat the whole output as
+	    // the body.
+	    headers.clear();
+	    status.clear();
+	    redirect = false;
+	    p = 0;
+	    break;
+	}
+	size_t e = q;
+	if (e > p && output[e - 1] == '\r') --e;
+	if (e == p) {
+	    p = q + 1;
+	    break;
+	}
+	if (e - p > 7 && strncasecmp(output.data() + p, "Status:", 7) == 0) {
+	    size_t v = output.find_first_not_of(" \t", p + 7);
+	    if (v < e) status.assign(output, v, e - v);
+	} else {
+	    if (e - p > 9 &&
+		strncasecmp(output.data() + p, "Location:", 9) == 0) {
+		redirect = true;
+	    }
+	    headers.append(output, p, e - p);
+	    headers += "\r\n";
+	}
+	p = q + 1;
+    }
+    if (status.empty()) status = redirect ? "302 Found" : "200 OK";
+
+    string response = "HTTP/1.0 ";
+    response += status;
+    response += "\r\n";
+    response += headers;
+    response += "Content-Length: ";
+    response += to_string(output.size() - p);
+    response += "\r\nConnection: close\r\n\r\n";
+    if (!head_only) response.append(output, p, string::npos);
+    return response;
+}
+
+/// Handle a request in the child process.
+[[noreturn]]
+static void
+run_child(int fd, const Request& req, void (*handle)(), void (*report)())
+{
+    set_cgi_environment(req);
+
+    ostringstream output;
+    auto old_buf = cout.rdbuf(output.rdbuf());
+    bool failed = false;
+    try {
+	handle();
+    } catch (...) {
+	// If no body has been output yet, make the response an error rather
+	// than "200 OK".
+	const string& so_far = output.str();
+	size_t end_of_headers = so_far.find("\n\n");
+	failed = (end_of_headers == string::npos ||
+		  end_of_headers + 2 == so_far.size());
+	report();
+    }
+    cout.rdbuf(old_buf);
+
+    string cgi_output = output.str();
+    if (failed) cgi_output.insert(0, "Status: 500 Internal Server Error\n");
+    string response = cgi_to_http(cgi_output, req.method == "HEAD");
+    (void)write_all(fd, response.data(), response.size());
+    close(fd);
+    // Use _exit() so we don't flush any stdio buffers inherited from the
+    // parent or run destructors for objects the parent is still using.
+    _exit(0);
+}
+
+/// Pipe which the SIGCHLD handler writes to, to wake up poll().
+static int wake_fds[2] = { -1, -1 };
+
+extern "C" {
+
+static void
+handle_sigchld(int)
+{
+    int saved_errno = errno;
+    if (write(wake_fds[1], "", 1) < 0) {
+	// The pipe is full so poll() will wake up anyway.
+    }
+    errno = saved_errno;
+}
+
+}
+
+void
+serve_http(const string& address,
+	   unsigned max_children,
+	   void (*prepare)(),
+	   void (*handle)(),
+	   void (*report)())
+{
+    string host = "127.0.0.1";
+    string port = address;
+    size_t colon = address.rfind(':');
+    if (colon != string::npos) {
+	host.assign(address, 0, colon);
+	port.assign(address, colon + 1, string::npos);
+	// Allow an IPv6 address in square brackets.
+	if (host.size() > 1 && host.front() == '[' && host.back() == ']')
+	    host = host.substr(1, host.size() - 2);
+    }
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    struct addrinfo* result;
+    int r = getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(),
+			&hints, &result);
+    if (r != 0) {
+	throw "Couldn't resolve address '" + address + "': " +
+	    gai_strerror(r);
+    }
+
+    int listen_fd = -1;
+    int eno = 0;
+    for (auto a = result; a; a = a->ai_next) {
+	listen_fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+	if (listen_fd < 0) {
+	    eno = errno;
+	    continue;
+	}
+	int on = 1;
+	(void)setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR,
+			 reinterpret_cast<char*>(&on), sizeof(on));
+	if (bind(listen_fd, a->ai_addr, a->ai_addrlen) == 0 &&
+	    listen(listen_fd, 64) == 0) {
+	    break;
+	}
+	eno = errno;
+	close(listen_fd);
+	listen_fd = -1;
+    }
+    freeaddrinfo(result);
+    if (listen_fd < 0) {
+	throw "Couldn't listen on '" + address + "': " + strerror(eno);
+    }
+
+    // Children are reaped as soon as they exit: the SIGCHLD handler writes
+    // to a pipe which we poll() along with the sockets.
+    if (pipe(wake_fds) < 0) {
+	throw string("Couldn't create pipe: ") + strerror(errno);
+    }
+    for (int wake_fd : wake_fds) {
+	(void)fcntl(wake_fd, F_SETFL, fcntl(wake_fd, F_GETFL) | O_NONBLOCK);
+    }
+    signal(SIGCHLD, handle_sigchld);
+
+    // Don't get killed if a client disconnects before we've written the
+    // response.
+    signal(SIGPIPE, SIG_IGN);
+
+    if (max_children == 0) max_children = 1;
+    unsigned children = 0;
+    // Requests are read from all clients at once, so a slow client doesn't
+    // hold up the others.
+    list<Connection> conns;
+    while (true) {
+	// Reap any children which have finished.
+	while (children) {
+	    pid_t pid = waitpid(-1, nullptr, WNOHANG);
+	    if (pid > 0) {
+		--children;
+		continue;
+	    }
+	    if (pid < 0 && errno == EINTR) continue;
+	    if (pid < 0) children = 0;
+	    break;
+	}
+
+	// Start handling complete requests, up to the limit on children.
+	auto now = chrono::steady_clock::now();
+	int timeout = -1;
+	for (auto i = conns.begin(); i != conns.end(); ) {
+	    Connection& conn = *i;
+	    if (!conn.complete) {
+		if (conn.deadline <= now) {
+		    send_error(conn.fd, "408 Request Timeout");
+		    close(conn.fd);
+		    i = conns.erase(i);
+		    continue;
+		}
+		auto wait = chrono::duration_cast<chrono::milliseconds>(
+				conn.deadline - now).count() + 1;
+		if (timeout < 0 || wait < timeout) timeout = int(wait);
+		++i;
+		continue;
+	    }
+	    if (children >= max_children) {
+		++i;
+		continue;
+	    }
+
+	    Request& req = conn.req;
+	    if (req.method == "POST") {
+		decode_string(req.body);
+	    } else {
+		decode_string(req.query_string);
+	    }
+
+	    try {
+		prepare();
+	    } catch (...) {
+		// The child will report any problem when it handles the
+		// request.
+	    }
+
+	    pid_t pid = fork();
+	    if (pid == 0) {
+		signal(SIGCHLD, SIG_DFL);
+		close(wake_fds[0]);
+		close(wake_fds[1]);
+		close(listen_fd);
+		for (auto& other : conns) {
+		    if (&other != &conn) close(other.fd);
+		}
+		run_child(conn.fd, req, handle, report);
+	    }
+	    if (pid < 0) {
+		send_error(conn.fd, "503 Service Unavailable");
+	    } else {
+		++children;
+	    }
+	    close(conn.fd);
+	    i = conns.erase(i);
+	}
+
+	vector<struct pollfd> fds;
+	vector<Connection*> fd_conns;
+	for (int fd : { wake_fds[0], listen_fd }) {
+	    struct pollfd pfd;
+	    pfd.fd = fd;
+	    pfd.events = POLLIN;
+	    pfd.revents = 0;
+	    fds.push_back(pfd);
+	}
+	for (auto& conn : conns) {
+	    if (conn.complete) continue;
+	    struct pollfd pfd;
+	    pfd.fd = conn.fd;
+	    pfd.events = POLLIN;
+	    pfd.revents = 0;
+	    fds.push_back(pfd);
+	    fd_conns.push_back(&conn);
+	}
+	if (poll(fds.data(), fds.size(), timeout) < 0) {
+	    if (errno == EINTR) continue;
+	    throw string("poll() failed: ") + strerror(errno);
+	}
+
+	if (fds[0].revents) {
+	    char buf[64];
+	    while (read(wake_fds[0], buf, sizeof(buf)) > 0) { }
+	}
+
+	for (size_t j = 2; j != fds.size(); ++j) {
+	    if (fds[j].revents == 0) continue;
+	    Connection& conn = *fd_conns[j - 2];
+	    char data[4096];
+	    ssize_t n = read(conn.fd, data, sizeof(data));
+	    const char* error;
+	    if (n > 0) {
+		conn.buf.append(data, n);
+		Request req;
+		error = parse_request(conn.buf, req);
+		if (!error) {
+		    req.remote_addr = std::move(conn.remote_addr);
+		    conn.req = std::move(req);
+		    conn.complete = true;
+		    conn.buf = string();
+		    continue;
+		}
+		if (!*error) {
+		    // Need more data.
+		    continue;
+		}
+	    } else if (n < 0 && (errno == EINTR || errno == EAGAIN)) {
+		continue;
+	    } else {
+		// The client closed the connection (or there was an error)
+		// before sending the whole request.
+		error = "400 Bad Request";
+	    }
+	    send_error(conn.fd, error);
+	    close(conn.fd);
+	    conn.fd = -1;
+	}
+	conns.remove_if([](const Connection& conn) { return conn.fd < 0; });
+
+	if (fds[1].revents) {
+	    struct sockaddr_storage remote;
+	    SOCKLEN_T remote_len = sizeof(remote);
+	    int fd = accept(listen_fd,
+			    reinterpret_cast<struct sockaddr*>(&remote),
+			    &remote_len);
+	    if (fd >= 0) {
+		conns.emplace_back();
+		Connection& conn = conns.back();
+		conn.fd = fd;
+		conn.deadline = chrono::steady_clock::now() +
+				chrono::seconds(READ_TIMEOUT);
+		char addr[NI_MAXHOST];
+		if (getnameinfo(reinterpret_cast<struct sockaddr*>(&remote),
+				remote_len, addr, sizeof(addr), nullptr, 0,
+				NI_NUMERICHOST) == 0) {
+		    conn.remote_addr = addr;
+		}
+	    }
+	}
+    }
+}
+
+#else
+
+void
+serve_http(const string&, unsigned, void (*)(), void (*)(), void (*)())
+{
+    throw string("Serving over HTTP isn't supported on this platform");
+}
+
+#endif
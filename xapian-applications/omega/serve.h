@@ -0,0 +1,59 @@
+/** @file
+ * @brief Serve omega requests over HTTP from a persistent process
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef OMEGA_INCLUDED_SERVE_H
+#define OMEGA_INCLUDED_SERVE_H
+
+#include <string>
+
+/** Serve HTTP requests.
+ *
+ *  Requests are read from all clients at once, and a client which takes
+ *  more than 30 seconds to send its request gets a 408 response.
+ *
+ *  For each request, the parameters are decoded into cgi_params and
+ *  @a prepare is called in this process, so anything it sets up is
+ *  inherited by the child process which is then forked to call @a handle
+ *  with cout going to the client.  The child's output should be in the form
+ *  a CGI program would produce, and is converted to an HTTP response.  If
+ *  @a handle throws, @a report is called from the catch block to output a
+ *  description of the exception, and if there was no output before that
+ *  the response has status 500.
+ *
+ *  This function only returns if an error occurs setting up the listening
+ *  socket or waiting for connections, in which case it throws a string
+ *  describing the problem.
+ *
+ *  @param address	The address to listen on, as "[HOST:]PORT".  HOST
+ *			defaults to 127.0.0.1.
+ *  @param max_children	The maximum number of requests to handle at once.
+ *  @param prepare	Function to call before forking for each request.
+ *  @param handle	Function to call in the child process to handle each
+ *			request.
+ *  @param report	Function to call in the child process to report an
+ *			exception thrown by @a handle.
+ */
+void serve_http(const std::string& address,
+		unsigned max_children,
+		void (*prepare)(),
+		void (*handle)(),
+		void (*report)());
+
+#endif // OMEGA_INCLUDED_SERVE_H
@@ -471,3 +471,19 @@ comms_error:
 #endif
     return 1;
 }
+
+void
+Worker::stop()
+{
+    if (!sockt) return;
+    // The assistant exits when it sees EOF on the socket.
+    fclose(sockt);
+    sockt = NULL;
+#ifdef HAVE_WAITPID
+    while (waitpid(child, NULL, 0) < 0 && errno == EINTR) { }
+#elif defined __WIN32__
+    WaitForSingleObject(child, INFINITE);
+#else
+# error Omega needs porting to this platform
+#endif
+}
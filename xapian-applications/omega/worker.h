@@ -130,6 +130,12 @@ class Worker {
 		int& pages,
 		time_t& created);
 
+    /** Stop the assistant process, if it's running.
+     *
+     *  It will be started again if extract() is called.
+     */
+    void stop();
+
     /** Returns an error message if the extraction fails, or an empty string
      *  if everything is okay.
      */
@@ -1,5 +1,6 @@
 noinst_HEADERS +=\
 	api/documenttermlist.h\
+	api/docidorder.h\
 	api/documentvaluelist.h\
 	api/editdistance.h\
 	api/enquireinternal.h\
@@ -24,6 +25,7 @@ lib_src +=\
 	api/constinfo.cc\
 	api/database.cc\
 	api/decvalwtsource.cc\
+	api/docidorder.cc\
 	api/document.cc\
 	api/documenttermlist.cc\
 	api/documentvaluelist.cc\
@@ -26,6 +26,7 @@
 
 #include <algorithm>
 #include <fstream>
+#include <map>
 #include <string_view>
 #include <vector>
 
@@ -41,6 +42,7 @@
 #include "backends/backends.h"
 #include "backends/databaseinternal.h"
 #include "backends/postlist.h"
+#include "docidorder.h"
 #include "debuglog.h"
 #include "omassert.h"
 #include "filetests.h"
@@ -63,7 +65,9 @@
 
 #include <xapian/constants.h>
 #include <xapian/database.h>
+#include <xapian/document.h>
 #include <xapian/error.h>
+#include <xapian/termiterator.h>
 
 using namespace std;
 
@@ -100,6 +104,81 @@ Compactor::resolve_duplicate_metadata(const string & key,
     return tags[0];
 }
 
+string
+Compactor::get_reorder_key(const Xapian::Document& doc)
+{
+    (void)doc;
+    return string();
+}
+
+void
+Compactor::set_new_docid(Xapian::docid old_did, Xapian::docid new_did)
+{
+    (void)old_did;
+    (void)new_did;
+}
+
+}
+
+/** Copy the documents of @a db to @a tmpdb in the order chosen for them.
+ *
+ *  User metadata, spellings and synonyms are copied too, with any user
+ *  metadata which is set in more than one shard resolved as compaction
+ *  would.
+ */
+static void
+copy_reordered(const Xapian::Database& db,
+	       const vector<const Xapian::Database::Internal*>& internals,
+	       Xapian::WritableDatabase& tmpdb,
+	       Xapian::Compactor* compactor,
+	       Xapian::valueno sort_slot,
+	       bool sort_reverse)
+{
+    if (compactor) compactor->set_status("docids", string());
+    vector<Xapian::docid> order = reorder_docids(db, compactor,
+						 sort_slot, sort_reverse);
+
+    Xapian::docid new_did = 0;
+    for (Xapian::docid did : order) {
+	tmpdb.replace_document(++new_did, db.get_document(did));
+	if (compactor) compactor->set_new_docid(did, new_did);
+    }
+    if (compactor) {
+	compactor->set_status("docids",
+			      "Reordered " + str(new_did) + " documents");
+    }
+
+    map<string, vector<string>> metadata;
+    for (auto shard : internals) {
+	auto shard_internal = const_cast<Xapian::Database::Internal*>(shard);
+	Xapian::Database shard_db(shard_internal);
+	for (auto k = shard_db.metadata_keys_begin();
+	     k != shard_db.metadata_keys_end(); ++k) {
+	    metadata[*k].push_back(shard_db.get_metadata(*k));
+	}
+    }
+    for (auto&& i : metadata) {
+	const string& key = i.first;
+	const vector<string>& tags = i.second;
+	string tag = tags[0];
+	if (tags.size() > 1 && compactor) {
+	    tag = compactor->resolve_duplicate_metadata(key, tags.size(),
+							tags.data());
+	}
+	if (!tag.empty()) tmpdb.set_metadata(key, tag);
+    }
+
+    for (auto w = db.spellings_begin(); w != db.spellings_end(); ++w) {
+	tmpdb.add_spelling(*w, w.get_termfreq());
+    }
+
+    for (auto k = db.synonym_keys_begin(); k != db.synonym_keys_end(); ++k) {
+	for (auto s = db.synonyms_begin(*k); s != db.synonyms_end(*k); ++s) {
+	    tmpdb.add_synonym(*k, *s);
+	}
+    }
+
+    tmpdb.commit();
 }
 
 [[noreturn]]
@@ -131,6 +210,10 @@ Database::compact_(const string_view* output_ptr, int fd, unsigned flags,
     LOGCALL_VOID(API, "Database::compact_", output_ptr | fd | flags | block_size | compactor);
 
     bool renumber = !(flags & DBCOMPACT_NO_RENUMBER);
+    if ((flags & DBCOMPACT_REORDER) && !renumber) {
+	throw InvalidArgumentError("DBCOMPACT_REORDER can't be used with "
+				   "DBCOMPACT_NO_RENUMBER");
+    }
 
     enum { STUB_NO, STUB_FILE, STUB_DIR } compact_to_stub = STUB_NO;
     string destdir;
@@ -303,6 +386,83 @@ Database::compact_(const string_view* output_ptr, int fd, unsigned flags,
 	swap(used_ranges, used_ranges_);
     }
 
+    Xapian::valueno sort_slot = BAD_VALUENO;
+    bool sort_reverse = false;
+    if (compactor) {
+	sort_slot = compactor->sort_slot;
+	sort_reverse = compactor->sort_reverse;
+    }
+    if (sort_slot != BAD_VALUENO) {
+	auto out_backend = flags & DB_BACKEND_MASK_;
+	if (out_backend ? out_backend != DB_BACKEND_HONEY
+			: backend != BACKEND_HONEY) {
+	    throw InvalidArgumentError("Compactor::set_sort_by_value() is only "
+				       "supported when compacting to honey");
+	}
+	if (!(flags & DBCOMPACT_REORDER) &&
+	    !in_value_order(internals, sort_slot, sort_reverse)) {
+	    if (!renumber) {
+		throw InvalidOperationError("Documents need reordering to "
+					    "sort by value, but "
+					    "DBCOMPACT_NO_RENUMBER was "
+					    "specified");
+	    }
+	    flags |= DBCOMPACT_REORDER;
+	}
+    }
+
+    if (flags & DBCOMPACT_REORDER) {
+	if (!output_ptr) {
+	    throw InvalidArgumentError("Reordering documents isn't supported "
+				       "when compacting to a file "
+				       "descriptor");
+	}
+	int out_backend = flags & DB_BACKEND_MASK_;
+	if (out_backend == 0) {
+	    out_backend = (backend == BACKEND_HONEY ?
+			   DB_BACKEND_HONEY : DB_BACKEND_GLASS);
+	} else if (backend == BACKEND_HONEY && out_backend != DB_BACKEND_HONEY) {
+	    throw Xapian::UnimplementedError("Honey can only be compacted to "
+					     "itself");
+	}
+
+	// Write the documents in their new order to a temporary glass
+	// database next to the output, and compact that.
+	string tmpdir(*output_ptr);
+	while (!tmpdir.empty() && tmpdir.back() == '/') tmpdir.pop_back();
+	tmpdir += ".reorder-tmp";
+	// Create a new directory, adding a numeric suffix if needed, so that
+	// we never touch anything which is already there.
+	size_t sfx = tmpdir.size();
+	unsigned n = 0;
+	while (mkdir(tmpdir.c_str(), 0755) < 0) {
+	    if (errno != EEXIST) {
+		string msg = tmpdir;
+		msg += ": cannot create directory";
+		throw Xapian::DatabaseCreateError(msg, errno);
+	    }
+	    tmpdir.resize(sfx);
+	    tmpdir += str(++n);
+	}
+	try {
+	    {
+		Xapian::WritableDatabase tmpdb(tmpdir,
+					       DB_CREATE | DB_BACKEND_GLASS);
+		copy_reordered(*this, internals, tmpdb, compactor,
+			       sort_slot, sort_reverse);
+	    }
+	    unsigned tmp_flags = (flags & ~(DBCOMPACT_REORDER |
+					    DB_BACKEND_MASK_)) | out_backend;
+	    Xapian::Database(tmpdir).compact_(output_ptr, fd, tmp_flags,
+					      block_size, compactor);
+	} catch (...) {
+	    removedir(tmpdir);
+	    throw;
+	}
+	removedir(tmpdir);
+	return;
+    }
+
     string stub_file;
     if (compact_to_stub) {
 	stub_file = destdir;
@@ -353,6 +513,22 @@ Database::compact_(const string_view* output_ptr, int fd, unsigned flags,
 	switch (output_backend) {
 	    case 0:
 	    case Xapian::DB_BACKEND_GLASS:
+		if (flags & Xapian::DBCOMPACT_IMPACTS) {
+		    throw Xapian::InvalidArgumentError("DBCOMPACT_IMPACTS is "
+						       "only supported when "
+						       "compacting to honey");
+		}
+		if (flags & Xapian::DBCOMPACT_TERM_FILTER) {
+		    throw Xapian::InvalidArgumentError("DBCOMPACT_TERM_FILTER "
+						       "is only supported when "
+						       "compacting to honey");
+		}
+		if (flags & Xapian::DBCOMPACT_BLOCK_POSITIONS) {
+		    throw Xapian::InvalidArgumentError("DBCOMPACT_BLOCK_"
+						       "POSITIONS is only "
+						       "supported when "
+						       "compacting to honey");
+		}
 #ifdef XAPIAN_HAS_GLASS_BACKEND
 		if (output_ptr) {
 		    GlassDatabase::compact(compactor, destdir.c_str(), 0,
@@ -381,13 +557,15 @@ Database::compact_(const string_view* output_ptr, int fd, unsigned flags,
 					   Xapian::DB_BACKEND_GLASS,
 					   internals, offset,
 					   compaction, flags,
-					   last_docid);
+					   last_docid,
+					   sort_slot, sort_reverse);
 		} else {
 		    HoneyDatabase::compact(compactor, NULL, fd,
 					   Xapian::DB_BACKEND_GLASS,
 					   internals, offset,
 					   compaction, flags,
-					   last_docid);
+					   last_docid,
+					   sort_slot, sort_reverse);
 		}
 		break;
 #else
@@ -413,13 +591,15 @@ Database::compact_(const string_view* output_ptr, int fd, unsigned flags,
 					   Xapian::DB_BACKEND_HONEY,
 					   internals, offset,
 					   compaction, flags,
-					   last_docid);
+					   last_docid,
+					   sort_slot, sort_reverse);
 		} else {
 		    HoneyDatabase::compact(compactor, NULL, fd,
 					   Xapian::DB_BACKEND_HONEY,
 					   internals, offset,
 					   compaction, flags,
-					   last_docid);
+					   last_docid,
+					   sort_slot, sort_reverse);
 		}
 		break;
 #else
@@ -107,6 +107,16 @@ Database::size() const
     return internal->size();
 }
 
+void
+Database::set_contiguous_shards(bool contiguous)
+{
+    if (internal->size() <= 1) {
+	// With a single shard, both mappings are the identity.
+	return;
+    }
+    static_cast<MultiDatabase*>(internal.get())->set_contiguous(contiguous);
+}
+
 void
 Database::add_database_(const Database& o, bool read_only)
 {
@@ -527,6 +537,18 @@ Database::get_revision() const
     return internal->get_revision();
 }
 
+void
+Database::set_filter_cache_size(size_t max_bytes)
+{
+    internal->set_filter_cache_size(max_bytes);
+}
+
+void
+Database::set_doclength_cache(bool enable)
+{
+    internal->set_doclength_cache(enable);
+}
+
 string
 Database::reconstruct_text(Xapian::docid did,
 			   size_t length,
@@ -0,0 +1,295 @@
+/** @file
+ * @brief Choose a new document order for compaction.
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <config.h>
+
+#include "docidorder.h"
+
+#include <xapian/compactor.h>
+#include <xapian/database.h>
+#include <xapian/document.h>
+#include <xapian/postingiterator.h>
+#include <xapian/termiterator.h>
+#include <xapian/valueiterator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+
+using namespace std;
+
+/// Ranges with fewer documents than this aren't bisected further.
+static const size_t BISECT_MIN_DOCS = 16;
+
+/// Maximum number of rounds of swapping documents when bisecting a range.
+static const unsigned BISECT_ROUNDS = 20;
+
+namespace {
+
+/** Recursive graph bisection.
+ *
+ *  See "Compressing Graphs and Indexes with Recursive Graph Bisection",
+ *  Dhulipala et al, KDD 2016.  Each range of documents is split in half, and
+ *  documents are swapped between the halves while that reduces the estimated
+ *  cost of encoding the docid gaps in both halves.  Then each half is
+ *  bisected in turn.
+ */
+class GraphBisection {
+    /// Term ids in each document, indexed by document number.
+    vector<vector<unsigned>> doc_terms;
+
+    /// Number of documents in the left half containing each term.
+    vector<unsigned> left_deg;
+
+    /// Number of documents in the right half containing each term.
+    vector<unsigned> right_deg;
+
+    /// Gain from moving a document with each term from left to right.
+    vector<double> gain_to_right;
+
+    /// Gain from moving a document with each term from right to left.
+    vector<double> gain_to_left;
+
+    /// Gain from moving each document to the other half.
+    vector<double> doc_gain;
+
+    /// Used to find the distinct terms in a range of documents.
+    vector<unsigned> term_seen;
+
+    /// Value of term_seen entries for terms seen in the current range.
+    unsigned seen_stamp = 0;
+
+    /// Estimated cost of a term with @a deg documents in @a n documents.
+    static double cost(unsigned deg, unsigned n) {
+	if (deg == 0) return 0.0;
+	return deg * log2(double(n) / (deg + 1));
+    }
+
+    void move_terms(unsigned doc, vector<unsigned>& from,
+		    vector<unsigned>& to) {
+	for (unsigned t : doc_terms[doc]) {
+	    --from[t];
+	    ++to[t];
+	}
+    }
+
+  public:
+    /** Construct.
+     *
+     *  @param db	The database.
+     *  @param docids	The docids of @a db, in ascending order.
+     */
+    GraphBisection(const Xapian::Database& db,
+		   const vector<Xapian::docid>& docids)
+	: doc_terms(docids.size())
+    {
+	unsigned n_terms = 0;
+	for (auto t = db.allterms_begin(); t != db.allterms_end(); ++t) {
+	    // A term which only occurs once costs the same wherever its
+	    // document ends up.
+	    if (t.get_termfreq() < 2) continue;
+	    auto d = docids.begin();
+	    for (auto p = db.postlist_begin(*t); p != db.postlist_end(*t);
+		 ++p) {
+		d = lower_bound(d, docids.end(), *p);
+		doc_terms[d - docids.begin()].push_back(n_terms);
+	    }
+	    ++n_terms;
+	}
+	left_deg.resize(n_terms);
+	right_deg.resize(n_terms);
+	gain_to_right.resize(n_terms);
+	gain_to_left.resize(n_terms);
+	term_seen.resize(n_terms);
+	doc_gain.resize(docids.size());
+    }
+
+    /** Reorder a range of documents.
+     *
+     *  Documents are identified by their index in the docids passed to the
+     *  constructor.
+     */
+    void bisect(unsigned* begin, unsigned* end);
+};
+
+void
+GraphBisection::bisect(unsigned* begin, unsigned* end)
+{
+    size_t n = end - begin;
+    if (n < BISECT_MIN_DOCS) {
+	// Keep the original order within small ranges.
+	sort(begin, end);
+	return;
+    }
+
+    unsigned* mid = begin + n / 2;
+    unsigned n_left = mid - begin;
+    unsigned n_right = end - mid;
+
+    vector<unsigned> terms;
+    ++seen_stamp;
+    for (unsigned* d = begin; d != end; ++d) {
+	for (unsigned t : doc_terms[*d]) {
+	    if (term_seen[t] != seen_stamp) {
+		term_seen[t] = seen_stamp;
+		terms.push_back(t);
+		left_deg[t] = right_deg[t] = 0;
+	    }
+	    ++(d < mid ? left_deg : right_deg)[t];
+	}
+    }
+
+    auto by_gain = [this](unsigned a, unsigned b) {
+	if (doc_gain[a] > doc_gain[b]) return true;
+	if (doc_gain[a] < doc_gain[b]) return false;
+	return a < b;
+    };
+
+    for (unsigned round = 0; round != BISECT_ROUNDS; ++round) {
+	for (unsigned t : terms) {
+	    unsigned l = left_deg[t], r = right_deg[t];
+	    double before = cost(l, n_left) + cost(r, n_right);
+	    // Only documents containing term t use these, so the degree on
+	    // the side they're moving from is at least 1.
+	    gain_to_right[t] = l ? before -
+		(cost(l - 1, n_left) + cost(r + 1, n_right)) : 0.0;
+	    gain_to_left[t] = r ? before -
+		(cost(l + 1, n_left) + cost(r - 1, n_right)) : 0.0;
+	}
+	for (unsigned* d = begin; d != end; ++d) {
+	    const auto& gain = (d < mid ? gain_to_right : gain_to_left);
+	    double g = 0.0;
+	    for (unsigned t : doc_terms[*d]) g += gain[t];
+	    doc_gain[*d] = g;
+	}
+	sort(begin, mid, by_gain);
+	sort(mid, end, by_gain);
+
+	bool swapped = false;
+	for (unsigned *l = begin, *r = mid; l != mid && r != end; ++l, ++r) {
+	    if (doc_gain[*l] + doc_gain[*r] <= 0.0) break;
+	    move_terms(*l, left_deg, right_deg);
+	    move_terms(*r, right_deg, left_deg);
+	    swap(*l, *r);
+	    swapped = true;
+	}
+	if (!swapped) break;
+    }
+
+    bisect(begin, mid);
+    bisect(mid, end);
+}
+
+}
+
+vector<Xapian::docid>
+reorder_docids(const Xapian::Database& db, Xapian::Compactor* compactor,
+	       Xapian::valueno sort_slot, bool sort_reverse)
+{
+    vector<Xapian::docid> docids;
+    docids.reserve(db.get_doccount());
+    for (auto p = db.postlist_begin({}); p != db.postlist_end({}); ++p) {
+	docids.push_back(*p);
+    }
+
+    vector<unsigned> order(docids.size());
+    for (unsigned i = 0; i != order.size(); ++i) order[i] = i;
+
+    if (compactor || sort_slot != Xapian::BAD_VALUENO) {
+	vector<string> keys;
+	keys.reserve(docids.size());
+	if (sort_slot != Xapian::BAD_VALUENO) {
+	    auto v = db.valuestream_begin(sort_slot);
+	    auto v_end = db.valuestream_end(sort_slot);
+	    for (Xapian::docid did : docids) {
+		if (v != v_end) v.skip_to(did);
+		if (v != v_end && v.get_docid() == did) {
+		    keys.push_back(*v);
+		} else {
+		    keys.emplace_back();
+		}
+	    }
+	} else {
+	    for (Xapian::docid did : docids) {
+		auto doc = db.get_document(did);
+		keys.push_back(compactor->get_reorder_key(doc));
+	    }
+	}
+	if (sort_reverse) {
+	    stable_sort(order.begin(), order.end(),
+			[&keys](unsigned a, unsigned b) {
+			    return keys[a] > keys[b];
+			});
+	} else {
+	    stable_sort(order.begin(), order.end(),
+			[&keys](unsigned a, unsigned b) {
+			    return keys[a] < keys[b];
+			});
+	}
+
+	// Bisect each group of documents with the same key.
+	unique_ptr<GraphBisection> bisection;
+	auto group = order.begin();
+	while (group != order.end()) {
+	    const string& key = keys[*group];
+	    auto group_end = find_if(group + 1, order.end(),
+				     [&](unsigned i) { return keys[i] != key; });
+	    if (size_t(group_end - group) >= BISECT_MIN_DOCS) {
+		if (!bisection)
+		    bisection.reset(new GraphBisection(db, docids));
+		bisection->bisect(&*group, &*group + (group_end - group));
+	    }
+	    group = group_end;
+	}
+    } else if (order.size() >= BISECT_MIN_DOCS) {
+	GraphBisection(db, docids).bisect(order.data(),
+					  order.data() + order.size());
+    }
+
+    vector<Xapian::docid> result;
+    result.reserve(order.size());
+    for (unsigned i : order) result.push_back(docids[i]);
+    return result;
+}
+
+bool
+in_value_order(const vector<const Xapian::Database::Internal*>& shards,
+	       Xapian::valueno slot, bool reverse)
+{
+    string prev;
+    bool first = true;
+    for (auto shard : shards) {
+	Xapian::Database db(const_cast<Xapian::Database::Internal*>(shard));
+	auto v = db.valuestream_begin(slot);
+	auto v_end = db.valuestream_end(slot);
+	for (auto p = db.postlist_begin({}); p != db.postlist_end({}); ++p) {
+	    string value;
+	    if (v != v_end) v.skip_to(*p);
+	    if (v != v_end && v.get_docid() == *p) value = *v;
+	    if (!first && (reverse ? value > prev : value < prev))
+		return false;
+	    prev = std::move(value);
+	    first = false;
+	}
+    }
+    return true;
+}
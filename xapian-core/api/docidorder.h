@@ -0,0 +1,64 @@
+/** @file
+ * @brief Choose a new document order for compaction.
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#ifndef XAPIAN_INCLUDED_DOCIDORDER_H
+#define XAPIAN_INCLUDED_DOCIDORDER_H
+
+#include "backends/databaseinternal.h"
+#include "xapian/types.h"
+
+#include <vector>
+
+namespace Xapian {
+    class Compactor;
+}
+
+/** Choose a new order for the documents in a database.
+ *
+ *  Documents are sorted by the value in @a sort_slot if there is one, or
+ *  else by the key from Compactor::get_reorder_key().  Each group of
+ *  documents with the same key is ordered by recursive graph bisection,
+ *  which tries to minimise the sizes of the postlists when encoded as docid
+ *  gaps.
+ *
+ *  @param db		The database.
+ *  @param compactor	Compactor to get keys from (may be NULL).
+ *  @param sort_slot	Value slot to sort by, or Xapian::BAD_VALUENO.
+ *  @param sort_reverse	Sort by descending value?
+ *
+ *  @return The docids of @a db, in their new order.
+ */
+std::vector<Xapian::docid>
+reorder_docids(const Xapian::Database& db, Xapian::Compactor* compactor,
+	       Xapian::valueno sort_slot, bool sort_reverse);
+
+/** Check if documents are already in order of a value slot.
+ *
+ *  @param shards	The shards, in the order their documents will be in
+ *			the output.
+ *  @param slot		The value slot.
+ *  @param reverse	Check for descending order?
+ */
+bool
+in_value_order(const std::vector<const Xapian::Database::Internal*>& shards,
+	       Xapian::valueno slot, bool reverse);
+
+#endif // XAPIAN_INCLUDED_DOCIDORDER_H
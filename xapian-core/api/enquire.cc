@@ -36,6 +36,7 @@
 #include "xapian/intrusive_ptr.h"
 #include "xapian/keymaker.h"
 #include "xapian/matchspy.h"
+#include "xapian/matchvisitor.h"
 #include "xapian/query.h"
 #include "xapian/rset.h"
 #include "xapian/weight.h"
@@ -191,9 +192,10 @@ Enquire::clear_matchspies()
 }
 
 void
-Enquire::set_time_limit(double time_limit)
+Enquire::set_time_limit(double time_limit, bool stop_match)
 {
     internal->time_limit = time_limit;
+    internal->time_limit_stop = stop_match;
 }
 
 MSet
@@ -203,7 +205,35 @@ Enquire::get_mset(doccount first,
 		  const RSet* rset,
 		  const MatchDecider* mdecider) const
 {
-    return internal->get_mset(first, maxitems, checkatleast, rset, mdecider);
+    return internal->get_mset(first, maxitems, checkatleast, rset, mdecider,
+			      NULL);
+}
+
+MSet
+Enquire::get_mset_after(double last_weight,
+			const string& last_sort_key,
+			docid last_did,
+			doccount maxitems,
+			doccount checkatleast,
+			const RSet* rset,
+			const MatchDecider* mdecider) const
+{
+    Result after(last_weight, last_did);
+    after.set_sort_key(last_sort_key);
+    return internal->get_mset(0, maxitems, checkatleast, rset, mdecider,
+			      &after);
+}
+
+doccount
+Enquire::visit_matches(MatchVisitor& visitor, bool want_weights) const
+{
+    return internal->visit_matches(&visitor, want_weights);
+}
+
+doccount
+Enquire::get_matches_count() const
+{
+    return internal->get_matches_count();
 }
 
 TermIterator
@@ -258,7 +288,8 @@ Enquire::Internal::get_mset(doccount first,
 			    doccount maxitems,
 			    doccount checkatleast,
 			    const RSet* rset,
-			    const MatchDecider* mdecider) const
+			    const MatchDecider* mdecider,
+			    const Result* after) const
 {
     if (query.empty()) {
 	MSet mset;
@@ -307,6 +338,7 @@ Enquire::Internal::get_mset(doccount first,
 		    sort_by,
 		    sort_val_reverse,
 		    time_limit,
+		    time_limit_stop,
 		    matchspies);
 
     MSet mset = match.get_mset(first,
@@ -325,6 +357,8 @@ Enquire::Internal::get_mset(doccount first,
 			       sort_by,
 			       sort_val_reverse,
 			       time_limit,
+			       time_limit_stop,
+			       after,
 			       matchspies);
 
     if (first_orig != first) {
@@ -340,6 +374,100 @@ Enquire::Internal::get_mset(doccount first,
     return mset;
 }
 
+doccount
+Enquire::Internal::visit_matches(MatchVisitor* visitor,
+				 bool want_weights) const
+{
+    if (query.empty())
+	return 0;
+
+    // Check for remote shards up front, as the Matcher constructor sends the
+    // query to them.
+    bool have_remotes = ::Matcher::has_remote_shards(db);
+    if (visitor && have_remotes) {
+	throw Xapian::UnimplementedError("Enquire::visit_matches() not "
+					 "supported by the remote backend");
+    }
+
+    // Lazily initialise weight to its default if necessary.
+    if (!weight)
+	weight.reset(new BM25Weight);
+
+    // Lazily initialise query_length if it wasn't explicitly specified.
+    if (query_length == 0) {
+	query_length = query.get_length();
+    }
+
+    // If weights aren't wanted, scale the query by zero so that the postlist
+    // tree is built without any weighting objects and no weights get
+    // calculated.
+    Query match_query = want_weights ?
+	query : Query(Query::OP_SCALE_WEIGHT, query, 0.0);
+
+    unique_ptr<Xapian::Weight::Internal> stats(new Xapian::Weight::Internal);
+    vector<Xapian::Internal::opt_intrusive_ptr<MatchSpy>> no_spies;
+    ::Matcher match(db,
+		    match_query,
+		    query_length,
+		    NULL,
+		    *stats,
+		    *weight,
+		    false,
+		    Xapian::BAD_VALUENO,
+		    0,
+		    0,
+		    0.0,
+		    order,
+		    Xapian::BAD_VALUENO,
+		    REL,
+		    false,
+		    0.0,
+		    false,
+		    no_spies);
+
+    if (have_remotes) {
+	// The remote protocol has no counting mode, so run a match which
+	// checks every document but doesn't return any.
+	Xapian::MSet mset = match.get_mset(0,
+					   0,
+					   db.get_doccount(),
+					   *stats,
+					   *weight,
+					   NULL,
+					   NULL,
+					   Xapian::BAD_VALUENO,
+					   0,
+					   0,
+					   0.0,
+					   order,
+					   Xapian::BAD_VALUENO,
+					   REL,
+					   false,
+					   0.0,
+					   false,
+					   NULL,
+					   no_spies);
+	return mset.get_matches_estimated();
+    }
+
+    return match.visit_matches(*stats, *weight, visitor);
+}
+
+doccount
+Enquire::Internal::get_matches_count() const
+{
+    switch (query.get_type()) {
+	case Query::LEAF_TERM:
+	    // The termfreq of a single term is exact.
+	    return db.get_termfreq(*query.get_terms_begin());
+	case Query::LEAF_MATCH_ALL:
+	    return db.get_doccount();
+	default:
+	    break;
+    }
+    return visit_matches(NULL, false);
+}
+
 TermIterator
 Enquire::Internal::get_matching_terms_begin(docid did) const
 {
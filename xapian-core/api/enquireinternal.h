@@ -35,6 +35,8 @@
 #include <string>
 #include <vector>
 
+class Result;
+
 namespace Xapian {
 
 class ESet;
@@ -79,6 +81,8 @@ class Enquire::Internal : public Xapian::Internal::intrusive_base {
 
     double time_limit = 0.0;
 
+    bool time_limit_stop = false;
+
     enum { EXPAND_PROB, EXPAND_BO1 } eweight = EXPAND_PROB;
 
     double expand_k = 1.0;
@@ -91,7 +95,16 @@ class Enquire::Internal : public Xapian::Internal::intrusive_base {
 		  doccount maxitems,
 		  doccount checkatleast,
 		  const RSet* rset,
-		  const MatchDecider* mdecider) const;
+		  const MatchDecider* mdecider,
+		  const Result* after) const;
+
+    /** Pass every match to @a visitor.
+     *
+     *  If @a visitor is NULL, just count the matches.
+     */
+    doccount visit_matches(MatchVisitor* visitor, bool want_weights) const;
+
+    doccount get_matches_count() const;
 
     TermIterator get_matching_terms_begin(docid did) const;
 
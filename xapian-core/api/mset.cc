@@ -169,6 +169,18 @@ MSet::get_max_attained() const
     return internal->max_attained;
 }
 
+bool
+MSet::timed_out() const
+{
+    return internal->timed_out;
+}
+
+Xapian::doccount
+MSet::get_docs_checked() const
+{
+    return internal->docs_checked;
+}
+
 double
 MSet::get_max_possible() const
 {
@@ -285,10 +297,10 @@ MSet::Internal::convert_to_percent(double weight) const
 
 void
 MSet::Internal::unshard_docids(Xapian::doccount shard,
-			       Xapian::doccount n_shards)
+			       const ShardDocIdMap& docid_map)
 {
     for (auto& result : items) {
-	result.unshard_docid(shard, n_shards);
+	result.unshard_docid(shard, docid_map);
     }
 }
 
@@ -312,6 +324,8 @@ MSet::Internal::merge_stats(const Internal* o, bool collapsing)
     uncollapsed_estimated += o->uncollapsed_estimated;
     uncollapsed_upper_bound += o->uncollapsed_upper_bound;
     max_possible = max(max_possible, o->max_possible);
+    docs_checked += o->docs_checked;
+    timed_out = timed_out || o->timed_out;
     if (o->max_attained > max_attained) {
 	max_attained = o->max_attained;
 	percent_scale_factor = o->percent_scale_factor;
@@ -341,6 +355,8 @@ MSet::Internal::serialise() const
     pack_uint(result, uncollapsed_lower_bound);
     pack_uint(result, uncollapsed_estimated);
     pack_uint(result, uncollapsed_upper_bound);
+    pack_uint(result, docs_checked);
+    pack_bool(result, timed_out);
 
     pack_uint(result, items.size());
     for (auto&& item : items) {
@@ -375,6 +391,8 @@ MSet::Internal::unserialise(const char * p, const char * p_end)
 	!unpack_uint(&p, p_end, &uncollapsed_lower_bound) ||
 	!unpack_uint(&p, p_end, &uncollapsed_estimated) ||
 	!unpack_uint(&p, p_end, &uncollapsed_upper_bound) ||
+	!unpack_uint(&p, p_end, &docs_checked) ||
+	!unpack_bool(&p, p_end, &timed_out) ||
 	!unpack_uint(&p, p_end, &msize)) {
 	unpack_throw_serialisation_error(p);
     }
@@ -432,6 +450,10 @@ MSet::Internal::get_description() const
 	desc += ", max_attained=";
 	desc += str(max_attained);
     }
+    if (timed_out) {
+	desc += ", timed_out, docs_checked=";
+	desc += str(docs_checked);
+    }
     desc += ", [";
     bool comma = false;
     for (auto&& item : items) {
@@ -84,6 +84,12 @@ class MSet::Internal : public Xapian::Internal::intrusive_base {
     /// Scale factor to convert weights to percentages.
     double percent_scale_factor = 0;
 
+    /// The number of matching documents the matcher evaluated.
+    Xapian::doccount docs_checked = 0;
+
+    /// Did the match stop early because the time limit was reached?
+    bool timed_out = false;
+
   public:
     Internal() {}
 
@@ -122,6 +128,11 @@ class MSet::Internal : public Xapian::Internal::intrusive_base {
 
     double get_percent_scale_factor() const { return percent_scale_factor; }
 
+    void set_match_progress(Xapian::doccount docs_checked_, bool timed_out_) {
+	docs_checked = docs_checked_;
+	timed_out = timed_out_;
+    }
+
     Xapian::Document get_document(Xapian::doccount index) const;
 
     void fetch(Xapian::doccount first, Xapian::doccount last) const;
@@ -130,7 +141,8 @@ class MSet::Internal : public Xapian::Internal::intrusive_base {
 
     int convert_to_percent(double weight) const;
 
-    void unshard_docids(Xapian::doccount shard, Xapian::doccount n_shards);
+    void unshard_docids(Xapian::doccount shard,
+			const ShardDocIdMap& docid_map);
 
     void merge_stats(const Internal* o, bool collapsing);
 
@@ -26,6 +26,7 @@
 
 #include "backends/databaseinternal.h"
 #include "backends/documentinternal.h"
+#include "backends/impactlist.h"
 #include "matcher/postlisttree.h"
 
 #include "xapian/document.h"
@@ -37,6 +38,7 @@
 #include "serialise-double.h"
 #include "str.h"
 
+#include <algorithm>
 #include <cfloat>
 #include <memory>
 
@@ -552,4 +554,197 @@ FixedWeightPostingSource::get_description() const
     return desc;
 }
 
+Xapian::doccount
+ImpactPostingSource::get_termfreq_min() const
+{
+    return matches.size();
+}
+
+Xapian::doccount
+ImpactPostingSource::get_termfreq_est() const
+{
+    return matches.size();
+}
+
+Xapian::doccount
+ImpactPostingSource::get_termfreq_max() const
+{
+    return matches.size();
+}
+
+double
+ImpactPostingSource::get_weight() const
+{
+    return matches[pos].second * scale;
+}
+
+void
+ImpactPostingSource::skip_low_weights(double min_wt)
+{
+    // We know the exact weight of each entry, so can skip any which can't
+    // achieve min_wt.
+    if (min_wt <= 0.0) return;
+    while (pos != matches.size() && matches[pos].second * scale < min_wt) {
+	++pos;
+    }
+}
+
+void
+ImpactPostingSource::next(double min_wt)
+{
+    if (!started) {
+	started = true;
+    } else {
+	++pos;
+    }
+    skip_low_weights(min_wt);
+}
+
+void
+ImpactPostingSource::skip_to(Xapian::docid min_docid, double min_wt)
+{
+    started = true;
+    auto it = lower_bound(matches.begin() + pos, matches.end(), min_docid,
+			  [](const pair<Xapian::docid, unsigned>& a,
+			     Xapian::docid did) {
+			      return a.first < did;
+			  });
+    pos = it - matches.begin();
+    skip_low_weights(min_wt);
+}
+
+bool
+ImpactPostingSource::at_end() const
+{
+    return started && pos == matches.size();
+}
+
+Xapian::docid
+ImpactPostingSource::get_docid() const
+{
+    return matches[pos].first;
+}
+
+ImpactPostingSource *
+ImpactPostingSource::clone() const
+{
+    return new ImpactPostingSource(terms, max_postings);
+}
+
+string
+ImpactPostingSource::name() const
+{
+    return string("Xapian::ImpactPostingSource");
+}
+
+string
+ImpactPostingSource::serialise() const
+{
+    string result;
+    pack_uint(result, max_postings);
+    for (auto& term : terms) {
+	pack_string(result, term);
+    }
+    return result;
+}
+
+ImpactPostingSource *
+ImpactPostingSource::unserialise(const string &s) const
+{
+    const char * p = s.data();
+    const char * end = p + s.size();
+
+    Xapian::doccount new_max_postings;
+    if (!unpack_uint(&p, end, &new_max_postings)) {
+	unpack_throw_serialisation_error(p);
+    }
+    vector<string> new_terms;
+    while (p != end) {
+	string term;
+	if (!unpack_string(&p, end, term)) {
+	    unpack_throw_serialisation_error(p);
+	}
+	new_terms.push_back(std::move(term));
+    }
+    return new ImpactPostingSource(new_terms, new_max_postings);
+}
+
+void
+ImpactPostingSource::reset(const Database& db_, Xapian::doccount)
+{
+    matches.clear();
+    pos = 0;
+    started = false;
+    scale = 0.0;
+
+    vector<unique_ptr<ImpactList>> lists;
+    lists.reserve(terms.size());
+    for (auto& term : terms) {
+	ImpactList* list = db_.internal->open_impact_list(term);
+	if (!list) {
+	    throw Xapian::InvalidOperationError("ImpactPostingSource needs a "
+						"database compacted with "
+						"DBCOMPACT_IMPACTS");
+	}
+	lists.emplace_back(list);
+	scale = list->get_scale();
+    }
+
+    // Process the segments from all the lists in decreasing order of impact
+    // until we run out or reach the limit on the number of postings.
+    auto cmp = [](const ImpactList* a, const ImpactList* b) {
+	return a->get_impact() < b->get_impact();
+    };
+    vector<ImpactList*> heap;
+    for (auto& list : lists) {
+	if (list->next_segment()) heap.push_back(list.get());
+    }
+    make_heap(heap.begin(), heap.end(), cmp);
+
+    Xapian::doccount budget = max_postings ? max_postings : Xapian::doccount(-1);
+    vector<pair<Xapian::docid, unsigned>> postings;
+    while (!heap.empty() && budget) {
+	pop_heap(heap.begin(), heap.end(), cmp);
+	ImpactList* list = heap.back();
+	unsigned impact = list->get_impact();
+	Xapian::docid did;
+	while (budget && list->next_docid(did)) {
+	    postings.emplace_back(did, impact);
+	    --budget;
+	}
+	if (budget && list->next_segment()) {
+	    push_heap(heap.begin(), heap.end(), cmp);
+	} else {
+	    heap.pop_back();
+	}
+    }
+
+    // Sum the impacts for each document.
+    sort(postings.begin(), postings.end());
+    unsigned max_impact = 0;
+    for (auto& posting : postings) {
+	if (!matches.empty() && matches.back().first == posting.first) {
+	    matches.back().second += posting.second;
+	} else {
+	    matches.push_back(posting);
+	}
+	max_impact = max(max_impact, matches.back().second);
+    }
+    set_maxweight(max_impact * scale);
+}
+
+string
+ImpactPostingSource::get_description() const
+{
+    string desc("Xapian::ImpactPostingSource(");
+    for (auto& term : terms) {
+	desc += term;
+	desc += ", ";
+    }
+    desc += "max_postings=";
+    desc += str(max_postings);
+    desc += ")";
+    return desc;
+}
+
 }
@@ -34,10 +34,13 @@
 #include "matcher/andmaybepostlist.h"
 #include "matcher/andnotpostlist.h"
 #include "matcher/andpostlist.h"
+#include "matcher/bitmappostlist.h"
 #include "matcher/boolorpostlist.h"
 #include "matcher/exactphrasepostlist.h"
 #include "matcher/externalpostlist.h"
+#include "matcher/filtercache.h"
 #include "matcher/maxpostlist.h"
+#include "matcher/multiorpostlist.h"
 #include "matcher/nearpostlist.h"
 #include "matcher/orpospostlist.h"
 #include "matcher/orpostlist.h"
@@ -70,6 +73,14 @@ using namespace std;
 
 static constexpr unsigned MAX_UTF_8_CHARACTER_LENGTH = 4;
 
+/** Use MultiOrPostList for OP_OR with at least this many subqueries.
+ *
+ *  For fewer subqueries a tree of OrPostList objects is shallow enough that
+ *  it's cheaper, and OrPostList can decay to AndMaybePostList or AndPostList
+ *  which MultiOrPostList doesn't attempt.
+ */
+static constexpr size_t MULTIOR_MIN_SUBQUERIES = 4;
+
 using Xapian::Internal::AndContext;
 using Xapian::Internal::OrContext;
 using Xapian::Internal::XorContext;
@@ -463,6 +474,14 @@ OrContext::postlist(TermFreqs* termfreqs, bool bool_or)
 	return pl;
     }
 
+    if (pls.size() >= MULTIOR_MIN_SUBQUERIES) {
+	auto pl = new MultiOrPostList(pls.begin(), pls.end(), qopt->matcher,
+				      qopt->db_size);
+	// Empty pls so our destructor doesn't delete them all!
+	pls.clear();
+	return pl;
+    }
+
     // Make postlists into a heap so that the postlist with the greatest term
     // frequency is at the top of the heap.
     Heap::make(pls.begin(), pls.end(), ComparePostListTermFreqAscending());
@@ -2730,6 +2749,72 @@ QueryAndMaybe::postlist_sub_and_like(AndContext& ctx,
     return true;
 }
 
+/// Return true if @a query contains a PostingSource.
+static bool
+contains_posting_source(const Xapian::Query& query)
+{
+    if (query.get_type() == Query::LEAF_POSTING_SOURCE)
+	return true;
+    size_t n = query.get_num_subqueries();
+    for (size_t i = 0; i != n; ++i) {
+	if (contains_posting_source(query.get_subquery(i)))
+	    return true;
+    }
+    return false;
+}
+
+/** Add a PostList for unweighted @a subquery to @a ctx using @a cache.
+ *
+ *  If the cache doesn't have an entry for @a subquery, the PostList for it is
+ *  built and run to produce a bitmap which is added to the cache.  If the
+ *  bitmap might not fit in the cache, the normal PostList is used instead.
+ */
+static bool
+add_cached_filter(const Xapian::Query& subquery,
+		  AndContext& ctx,
+		  QueryOptimiser* qopt,
+		  FilterCache& cache)
+{
+    Xapian::rev rev = qopt->db.get_revision();
+    string key = subquery.serialise();
+    Xapian::Internal::intrusive_ptr<const DocIdBitmap> bitmap;
+    bitmap = cache.find(key, rev);
+    if (!bitmap) {
+	// Don't build a bitmap only to find it's too big to cache.
+	const Xapian::Database::Internal& db = qopt->db;
+	size_t max_bytes =
+	    DocIdBitmap::max_memory_used(db.get_doccount(),
+					 db.get_lastdocid());
+	if (!cache.fits(FilterCache::entry_size(key.size(), max_bytes))) {
+	    return subquery.internal->postlist_sub_and_like(ctx, qopt, 0.0,
+							    NULL);
+	}
+	DocIdBitmap* new_bitmap = new DocIdBitmap;
+	bitmap = new_bitmap;
+	PostList* pl = subquery.internal->postlist(qopt, 0.0, NULL);
+	if (pl) {
+	    (void)pl->recalc_maxweight();
+	    while (true) {
+		PostList* res = pl->next(0.0);
+		if (res) {
+		    delete pl;
+		    pl = res;
+		}
+		if (pl->at_end()) break;
+		new_bitmap->add(pl->get_docid());
+	    }
+	    qopt->destroy_postlist(pl);
+	}
+	cache.insert(std::move(key), rev, new_bitmap);
+    }
+
+    if (bitmap->size() == 0) {
+	return ctx.add_postlist(NULL, NULL);
+    }
+    qopt->add_op(bitmap->size(), bitmap->get_first(), bitmap->get_last());
+    return ctx.add_postlist(new BitmapPostList(bitmap.get()), NULL);
+}
+
 PostList*
 QueryFilter::postlist(QueryOptimiser* qopt, double factor,
 		      TermFreqs* termfreqs) const
@@ -2748,12 +2833,27 @@ QueryFilter::postlist_sub_and_like(AndContext& ctx,
 				   double factor,
 				   TermFreqs* termfreqs) const
 {
+    FilterCache* cache = qopt->db.get_filter_cache();
+    // We can't use cached bitmaps if positional information or wdf is needed,
+    // or for estimating an OP_SYNONYM's TermFreqs.
+    if (cache &&
+	(termfreqs || qopt->need_positions || qopt->compound_weight)) {
+	cache = NULL;
+    }
     QueryVector::const_iterator i;
     for (i = subqueries.begin(); i != subqueries.end(); ++i) {
 	// MatchNothing subqueries should have been removed by done().
 	Assert((*i).internal);
-	if (!(*i).internal->postlist_sub_and_like(ctx, qopt, factor, termfreqs))
-	    return false;
+	if (cache && factor == 0.0 &&
+	    (*i).get_type() != Query::LEAF_MATCH_ALL &&
+	    !contains_posting_source(*i)) {
+	    if (!add_cached_filter(*i, ctx, qopt, *cache))
+		return false;
+	} else {
+	    if (!(*i).internal->postlist_sub_and_like(ctx, qopt, factor,
+						      termfreqs))
+		return false;
+	}
 	// Second and subsequent subqueries are unweighted.
 	factor = 0.0;
     }
@@ -221,6 +221,8 @@ Registry::Internal::add_defaults()
     postingsources[source->name()] = source;
     source = new Xapian::FixedWeightPostingSource(0.0);
     postingsources[source->name()] = source;
+    source = new Xapian::ImpactPostingSource({});
+    postingsources[source->name()] = source;
     source = new Xapian::LatLongDistancePostingSource(0,
 	Xapian::LatLongCoords(),
 	Xapian::GreatCircleMetric());
@@ -83,8 +83,9 @@ class Result {
 
     void set_sort_key(const std::string& k) { sort_key = k; }
 
-    void unshard_docid(Xapian::doccount shard, Xapian::doccount n_shards) {
-	did = unshard(did, shard, n_shards);
+    void unshard_docid(Xapian::doccount shard,
+		       const ShardDocIdMap& docid_map) {
+	did = docid_map.unshard(did, shard);
     }
 
     std::string get_description() const;
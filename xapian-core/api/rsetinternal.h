@@ -35,7 +35,9 @@ class RSet::Internal : public Xapian::Internal::intrusive_base {
     // std::set rather than std::unordered_set.
     std::set<Xapian::docid> docs;
 
-    void shard(Xapian::doccount n_shards, std::vector<Xapian::RSet>& rsets) {
+    void shard(const ShardDocIdMap& docid_map,
+	       std::vector<Xapian::RSet>& rsets) {
+	Xapian::doccount n_shards = docid_map.size();
 	if (n_shards == 1 || docs.empty()) {
 	    // Either there's a single database (in which case we just need
 	    // to return ourself as the sharded RSet), or there are no relevance
@@ -53,8 +55,8 @@ class RSet::Internal : public Xapian::Internal::intrusive_base {
 	}
 
 	for (auto&& did : docs) {
-	    Xapian::docid shard_did = shard_docid(did, n_shards);
-	    rsets[shard_number(did, n_shards)].add_document(shard_did);
+	    Xapian::docid shard_did = docid_map.shard_docid(did);
+	    rsets[docid_map.shard_number(did)].add_document(shard_did);
 	}
     }
 };
@@ -6,9 +6,11 @@ noinst_HEADERS +=\
 	backends/databasehelpers.h\
 	backends/databaseinternal.h\
 	backends/databasereplicator.h\
+	backends/doclengtharray.h\
 	backends/documentinternal.h\
 	backends/empty_database.h\
 	backends/flint_lock.h\
+	backends/impactlist.h\
 	backends/leafpostlist.h\
 	backends/multi.h\
 	backends/positionlist.h\
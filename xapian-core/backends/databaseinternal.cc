@@ -25,6 +25,7 @@
 
 #include "api/termlist.h"
 #include "heap.h"
+#include "matcher/filtercache.h"
 #include "omassert.h"
 #include "postlist.h"
 #include "slowvaluelist.h"
@@ -54,6 +55,11 @@ Database::Internal::size() const
     return 1;
 }
 
+Database::Internal::~Internal()
+{
+    delete filter_cache;
+}
+
 void
 Database::Internal::keep_alive()
 {
@@ -398,6 +404,46 @@ Database::Internal::get_revision() const
     throw Xapian::UnimplementedError("This backend doesn't provide access to revision information");
 }
 
+void
+Database::Internal::set_filter_cache_size(size_t max_bytes)
+{
+    if (max_bytes == 0) {
+	delete filter_cache;
+	filter_cache = nullptr;
+	return;
+    }
+    // Changes to a writable database aren't reflected in the revision until
+    // they're committed, so we can't tell when cached entries become stale.
+    if (!is_read_only()) return;
+    try {
+	(void)get_revision();
+    } catch (const Xapian::UnimplementedError&) {
+	return;
+    }
+    if (filter_cache) {
+	filter_cache->set_max_size(max_bytes);
+    } else {
+	filter_cache = new FilterCache(max_bytes);
+    }
+}
+
+void
+Database::Internal::set_doclength_cache(bool)
+{
+}
+
+ImpactList*
+Database::Internal::open_impact_list(string_view) const
+{
+    return NULL;
+}
+
+bool
+Database::Internal::get_value_order(Xapian::valueno&, bool&) const
+{
+    return false;
+}
+
 string
 Database::Internal::get_uuid() const
 {
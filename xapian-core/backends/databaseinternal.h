@@ -36,6 +36,9 @@
 #include <string>
 #include <string_view>
 
+class FilterCache;
+class ImpactList;
+
 typedef Xapian::TermIterator::Internal TermList;
 typedef Xapian::PositionIterator::Internal PositionList;
 typedef Xapian::ValueIterator::Internal ValueList;
@@ -67,6 +70,12 @@ class Database::Internal : public Xapian::Internal::intrusive_base {
     /// The "action required" helper for the dtor_called() helper.
     void dtor_called_();
 
+    /** Cache of bitmaps for boolean filter subqueries.
+     *
+     *  NULL unless enabled by set_filter_cache_size().
+     */
+    FilterCache* filter_cache = nullptr;
+
   protected:
     /// Transaction state enum.
     enum transaction_state {
@@ -121,7 +130,7 @@ class Database::Internal : public Xapian::Internal::intrusive_base {
     /** We have virtual methods and want to be able to delete derived classes
      *  using a pointer to the base class, so we need a virtual destructor.
      */
-    virtual ~Internal() {}
+    virtual ~Internal();
 
     typedef Xapian::doccount size_type;
 
@@ -438,6 +447,44 @@ class Database::Internal : public Xapian::Internal::intrusive_base {
     /// Get revision number of database (if meaningful).
     virtual Xapian::rev get_revision() const;
 
+    /** Set the size of the cache for boolean filter subqueries.
+     *
+     *  The cache is only enabled for read-only databases which support
+     *  get_revision() - for other databases this is a no-op.
+     *
+     *  @param max_bytes  Maximum number of bytes to use (0 to disable).
+     */
+    virtual void set_filter_cache_size(size_t max_bytes);
+
+    /// Return the filter subquery cache, or NULL if it isn't enabled.
+    FilterCache* get_filter_cache() const { return filter_cache; }
+
+    /** Enable or disable keeping all the document lengths in memory.
+     *
+     *  Only supported for read-only databases by backends which benefit
+     *  from it - for other databases this is a no-op.
+     */
+    virtual void set_doclength_cache(bool enable);
+
+    /** Open impact-ordered postings for a term.
+     *
+     *  @return NULL if this database doesn't store impact-ordered postings
+     *	    (the default), otherwise a new ImpactList object (which has no
+     *	    segments if @a term doesn't index any documents).
+     */
+    virtual ImpactList* open_impact_list(std::string_view term) const;
+
+    /** Check if the documents are stored in order of a value slot.
+     *
+     *  If so, documents are in ascending order of the value in @a slot (or
+     *  descending if @a reverse is true) when iterated in docid order, with
+     *  a missing value treated as an empty string.
+     *
+     *  @return false if the documents aren't known to be in value order
+     *	    (the default).
+     */
+    virtual bool get_value_order(Xapian::valueno& slot, bool& reverse) const;
+
     /** Get a UUID for the database.
      *
      *  The UUID will persist for the lifetime of the database.
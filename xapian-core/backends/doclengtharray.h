@@ -0,0 +1,107 @@
+/** @file
+ * @brief Bit-packed in-memory array of document lengths.
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#ifndef XAPIAN_INCLUDED_DOCLENGTHARRAY_H
+#define XAPIAN_INCLUDED_DOCLENGTHARRAY_H
+
+#include "xapian/types.h"
+
+#include <cstdint>
+#include <vector>
+
+/** Bit-packed in-memory array of document lengths, indexed by docid.
+ *
+ *  Each entry uses just enough bits to hold the largest document length
+ *  plus one, so we can use 0 to mark docids which aren't in use.
+ */
+class DocLengthArray {
+    /// Bits per entry.
+    unsigned width;
+
+    /// Mask for the bits of an entry.
+    uint64_t mask;
+
+    /// The highest docid we have an entry for.
+    Xapian::docid last_docid;
+
+    /// The packed entries.
+    std::vector<uint64_t> words;
+
+  public:
+    /** Construct an array with all docids marked as not in use.
+     *
+     *  @param last_docid_	The highest docid to allow for.
+     *  @param doclen_ubound	An upper bound on the document lengths.
+     */
+    DocLengthArray(Xapian::docid last_docid_,
+		   Xapian::termcount doclen_ubound)
+	: width(0), last_docid(last_docid_)
+    {
+	uint64_t max_entry = uint64_t(doclen_ubound) + 1;
+	while (width < 64 && (max_entry >> width)) ++width;
+	mask = (width == 64) ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+	// Add a spare word so get() can always read two words.
+	words.resize((uint64_t(last_docid) * width + 63) / 64 + 1);
+    }
+
+    /** Set the length of document @a did.
+     *
+     *  @return false if @a did or @a doclen is too large for the array.
+     */
+    bool set(Xapian::docid did, Xapian::termcount doclen) {
+	if (did == 0 || did > last_docid) return false;
+	uint64_t entry = uint64_t(doclen) + 1;
+	if (entry > mask || entry == 0) return false;
+	uint64_t bit = uint64_t(did - 1) * width;
+	size_t i = bit / 64;
+	unsigned shift = bit % 64;
+	words[i] = (words[i] & ~(mask << shift)) | (entry << shift);
+	if (shift + width > 64) {
+	    unsigned done = 64 - shift;
+	    words[i + 1] = (words[i + 1] & ~(mask >> done)) | (entry >> done);
+	}
+	return true;
+    }
+
+    /** Get the length of document @a did.
+     *
+     *  @return false if document @a did doesn't exist.
+     */
+    bool get(Xapian::docid did, Xapian::termcount& doclen) const {
+	if (rare(did == 0 || did > last_docid)) return false;
+	uint64_t bit = uint64_t(did - 1) * width;
+	size_t i = bit / 64;
+	unsigned shift = bit % 64;
+	uint64_t entry = words[i] >> shift;
+	if (shift + width > 64) entry |= words[i + 1] << (64 - shift);
+	entry &= mask;
+	if (entry == 0) return false;
+	doclen = Xapian::termcount(entry - 1);
+	return true;
+    }
+
+    /// Return the approximate number of bytes of memory used.
+    size_t memory_used() const {
+	return words.size() * sizeof(uint64_t);
+    }
+};
+
+#endif // XAPIAN_INCLUDED_DOCLENGTHARRAY_H
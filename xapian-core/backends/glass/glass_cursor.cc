@@ -226,7 +226,7 @@ GlassCursor::find_exact(const string &key)
     }
 
     B->form_key(key);
-    if (!B->find(C)) {
+    if (!B->find_from_leaf(C)) {
 	RETURN(false);
     }
     current_key = key;
@@ -260,6 +260,12 @@ GlassDatabase::open_tables(int flags)
 
     value_manager.reset();
 
+    if (postlist_table.want_doclength_array()) {
+	postlist_table.build_doclength_array(this,
+					     version_file.get_last_docid(),
+					     version_file.get_doclength_upper_bound());
+    }
+
     if (!readonly) {
 	changes.set_oldest_changeset(version_file.get_oldest_changeset());
 	glass_revision_number_t revision = version_file.get_revision();
@@ -996,6 +1002,21 @@ GlassDatabase::get_revision() const
     RETURN(version_file.get_revision());
 }
 
+void
+GlassDatabase::set_doclength_cache(bool enable)
+{
+    LOGCALL_VOID(DB, "GlassDatabase::set_doclength_cache", enable);
+    // The array isn't updated by modifications.
+    if (!readonly) return;
+    if (!enable) {
+	postlist_table.discard_doclength_array();
+    } else if (!postlist_table.want_doclength_array()) {
+	postlist_table.build_doclength_array(this,
+					     version_file.get_last_docid(),
+					     version_file.get_doclength_upper_bound());
+    }
+}
+
 string
 GlassDatabase::get_uuid() const
 {
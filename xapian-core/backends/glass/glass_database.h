@@ -298,6 +298,7 @@ class GlassDatabase : public Xapian::Database::Internal {
      *  @return the current revision number.
      */
     Xapian::rev get_revision() const;
+    void set_doclength_cache(bool enable);
     string get_uuid() const;
 
     void request_document(Xapian::docid /*did*/) const;
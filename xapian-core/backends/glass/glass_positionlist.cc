@@ -27,6 +27,7 @@
 
 #include "bitstream.h"
 #include "debuglog.h"
+#include "omassert.h"
 #include "pack.h"
 
 #include <string>
@@ -216,7 +217,20 @@ GlassRePositionList::read_data(Xapian::docid did,
 {
     LOGCALL_VOID(DB, "GlassRePositionList::read_data", did | term);
 
-    if (!cursor.find_exact(GlassPositionListTable::make_key(did, term))) {
+    if (rare(key_term_len == 0 || term != key_term)) {
+	key_term = term;
+	key.resize(0);
+	pack_string_preserving_sort(key, term);
+	key_term_len = key.size();
+    } else {
+	key.resize(key_term_len);
+    }
+    pack_uint_preserving_sort(key, did);
+    AssertEq(key, GlassPositionListTable::make_key(did, term));
+
+    // Successive calls are usually for nearby entries, which cursor handles
+    // efficiently by first checking the leaf block it's already in.
+    if (!cursor.find_exact(key)) {
 	cursor.current_tag.clear();
     }
 
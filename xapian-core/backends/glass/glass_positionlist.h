@@ -108,6 +108,19 @@ class GlassRePositionList : public GlassBasePositionList {
     /// Cursor for locating multiple entries efficiently.
     GlassCursor cursor;
 
+    /** The key for the entry last read.
+     *
+     *  We're used for one term with ascending docids, so we keep the encoded
+     *  term and just replace the encoded docid on the end.
+     */
+    std::string key;
+
+    /// The term in @a key.
+    std::string key_term;
+
+    /// The length of the encoded term at the start of @a key.
+    size_t key_term_len = 0;
+
     /// Copying is not allowed.
     GlassRePositionList(const GlassRePositionList&) = delete;
 
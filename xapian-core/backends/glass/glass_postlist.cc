@@ -196,6 +196,13 @@ GlassPostListTable::get_freqs(string_view term,
 Xapian::termcount
 GlassPostListTable::get_doclength(Xapian::docid did,
 				  intrusive_ptr<const GlassDatabase> db) const {
+    if (doclen_array) {
+	Xapian::termcount doclen;
+	if (!doclen_array->get(did, doclen))
+	    throw Xapian::DocNotFoundError("Document " + str(did) +
+					   " not found");
+	return doclen;
+    }
     if (!doclen_pl) {
 	// Don't keep a reference back to the database, since this
 	// would make a reference loop.
@@ -210,6 +217,10 @@ bool
 GlassPostListTable::document_exists(Xapian::docid did,
 				    intrusive_ptr<const GlassDatabase> db) const
 {
+    if (doclen_array) {
+	Xapian::termcount doclen;
+	return doclen_array->get(did, doclen);
+    }
     if (!doclen_pl) {
 	// Don't keep a reference back to the database, since this
 	// would make a reference loop.
@@ -218,6 +229,29 @@ GlassPostListTable::document_exists(Xapian::docid did,
     return (doclen_pl->jump_to(did));
 }
 
+void
+GlassPostListTable::build_doclength_array(intrusive_ptr<const GlassDatabase> db,
+					  Xapian::docid last_docid,
+					  Xapian::termcount doclen_ubound)
+{
+    LOGCALL_VOID(DB, "GlassPostListTable::build_doclength_array", db | last_docid | doclen_ubound);
+    want_doclen_array = true;
+    doclen_array.reset();
+    unique_ptr<DocLengthArray> array(new DocLengthArray(last_docid,
+							doclen_ubound));
+    // We're done with pl before we return, so it doesn't need to keep a
+    // reference to the database.
+    GlassPostList pl(db, {}, false);
+    while (pl.next(0.0), !pl.at_end()) {
+	if (!array->set(pl.get_docid(), pl.get_wdf())) {
+	    // The stats don't match the doclength list, so just don't use
+	    // the array.
+	    return;
+	}
+    }
+    doclen_array = std::move(array);
+}
+
 // How big should chunks in the posting list be?  (They
 // will grow slightly bigger than this, but not more than a
 // few bytes extra) - FIXME: tune this value to try to
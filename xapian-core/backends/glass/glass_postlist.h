@@ -27,6 +27,7 @@
 
 #include <xapian/database.h>
 
+#include "backends/doclengtharray.h"
 #include "backends/leafpostlist.h"
 #include "glass_defs.h"
 #include "glass_inverter.h"
@@ -213,6 +214,15 @@ class GlassPostListTable : public GlassTable {
     /// PostList for looking up document lengths.
     mutable std::unique_ptr<GlassPostList> doclen_pl;
 
+    /** Document lengths loaded into memory.
+     *
+     *  NULL unless enabled by build_doclength_array().
+     */
+    std::unique_ptr<DocLengthArray> doclen_array;
+
+    /// Should build_doclength_array() be called again after open()?
+    bool want_doclen_array = false;
+
   public:
     /** Create a new table object.
      *
@@ -239,9 +249,35 @@ class GlassPostListTable : public GlassTable {
     void open(int flags_, const RootInfo & root_info,
 	      glass_revision_number_t rev) {
 	doclen_pl.reset(0);
+	doclen_array.reset();
 	GlassTable::open(flags_, root_info, rev);
     }
 
+    /** Load all the document lengths into memory.
+     *
+     *  Subsequent calls to get_doclength() and document_exists() then just
+     *  look in the array.  The array isn't updated by modifications, so this
+     *  should only be used for a read-only database.  It is discarded by
+     *  open(), after which the caller should call this method again if
+     *  want_doclength_array() is true.
+     *
+     *  @param db		The database (used to read the doclength list).
+     *  @param last_docid	The highest docid in use.
+     *  @param doclen_ubound	An upper bound on the document lengths.
+     */
+    void build_doclength_array(Xapian::Internal::intrusive_ptr<const GlassDatabase> db,
+			       Xapian::docid last_docid,
+			       Xapian::termcount doclen_ubound);
+
+    /// Discard any in-memory document lengths.
+    void discard_doclength_array() {
+	want_doclen_array = false;
+	doclen_array.reset();
+    }
+
+    /// Should build_doclength_array() be called after open()?
+    bool want_doclength_array() const { return want_doclen_array; }
+
     /// Merge changes for a term.
     void merge_changes(std::string_view term,
 		       const Inverter::PostingChanges& changes);
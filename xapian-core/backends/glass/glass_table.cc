@@ -554,6 +554,24 @@ GlassTable::find(Glass::Cursor * C_) const
     RETURN(exact);
 }
 
+bool
+GlassTable::find_from_leaf(Glass::Cursor * C_) const
+{
+    LOGCALL(DB, bool, "GlassTable::find_from_leaf", (void*)C_);
+    const uint8_t * p = C_[0].get_p();
+    if (level > 0 && p && C_[0].get_n() != BLK_UNUSED) {
+	int dir_end = DIR_END(p);
+	if (dir_end > DIR_START &&
+	    compare(LeafItem(p, DIR_START), kt) <= 0 &&
+	    compare(kt, LeafItem(p, dir_end - D2)) <= 0) {
+	    bool exact = false;
+	    C_[0].c = find_in_leaf(p, kt, C_[0].c, exact);
+	    RETURN(exact);
+	}
+    }
+    RETURN(find(C_));
+}
+
 /** compact(p) compact the block at p by shuffling all the items up to the end.
 
    MAX_FREE(p) is then maximized, and is equal to TOTAL_FREE(p).
@@ -742,6 +742,17 @@ class GlassTable {
 
   protected:
     bool find(Glass::Cursor *) const;
+
+    /** Find kt, only searching the cursor's current leaf block if possible.
+     *
+     *  If kt is within the range of keys in the leaf block @a C_ is already
+     *  on then that's the only block it can be in, so we can avoid descending
+     *  the tree from the root.  Otherwise this just calls find().
+     *
+     *  This makes lookups of ascending keys cheaper when several of them fall
+     *  in the same leaf block.
+     */
+    bool find_from_leaf(Glass::Cursor * C_) const;
     int delete_kt();
     void read_block(uint4 n, uint8_t *p) const;
     void write_block(uint4 n, const uint8_t *p,
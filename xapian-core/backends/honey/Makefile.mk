@@ -24,6 +24,7 @@ noinst_HEADERS +=\
 	backends/honey/honey_spellingwordslist.h\
 	backends/honey/honey_synonym.h\
 	backends/honey/honey_table.h\
+	backends/honey/honey_termfilter.h\
 	backends/honey/honey_termlist.h\
 	backends/honey/honey_termlisttable.h\
 	backends/honey/honey_valuelist.h\
@@ -23,10 +23,12 @@
 
 #include "xapian/compactor.h"
 #include "xapian/constants.h"
+#include "xapian/database.h"
 #include "xapian/error.h"
 #include "xapian/types.h"
 
 #include <algorithm>
+#include <cmath>
 #include <memory>
 #include <queue>
 #include <type_traits>
@@ -34,18 +36,24 @@
 #include <cerrno>
 
 #include "backends/flint_lock.h"
+#include "backends/impactlist.h"
+#include "bitstream.h"
+#include "blockpositions.h"
 #include "compression_stream.h"
 #include "honey_cursor.h"
 #include "honey_database.h"
 #include "honey_defs.h"
+#include "honey_positionlist.h"
 #include "honey_postlist_encodings.h"
 #include "honey_table.h"
+#include "honey_termfilter.h"
 #include "honey_values.h"
 #include "honey_version.h"
 #include "filetests.h"
 #include "internaltypes.h"
 #include "overflow.h"
 #include "pack.h"
+#include "serialise-double.h"
 #include "stringutils.h"
 #include "backends/valuestats.h"
 #include "wordaccess.h"
@@ -609,7 +617,14 @@ class PostlistCursor<const HoneyTable&> : private HoneyCursor {
     }
 
     bool next() {
-	if (!HoneyCursor::next()) return false;
+	do {
+	    if (!HoneyCursor::next()) return false;
+	    // Impact-ordered postings, the value order and the term filter
+	    // are regenerated for the output if wanted, so skip any in the
+	    // input.
+	} while (key_type(current_key) == Honey::KEY_IMPACTS ||
+		 key_type(current_key) == Honey::KEY_VALUE_ORDER ||
+		 key_type(current_key) == Honey::KEY_TERM_FILTER);
 	// We put all chunks into the non-initial chunk form here, then fix up
 	// the first chunk for each term in the merged database as we merge.
 	read_tag();
@@ -769,11 +784,153 @@ class PostlistCursorGt {
     }
 };
 
+/** Generates impact-ordered postings for DBCOMPACT_IMPACTS.
+ *
+ *  The impact of each posting is its weight contribution calculated with
+ *  BM25Weight's default parameters using the statistics of the merged
+ *  database, quantised to the range 1 to 255.  The scale factor to convert
+ *  impacts back to weights is stored under make_impacts_key("").
+ */
+class ImpactGenerator {
+    /// The source databases.
+    vector<Xapian::Database> dbs;
+
+    /// The docid offset to apply for each source database.
+    const vector<Xapian::docid>& offset;
+
+  public:
+    ImpactGenerator(const vector<const Xapian::Database::Internal*>& sources,
+		    const vector<Xapian::docid>& offset_)
+	: offset(offset_)
+    {
+	dbs.reserve(sources.size());
+	for (auto src : sources) {
+	    dbs.emplace_back(const_cast<Xapian::Database::Internal*>(src));
+	}
+    }
+
+    /// Write the impact-ordered postings for every term to @a out.
+    void write(HoneyTable* out) const;
+};
+
+void
+ImpactGenerator::write(HoneyTable* out) const
+{
+    Xapian::doccount N = 0;
+    Xapian::totallength total_length = 0;
+    for (auto& db : dbs) {
+	N += db.get_doccount();
+	total_length += db.get_total_length();
+    }
+    double len_factor = total_length ? double(N) / total_length : 0.0;
+
+    // This matches BM25Weight with k1 = 1, b = 0.5, min_normlen = 0.5 and
+    // wqf = 1 (for which the k3 factor is 1).
+    auto termweight = [N](Xapian::doccount tf) {
+	double tw = (N - tf + 0.5) / (tf + 0.5);
+	if (tw < 2) tw = tw * 0.5 + 1;
+	return 2.0 * log(tw);
+    };
+    // The termweight is highest for tf = 1, and the wdf part of the formula
+    // is always less than 1 so this gives an upper bound on any impact.
+    double scale = termweight(1) / 255;
+    out->add(Honey::make_impacts_key({}), serialise_double(scale));
+
+    struct TermCursor {
+	Xapian::TermIterator it;
+	size_t i;
+    };
+    auto gt = [](const TermCursor& a, const TermCursor& b) {
+	return *a.it > *b.it;
+    };
+    priority_queue<TermCursor, vector<TermCursor>, decltype(gt)> pq(gt);
+    for (size_t i = 0; i != dbs.size(); ++i) {
+	TermCursor c{dbs[i].allterms_begin(), i};
+	if (c.it != dbs[i].allterms_end()) pq.push(c);
+    }
+
+    vector<pair<unsigned, Xapian::docid>> postings;
+    vector<Xapian::docid> dids;
+    vector<size_t> which;
+    string tag;
+    while (!pq.empty()) {
+	string term = *pq.top().it;
+	Xapian::doccount tf = 0;
+	which.clear();
+	while (!pq.empty() && *pq.top().it == term) {
+	    TermCursor c = pq.top();
+	    pq.pop();
+	    tf += c.it.get_termfreq();
+	    which.push_back(c.i);
+	    if (++c.it != dbs[c.i].allterms_end()) pq.push(c);
+	}
+
+	string key = Honey::make_impacts_key(term);
+	if (key.size() > HONEY_MAX_KEY_LENGTH) {
+	    // The term is too long to have impact-ordered postings.
+	    continue;
+	}
+
+	double tw = termweight(tf);
+	postings.clear();
+	for (size_t i : which) {
+	    const Xapian::Database& db = dbs[i];
+	    for (auto p = db.postlist_begin(term); p != db.postlist_end(term);
+		 ++p) {
+		double normlen = max(p.get_doclength() * len_factor, 0.5);
+		double wdf = p.get_wdf();
+		double wt = tw * wdf / (normlen * 0.5 + 0.5 + wdf);
+		unsigned impact = unsigned(wt / scale + 0.5);
+		impact = max(1u, min(impact, 255u));
+		postings.emplace_back(impact, *p + offset[i]);
+	    }
+	}
+	// Highest impact first, then ascending docid.
+	sort(postings.begin(), postings.end(),
+	     [](const pair<unsigned, Xapian::docid>& a,
+		const pair<unsigned, Xapian::docid>& b) {
+		 if (a.first != b.first) return a.first > b.first;
+		 return a.second < b.second;
+	     });
+
+	tag.resize(0);
+	auto j = postings.begin();
+	while (j != postings.end()) {
+	    unsigned impact = j->first;
+	    dids.clear();
+	    do {
+		dids.push_back(j->second);
+	    } while (++j != postings.end() && j->first == impact);
+	    encode_impact_segment(tag, impact, dids.begin(), dids.end());
+	}
+	out->add(key, tag);
+    }
+}
+
+/// Build a HoneyTermFilter over the terms in @a sources.
+static string
+build_term_filter(const vector<const Xapian::Database::Internal*>& sources)
+{
+    vector<uint64_t> hashes;
+    for (auto src : sources) {
+	Xapian::Database db(const_cast<Xapian::Database::Internal*>(src));
+	for (auto t = db.allterms_begin(); t != db.allterms_end(); ++t) {
+	    hashes.push_back(HoneyTermFilter::hash(*t));
+	}
+    }
+    // Terms in more than one source would make the filter larger than needed.
+    sort(hashes.begin(), hashes.end());
+    hashes.erase(unique(hashes.begin(), hashes.end()), hashes.end());
+    return HoneyTermFilter::build(hashes);
+}
+
 // U : vector<HoneyTable*>::const_iterator
 template<typename T, typename U> void
 merge_postlists(Xapian::Compactor* compactor,
 		T* out, vector<Xapian::docid>::const_iterator offset,
-		U b, U e)
+		U b, U e, const ImpactGenerator* impacts = nullptr,
+		const string* value_order = nullptr,
+		const string* term_filter = nullptr)
 {
     typedef decltype(**b) table_type; // E.g. HoneyTable
     typedef PostlistCursor<table_type> cursor_type;
@@ -929,6 +1086,13 @@ merge_postlists(Xapian::Compactor* compactor,
 	}
     }
 
+    // Impact-ordered postings sort between valuestream and doclen chunks.
+    if (impacts) impacts->write(out);
+
+    if (value_order) out->add(Honey::make_value_order_key(), *value_order);
+
+    if (term_filter) out->add(Honey::make_term_filter_key(), *term_filter);
+
     // Merge doclen chunks.
     while (!pq.empty()) {
 	cursor_type* cur = pq.top();
@@ -1708,10 +1872,14 @@ template<typename T, typename U> void
 multimerge_postlists(Xapian::Compactor* compactor,
 		     T* out, const char* tmpdir,
 		     const vector<U*>& in,
-		     vector<Xapian::docid> off)
+		     vector<Xapian::docid> off,
+		     const ImpactGenerator* impacts,
+		     const string* value_order,
+		     const string* term_filter)
 {
     if (in.size() <= 3) {
-	merge_postlists(compactor, out, off.begin(), in.begin(), in.end());
+	merge_postlists(compactor, out, off.begin(), in.begin(), in.end(),
+			impacts, value_order, term_filter);
 	return;
     }
     unsigned int c = 0;
@@ -1794,7 +1962,8 @@ multimerge_postlists(Xapian::Compactor* compactor,
 	swap(off, newoff);
 	++c;
     }
-    merge_postlists(compactor, out, off.begin(), tmp.begin(), tmp.end());
+    merge_postlists(compactor, out, off.begin(), tmp.begin(), tmp.end(),
+		    impacts, value_order, term_filter);
     if (c > 0) {
 	for (size_t k = 0; k < tmp.size(); ++k) {
 	    // FIXME: unlink(tmp[k]->get_path().c_str());
@@ -1804,6 +1973,65 @@ multimerge_postlists(Xapian::Compactor* compactor,
     }
 }
 
+/** Convert a position list to the encoding requested.
+ *
+ *  @param tag		The encoded position list, which is updated in place.
+ *  @param block	true to block-pack lists which are long enough (as
+ *			Xapian::DBCOMPACT_BLOCK_POSITIONS asks for), false for
+ *			interpolative coding.
+ */
+static void
+convert_positions(string& tag, bool block)
+{
+    const char* p = tag.data();
+    const char* end = p + tag.size();
+    bool blocked = is_block_positions(p, end);
+    if (blocked == block)
+	return;
+
+    Xapian::VecCOW<Xapian::termpos> pos;
+    Xapian::termpos last;
+    if (blocked) {
+	BlockPositionReader rd;
+	Xapian::termcount size;
+	rd.init(p, end, size, last);
+	pos.reserve(size);
+	pos.push_back(rd.get_position());
+	while (pos.back() != last) pos.push_back(rd.next());
+    } else {
+	if (!unpack_uint(&p, end, &last)) {
+	    throw Xapian::DatabaseCorruptError("Position list data corrupt");
+	}
+	// A single entry list is only stored one way.
+	if (p == end)
+	    return;
+	BitReader rd(p, end);
+	Xapian::termpos first = rd.decode(last);
+	Xapian::termcount size = rd.decode(last - first) + 2;
+	if (size < HoneyPositionTable::BLOCK_POSITIONS_MIN)
+	    return;
+	rd.decode_interpolative(0, size - 1, first, last);
+	pos.reserve(size);
+	pos.push_back(first);
+	while (pos.back() != last) pos.push_back(rd.decode_interpolative_next());
+    }
+
+    string new_tag;
+    if (block) {
+	// If the gaps are too large to block-pack, leave the list as it is.
+	if (!encode_block_positions(new_tag, pos))
+	    return;
+    } else {
+	pack_uint(new_tag, last);
+	BitWriter wr(new_tag);
+	wr.encode(pos[0], last);
+	wr.encode(pos.size() - 2, last - pos[0]);
+	wr.encode_interpolative(pos, 0, pos.size() - 1);
+	swap(new_tag, wr.freeze());
+    }
+    swap(tag, new_tag);
+}
+
 template<typename T> class PositionCursor;
 
 #ifdef XAPIAN_HAS_GLASS_BACKEND
@@ -1811,12 +2039,16 @@ template<>
 class PositionCursor<const GlassTable&> : private GlassCursor {
     Xapian::docid offset;
 
+    bool block_positions;
+
   public:
     string key;
     Xapian::docid firstdid;
 
-    PositionCursor(const GlassTable* in, Xapian::docid offset_)
-	: GlassCursor(in), offset(offset_), firstdid(0) {
+    PositionCursor(const GlassTable* in, Xapian::docid offset_,
+		   bool block_positions_)
+	: GlassCursor(in), offset(offset_), block_positions(block_positions_),
+	  firstdid(0) {
 	rewind();
     }
 
@@ -1836,6 +2068,8 @@ class PositionCursor<const GlassTable&> : private GlassCursor {
 	key.resize(0);
 	pack_string_preserving_sort(key, term);
 	pack_uint_preserving_sort(key, did + offset);
+
+	convert_positions(current_tag, block_positions);
 	return true;
     }
 
@@ -1849,12 +2083,16 @@ template<>
 class PositionCursor<const HoneyTable&> : private HoneyCursor {
     Xapian::docid offset;
 
+    bool block_positions;
+
   public:
     string key;
     Xapian::docid firstdid;
 
-    PositionCursor(const HoneyTable* in, Xapian::docid offset_)
-	: HoneyCursor(in), offset(offset_), firstdid(0) {
+    PositionCursor(const HoneyTable* in, Xapian::docid offset_,
+		   bool block_positions_)
+	: HoneyCursor(in), offset(offset_), block_positions(block_positions_),
+	  firstdid(0) {
 	rewind();
     }
 
@@ -1874,6 +2112,7 @@ class PositionCursor<const HoneyTable&> : private HoneyCursor {
 	key.resize(0);
 	pack_string_preserving_sort(key, term);
 	pack_uint_preserving_sort(key, did + offset);
+	convert_positions(current_tag, block_positions);
 	return true;
     }
 
@@ -1894,7 +2133,7 @@ class PositionCursorGt {
 
 template<typename T, typename U> void
 merge_positions(T* out, const vector<U*>& inputs,
-		const vector<Xapian::docid>& offset)
+		const vector<Xapian::docid>& offset, bool block_positions)
 {
     typedef decltype(*inputs[0]) table_type; // E.g. HoneyTable
     typedef PositionCursor<table_type> cursor_type;
@@ -1902,7 +2141,7 @@ merge_positions(T* out, const vector<U*>& inputs,
     priority_queue<cursor_type*, vector<cursor_type*>, gt_type> pq;
     for (size_t i = 0; i < inputs.size(); ++i) {
 	auto in = inputs[i];
-	auto cursor = new cursor_type(in, offset[i]);
+	auto cursor = new cursor_type(in, offset[i], block_positions);
 	if (cursor->next()) {
 	    pq.push(cursor);
 	} else {
@@ -2174,7 +2413,9 @@ HoneyDatabase::compact(Xapian::Compactor* compactor,
 		       const vector<Xapian::docid>& offset,
 		       Xapian::Compactor::compaction_level compaction,
 		       unsigned flags,
-		       Xapian::docid last_docid)
+		       Xapian::docid last_docid,
+		       Xapian::valueno sort_slot,
+		       bool sort_reverse)
 {
     // Currently unused for honey.
     (void)compaction;
@@ -2305,6 +2546,27 @@ HoneyDatabase::compact(Xapian::Compactor* compactor,
 	}
     }
 
+    unique_ptr<ImpactGenerator> impacts;
+    if (flags & Xapian::DBCOMPACT_IMPACTS) {
+	impacts.reset(new ImpactGenerator(sources, offset));
+    }
+
+    // The caller has ensured the documents will be in this order.
+    string value_order;
+    if (sort_slot != Xapian::BAD_VALUENO) {
+	pack_uint(value_order, sort_slot);
+	value_order += char(sort_reverse);
+    }
+    const string* value_order_ptr =
+	(sort_slot != Xapian::BAD_VALUENO ? &value_order : nullptr);
+
+    string term_filter;
+    if (flags & Xapian::DBCOMPACT_TERM_FILTER) {
+	term_filter = build_term_filter(sources);
+    }
+    const string* term_filter_ptr =
+	(flags & Xapian::DBCOMPACT_TERM_FILTER) ? &term_filter : nullptr;
+
     string fl_serialised;
 #if 0
     if (single_file) {
@@ -2466,10 +2728,13 @@ if (source_backend == Xapian::DB_BACKEND_GLASS) {
 	    case Honey::POSTLIST: {
 		if (multipass && inputs.size() > 3) {
 		    multimerge_postlists(compactor, out, destdir,
-					 inputs, offset);
+					 inputs, offset, impacts.get(),
+					 value_order_ptr, term_filter_ptr);
 		} else {
 		    merge_postlists(compactor, out, offset.begin(),
-				    inputs.begin(), inputs.end());
+				    inputs.begin(), inputs.end(),
+				    impacts.get(), value_order_ptr,
+				    term_filter_ptr);
 		}
 		break;
 	    }
@@ -2480,7 +2745,8 @@ if (source_backend == Xapian::DB_BACKEND_GLASS) {
 		merge_synonyms(out, inputs.begin(), inputs.end());
 		break;
 	    case Honey::POSITION:
-		merge_positions(out, inputs, offset);
+		merge_positions(out, inputs, offset,
+				(flags & Xapian::DBCOMPACT_BLOCK_POSITIONS));
 		break;
 	    default: {
 		// DocData, Termlist
@@ -2753,10 +3019,13 @@ if (source_backend == Xapian::DB_BACKEND_GLASS) {
 	    case Honey::POSTLIST: {
 		if (multipass && inputs.size() > 3) {
 		    multimerge_postlists(compactor, out, destdir,
-					 inputs, offset);
+					 inputs, offset, impacts.get(),
+					 value_order_ptr, term_filter_ptr);
 		} else {
 		    merge_postlists(compactor, out, offset.begin(),
-				    inputs.begin(), inputs.end());
+				    inputs.begin(), inputs.end(),
+				    impacts.get(), value_order_ptr,
+				    term_filter_ptr);
 		}
 		break;
 	    }
@@ -2767,7 +3036,8 @@ if (source_backend == Xapian::DB_BACKEND_GLASS) {
 		merge_synonyms(out, inputs.begin(), inputs.end());
 		break;
 	    case Honey::POSITION:
-		merge_positions(out, inputs, offset);
+		merge_positions(out, inputs, offset,
+				(flags & Xapian::DBCOMPACT_BLOCK_POSITIONS));
 		break;
 	    default:
 		// DocData, Termlist
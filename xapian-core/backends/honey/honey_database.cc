@@ -286,6 +286,18 @@ HoneyDatabase::open_leaf_post_list(string_view term, bool need_read_pos) const
     return postlist_table.open_post_list(this, term, need_read_pos);
 }
 
+ImpactList*
+HoneyDatabase::open_impact_list(string_view term) const
+{
+    return postlist_table.open_impact_list(term);
+}
+
+bool
+HoneyDatabase::get_value_order(Xapian::valueno& slot, bool& reverse) const
+{
+    return postlist_table.get_value_order(slot, reverse);
+}
+
 ValueList*
 HoneyDatabase::open_value_list(Xapian::valueno slot) const
 {
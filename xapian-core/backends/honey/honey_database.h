@@ -183,6 +183,10 @@ class HoneyDatabase : public Xapian::Database::Internal {
     LeafPostList* open_leaf_post_list(std::string_view term,
 				      bool need_read_pos) const;
 
+    ImpactList* open_impact_list(std::string_view term) const;
+
+    bool get_value_order(Xapian::valueno& slot, bool& reverse) const;
+
     /** Open a value stream.
      *
      *  This returns the value in a particular slot for each document.
@@ -390,7 +394,9 @@ class HoneyDatabase : public Xapian::Database::Internal {
 		 const std::vector<Xapian::docid>& offset,
 		 Xapian::Compactor::compaction_level compaction,
 		 unsigned flags,
-		 Xapian::docid last_docid);
+		 Xapian::docid last_docid,
+		 Xapian::valueno sort_slot,
+		 bool sort_reverse);
 
     bool has_uncommitted_changes() const {
 	return false;
@@ -82,7 +82,10 @@ enum {
     KEY_VALUE_STATS_HI = 0x08,
     KEY_VALUE_CHUNK = 0x09,
     KEY_VALUE_CHUNK_HI = 0xe1, // (0xe1 for slots > 26)
-    /* 0xe2-0xe6 inclusive unused currently. */
+    KEY_IMPACTS = 0xe2,
+    KEY_VALUE_ORDER = 0xe3,
+    KEY_TERM_FILTER = 0xe4,
+    /* 0xe5-0xe6 inclusive unused currently. */
     /* 0xe7-0xee inclusive reserved for doc max wdf chunks. */
     /* 0xef-0xf6 inclusive reserved for unique terms chunks. */
     KEY_DOCLEN_CHUNK = 0xf7,
@@ -26,6 +26,7 @@
 #include <xapian/types.h>
 
 #include "bitstream.h"
+#include "blockpositions.h"
 #include "debuglog.h"
 #include "honey_cursor.h"
 #include "pack.h"
@@ -65,6 +66,14 @@ HoneyPositionTable::positionlist_count(Xapian::docid did,
 
     const char* pos = data.data();
     const char* end = pos + data.size();
+    if (is_block_positions(pos, end)) {
+	pos += 2;
+	Xapian::termcount pos_size;
+	if (!unpack_uint(&pos, end, &pos_size)) {
+	    throw Xapian::DatabaseCorruptError("Position list data corrupt");
+	}
+	RETURN(pos_size);
+    }
     Xapian::termpos pos_last;
     if (!unpack_uint(&pos, end, &pos_last)) {
 	throw Xapian::DatabaseCorruptError("Position list data corrupt");
@@ -100,6 +109,13 @@ HoneyBasePositionList::set_data(const string& data)
 
     const char* pos = data.data();
     const char* end = pos + data.size();
+    blocked = is_block_positions(pos, end);
+    if (blocked) {
+	blk_rd.init(pos, end, size, last);
+	current_pos = blk_rd.get_position();
+	return;
+    }
+
     Xapian::termpos pos_last;
     if (!unpack_uint(&pos, end, &pos_last)) {
 	throw Xapian::DatabaseCorruptError("Position list data corrupt");
@@ -154,7 +170,11 @@ HoneyBasePositionList::next()
     if (current_pos == last) {
 	return false;
     }
-    current_pos = rd.decode_interpolative_next();
+    if (blocked) {
+	current_pos = blk_rd.next();
+    } else {
+	current_pos = rd.decode_interpolative_next();
+    }
     return true;
 }
 
@@ -170,6 +190,10 @@ HoneyBasePositionList::skip_to(Xapian::termpos termpos)
 	}
 	return false;
     }
+    if (blocked) {
+	if (current_pos < termpos) current_pos = blk_rd.skip_to(termpos);
+	return true;
+    }
     while (current_pos < termpos) {
 	if (current_pos == last) {
 	    return false;
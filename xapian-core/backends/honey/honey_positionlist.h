@@ -26,6 +26,7 @@
 
 #include "backends/positionlist.h"
 #include "bitstream.h"
+#include "blockpositions.h"
 #include "honey_cursor.h"
 #include "honey_lazytable.h"
 #include "pack.h"
@@ -45,6 +46,12 @@ class HoneyBasePositionList : public PositionList {
     /// Interpolative decoder.
     BitReader rd;
 
+    /// Block-packed decoder.
+    BlockPositionReader blk_rd;
+
+    /// Is the data block-packed (so we're using @a blk_rd not @a rd)?
+    bool blocked;
+
     /// Current entry.
     Xapian::termpos current_pos;
 
@@ -130,6 +137,13 @@ class HoneyRePositionList : public HoneyBasePositionList {
 
 class HoneyPositionTable : public HoneyLazyTable {
   public:
+    /** Shortest position list which compaction will block-pack.
+     *
+     *  Shorter lists are cheap to decode anyway, and interpolative coding
+     *  is more compact.
+     */
+    static constexpr Xapian::termcount BLOCK_POSITIONS_MIN = 16;
+
     static std::string make_key(Xapian::docid did, std::string_view term) {
 	std::string key;
 	pack_string_preserving_sort(key, term);
@@ -23,6 +23,7 @@
 #define XAPIAN_INCLUDED_HONEY_POSTLIST_H
 
 #include "backends/leafpostlist.h"
+#include "honey_defs.h"
 #include "honey_positionlist.h"
 #include "pack.h"
 
@@ -53,6 +54,37 @@ make_postingchunk_key(std::string_view term, Xapian::docid did)
     return key;
 }
 
+/** Generate a key for impact-ordered postings.
+ *
+ *  With an empty @a term, this gives the key for the impact scale factor.
+ */
+inline std::string
+make_impacts_key(std::string_view term)
+{
+    std::string key(1, '\0');
+    key += char(KEY_IMPACTS);
+    if (!term.empty()) pack_string_preserving_sort(key, term, true);
+    return key;
+}
+
+/// Generate the key for the value slot the documents are ordered by.
+inline std::string
+make_value_order_key()
+{
+    std::string key(1, '\0');
+    key += char(KEY_VALUE_ORDER);
+    return key;
+}
+
+/// Generate the key for the filter over the terms in the database.
+inline std::string
+make_term_filter_key()
+{
+    std::string key(1, '\0');
+    key += char(KEY_TERM_FILTER);
+    return key;
+}
+
 inline Xapian::docid
 docid_from_key(const std::string& term, const std::string& key)
 {
@@ -28,6 +28,8 @@
 #include "honey_defs.h"
 #include "honey_postlist.h"
 #include "honey_postlist_encodings.h"
+#include "backends/impactlist.h"
+#include "serialise-double.h"
 
 #include <memory>
 #include <string_view>
@@ -41,6 +43,7 @@ HoneyPostListTable::open_post_list(const HoneyDatabase* db,
 				   bool need_read_pos) const
 {
     Assert(!term.empty());
+    if (!may_contain(term)) return nullptr;
     // Try to position cursor first so we avoid creating HoneyPostList objects
     // for terms which don't exist.
     unique_ptr<HoneyCursor> cursor(cursor_get());
@@ -59,7 +62,8 @@ HoneyPostListTable::get_freqs(std::string_view term,
 			      Xapian::termcount* collfreq_ptr) const
 {
     string chunk;
-    if (!get_exact_entry(Honey::make_postingchunk_key(term), chunk)) {
+    if (!may_contain(term) ||
+	!get_exact_entry(Honey::make_postingchunk_key(term), chunk)) {
 	if (termfreq_ptr) *termfreq_ptr = 0;
 	if (collfreq_ptr) *collfreq_ptr = 0;
 	return;
@@ -129,7 +133,8 @@ Xapian::termcount
 HoneyPostListTable::get_wdf_upper_bound(std::string_view term) const
 {
     string chunk;
-    if (!get_exact_entry(Honey::make_postingchunk_key(term), chunk)) {
+    if (!may_contain(term) ||
+	!get_exact_entry(Honey::make_postingchunk_key(term), chunk)) {
 	// Term not present.
 	return 0;
     }
@@ -148,3 +153,46 @@ HoneyPostListTable::get_wdf_upper_bound(std::string_view term) const
 	throw Xapian::DatabaseCorruptError("Postlist initial chunk header");
     return wdf_max;
 }
+
+ImpactList*
+HoneyPostListTable::open_impact_list(std::string_view term) const
+{
+    string scale_tag;
+    if (!get_exact_entry(Honey::make_impacts_key({}), scale_tag)) {
+	// Impact-ordered postings weren't generated for this database.
+	return NULL;
+    }
+    const char* p = scale_tag.data();
+    const char* pend = p + scale_tag.size();
+    double scale = unserialise_double(&p, pend);
+    if (p != pend)
+	throw Xapian::DatabaseCorruptError("Impact scale factor corrupt");
+
+    string data;
+    (void)get_exact_entry(Honey::make_impacts_key(term), data);
+    return new ImpactList(std::move(data), scale);
+}
+
+bool
+HoneyPostListTable::get_value_order(Xapian::valueno& slot,
+				    bool& reverse) const
+{
+    string tag;
+    if (!get_exact_entry(Honey::make_value_order_key(), tag))
+	return false;
+    const char* p = tag.data();
+    const char* pend = p + tag.size();
+    if (!unpack_uint(&p, pend, &slot) || pend - p != 1)
+	throw Xapian::DatabaseCorruptError("Value order entry corrupt");
+    reverse = (*p != 0);
+    return true;
+}
+
+void
+HoneyPostListTable::read_term_filter() const
+{
+    string tag;
+    if (get_exact_entry(Honey::make_term_filter_key(), tag))
+	term_filter.init(std::move(tag));
+    term_filter_read = true;
+}
@@ -27,15 +27,35 @@
 #include "honey_inverter.h"
 #include "honey_postlist.h"
 #include "honey_table.h"
+#include "honey_termfilter.h"
 #include "pack.h"
 
 #include <string>
 #include <string_view>
 
 class HoneyDatabase;
+class ImpactList;
 class PostingChanges;
 
 class HoneyPostListTable : public HoneyTable {
+    /// Filter over the terms, if the database has one.
+    mutable HoneyTermFilter term_filter;
+
+    /// Has the term filter been read yet?
+    mutable bool term_filter_read = false;
+
+    /** Return false if @a term is definitely not in the table.
+     *
+     *  This lets us avoid searching the table for most terms which aren't
+     *  present if the database has a term filter.
+     */
+    bool may_contain(std::string_view term) const {
+	if (!term_filter_read) read_term_filter();
+	return term_filter.may_contain(term);
+    }
+
+    void read_term_filter() const;
+
   public:
     /** Create a new HoneyPostListTable object.
      *
@@ -52,6 +72,7 @@ class HoneyPostListTable : public HoneyTable {
 	: HoneyTable("postlist", fd, offset_, readonly) { }
 
     bool term_exists(std::string_view term) const {
+	if (!may_contain(term)) return false;
 	return key_exists(pack_honey_postlist_key(term));
     }
 
@@ -69,6 +90,18 @@ class HoneyPostListTable : public HoneyTable {
 
     Xapian::termcount get_wdf_upper_bound(std::string_view term) const;
 
+    /** Open impact-ordered postings for @a term.
+     *
+     *  @return NULL if the table doesn't contain impact-ordered postings.
+     */
+    ImpactList* open_impact_list(std::string_view term) const;
+
+    /** Read which value slot the documents are ordered by.
+     *
+     *  @return false if the documents aren't stored in value order.
+     */
+    bool get_value_order(Xapian::valueno& slot, bool& reverse) const;
+
     std::string get_metadata(std::string_view key) const {
 	using namespace std::string_literals;
 	std::string value;
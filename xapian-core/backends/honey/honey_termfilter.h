@@ -0,0 +1,138 @@
+/** @file
+ * @brief Bloom filter over the terms in a honey database.
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#ifndef XAPIAN_INCLUDED_HONEY_TERMFILTER_H
+#define XAPIAN_INCLUDED_HONEY_TERMFILTER_H
+
+#include "xapian/error.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* The encoding is a byte giving the number of probes, followed by one or more
+ * 64 byte blocks of filter bits.
+ *
+ * A term's hash picks one block, and then each probe sets or tests one bit in
+ * that block, so a lookup only needs to touch a single cache line.
+ */
+class HoneyTermFilter {
+    /// Size of each block in bytes.
+    static constexpr size_t BLOCK_SIZE = 64;
+
+    /// Number of bits per term to use when building a filter.
+    static constexpr size_t BITS_PER_TERM = 10;
+
+    /// Number of probes to use when building a filter.
+    static constexpr unsigned PROBES = 6;
+
+    /// The encoded filter, or empty if there isn't one.
+    std::string data;
+
+    /// Number of blocks in the filter.
+    size_t n_blocks = 0;
+
+    static uint64_t mix(uint64_t h) {
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+    }
+
+    /** Call @a f with the byte offset and bit mask of each probe for @a h.
+     *
+     *  Stops and returns false if @a f returns false.
+     */
+    template<typename F>
+    static bool probe(uint64_t h, size_t blocks, unsigned probes, F f) {
+	size_t base = 1 + (h % blocks) * BLOCK_SIZE;
+	uint64_t g = mix(h ^ 0x9e3779b97f4a7c15ULL);
+	uint32_t a = uint32_t(g);
+	uint32_t b = uint32_t(g >> 32) | 1;
+	for (unsigned i = 0; i != probes; ++i) {
+	    unsigned bit = (a + i * b) & (BLOCK_SIZE * 8 - 1);
+	    if (!f(base + bit / 8, static_cast<unsigned char>(1 << (bit & 7))))
+		return false;
+	}
+	return true;
+    }
+
+  public:
+    /// Hash a term for use with build().
+    static uint64_t hash(std::string_view term) {
+	// FNV-1a, with a final mix to spread the bits.
+	uint64_t h = 0xcbf29ce484222325ULL;
+	for (unsigned char ch : term) {
+	    h ^= ch;
+	    h *= 0x100000001b3ULL;
+	}
+	return mix(h);
+    }
+
+    /** Build an encoded filter containing the terms @a hashes are for.
+     *
+     *  @a hashes may contain duplicates, though this makes the filter larger
+     *  than it needs to be.
+     */
+    static std::string build(const std::vector<uint64_t>& hashes) {
+	size_t blocks = hashes.size() * BITS_PER_TERM / (BLOCK_SIZE * 8) + 1;
+	std::string result(1 + blocks * BLOCK_SIZE, '\0');
+	result[0] = char(PROBES);
+	for (uint64_t h : hashes) {
+	    probe(h, blocks, PROBES, [&](size_t i, unsigned char mask) {
+		      result[i] |= mask;
+		      return true;
+		  });
+	}
+	return result;
+    }
+
+    /** Use the encoded filter @a tag.
+     *
+     *  If this method isn't called, may_contain() always returns true.
+     */
+    void init(std::string&& tag) {
+	if (tag.size() < 1 + BLOCK_SIZE ||
+	    (tag.size() - 1) % BLOCK_SIZE != 0 ||
+	    tag[0] == 0) {
+	    throw Xapian::DatabaseCorruptError("Term filter corrupt");
+	}
+	data = std::move(tag);
+	n_blocks = (data.size() - 1) / BLOCK_SIZE;
+    }
+
+    /** Might @a term be in the database?
+     *
+     *  Returns false only if @a term is definitely not present.
+     */
+    bool may_contain(std::string_view term) const {
+	if (n_blocks == 0) return true;
+	return probe(hash(term), n_blocks, static_cast<unsigned char>(data[0]),
+		     [this](size_t i, unsigned char mask) {
+			 return (data[i] & mask) != 0;
+		     });
+    }
+};
+
+#endif // XAPIAN_INCLUDED_HONEY_TERMFILTER_H
@@ -0,0 +1,139 @@
+/** @file
+ * @brief Impact-ordered postings for a term.
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#ifndef XAPIAN_INCLUDED_IMPACTLIST_H
+#define XAPIAN_INCLUDED_IMPACTLIST_H
+
+#include "xapian/error.h"
+#include "xapian/types.h"
+
+#include "pack.h"
+
+#include <string>
+
+/* The encoding is a sequence of segments, in decreasing order of impact:
+ *
+ *   pack_uint(impact)
+ *   pack_uint(number of documents in segment - 1)
+ *   pack_uint(docid gap - 1) for each document, in ascending docid order
+ *   (the first gap is from docid 0).
+ *
+ * Each impact is a quantised weight contribution (the weight is the impact
+ * multiplied by a per-database scale factor) and is at least 1.
+ */
+
+/// Append a segment to encoded impact-ordered postings.
+template<typename I>
+inline void
+encode_impact_segment(std::string& s, unsigned impact, I begin, I end)
+{
+    pack_uint(s, impact);
+    pack_uint(s, Xapian::doccount(end - begin - 1));
+    Xapian::docid prev = 0;
+    for (I i = begin; i != end; ++i) {
+	pack_uint(s, *i - prev - 1);
+	prev = *i;
+    }
+}
+
+/// Decoder for impact-ordered postings for a term.
+class ImpactList {
+    /// The encoded postings.
+    std::string data;
+
+    /// Current position in @a data.
+    const char* p;
+
+    /// End of @a data.
+    const char* end;
+
+    /// Weight of one unit of impact.
+    double scale;
+
+    /// Impact of the current segment (0 before the first segment).
+    unsigned impact = 0;
+
+    /// Documents left to read in the current segment.
+    Xapian::doccount left = 0;
+
+    /// The last docid read from the current segment.
+    Xapian::docid did = 0;
+
+    [[noreturn]]
+    static void throw_corrupt() {
+	throw Xapian::DatabaseCorruptError("Impact list data corrupt");
+    }
+
+  public:
+    /** Construct.
+     *
+     *  @param data_	Encoded postings (empty if the term doesn't exist).
+     *  @param scale_	Weight of one unit of impact.
+     */
+    ImpactList(std::string&& data_, double scale_)
+	: data(std::move(data_)), p(data.data()), end(p + data.size()),
+	  scale(scale_) { }
+
+    /// Return the weight of one unit of impact.
+    double get_scale() const { return scale; }
+
+    /** Move to the next segment.
+     *
+     *  Any unread documents in the current segment are skipped.
+     *
+     *  @return false if there are no more segments.
+     */
+    bool next_segment() {
+	Xapian::docid dummy;
+	while (next_docid(dummy)) { }
+	if (p == end) return false;
+	unsigned new_impact;
+	if (!unpack_uint(&p, end, &new_impact) ||
+	    !unpack_uint(&p, end, &left) ||
+	    new_impact == 0 ||
+	    (impact && new_impact >= impact)) {
+	    throw_corrupt();
+	}
+	impact = new_impact;
+	++left;
+	did = 0;
+	return true;
+    }
+
+    /// Return the impact of the current segment.
+    unsigned get_impact() const { return impact; }
+
+    /** Read the next document in the current segment.
+     *
+     *  @return false if there are no more documents in the segment.
+     */
+    bool next_docid(Xapian::docid& result) {
+	if (left == 0) return false;
+	Xapian::docid gap;
+	if (!unpack_uint(&p, end, &gap)) throw_corrupt();
+	did += gap + 1;
+	--left;
+	result = did;
+	return true;
+    }
+};
+
+#endif // XAPIAN_INCLUDED_IMPACTLIST_H
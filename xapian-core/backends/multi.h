@@ -25,6 +25,10 @@
 #include <xapian/types.h>
 #include "omassert.h"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 /** Convert docid in the multi-db to the docid in the shard.
  *
  *  @param did		docid in the multi-db
@@ -70,4 +74,96 @@ unshard(Xapian::docid shard_did,
     return (shard_did - 1) * n_shards + shard + 1;
 }
 
+/** Mapping between docids in a multi-db and docids in its shards.
+ *
+ *  By default the docids of the shards are interleaved, as implemented by the
+ *  functions above.  Alternatively the docid ranges of the shards can be
+ *  concatenated, so each shard's docids are offset by the sum of the last
+ *  docids of the shards before it.  This suits shards which were built from
+ *  contiguous blocks of documents, and means a multi-db postlist can just
+ *  iterate each shard in turn.
+ */
+class ShardDocIdMap {
+    /// Number of shards.
+    Xapian::doccount n_shards;
+
+    /** Offset added to the docids of each shard.
+     *
+     *  Empty if the docids are interleaved.
+     */
+    std::vector<Xapian::docid> offsets;
+
+  public:
+    /// Interleave the docids of @a n_shards_ shards.
+    explicit ShardDocIdMap(Xapian::doccount n_shards_ = 1)
+	: n_shards(n_shards_) {}
+
+    /// Concatenate the docid ranges of shards with the specified offsets.
+    explicit ShardDocIdMap(std::vector<Xapian::docid>&& offsets_)
+	: n_shards(offsets_.size()), offsets(std::move(offsets_)) {
+	AssertRel(n_shards,>,0);
+	AssertEq(offsets[0], 0);
+    }
+
+    /// Return the number of shards.
+    Xapian::doccount size() const { return n_shards; }
+
+    /// Are the docid ranges of the shards concatenated?
+    bool is_contiguous() const { return !offsets.empty(); }
+
+    /// Convert docid in the multi-db to shard number.
+    Xapian::doccount shard_number(Xapian::docid did) const {
+	if (offsets.empty())
+	    return ::shard_number(did, n_shards);
+	Assert(did != 0);
+	// The shard is the last one with an offset less than did.  Using
+	// lower_bound() means we skip over any empty shards.
+	auto i = std::lower_bound(offsets.begin(), offsets.end(), did);
+	return Xapian::doccount(i - offsets.begin()) - 1;
+    }
+
+    /// Convert docid in the multi-db to the docid in the shard.
+    Xapian::docid shard_docid(Xapian::docid did) const {
+	if (offsets.empty())
+	    return ::shard_docid(did, n_shards);
+	return did - offsets[shard_number(did)];
+    }
+
+    /// Convert shard number and shard docid to docid in multi-db.
+    Xapian::docid unshard(Xapian::docid shard_did,
+			  Xapian::doccount shard) const {
+	if (offsets.empty())
+	    return ::unshard(shard_did, shard, n_shards);
+	Assert(shard_did != 0);
+	AssertRel(shard,<,n_shards);
+	return offsets[shard] + shard_did;
+    }
+
+    /** Return the offset added to the docids of shard @a shard.
+     *
+     *  Only meaningful if is_contiguous() is true.
+     */
+    Xapian::docid offset(Xapian::doccount shard) const {
+	Assert(!offsets.empty());
+	AssertRel(shard,<,n_shards);
+	return offsets[shard];
+    }
+
+    /** Count the docids in a shard which map to a docid <= @a did.
+     *
+     *  This is also the highest docid in shard @a shard which maps to a docid
+     *  <= @a did, or 0 if there isn't one.
+     *
+     *  With concatenated docid ranges, the result may exceed the last docid
+     *  in the shard if @a did is after the shard's range.
+     */
+    Xapian::docid shard_docid_upto(Xapian::docid did,
+				   Xapian::doccount shard) const {
+	AssertRel(shard,<,n_shards);
+	if (offsets.empty())
+	    return did > shard ? (did - shard - 1) / n_shards + 1 : 0;
+	return did > offsets[shard] ? did - offsets[shard] : 0;
+    }
+};
+
 #endif // XAPIAN_INCLUDED_MULTI_H
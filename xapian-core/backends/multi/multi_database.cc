@@ -32,6 +32,7 @@
 
 #include <memory>
 #include <string_view>
+#include <vector>
 
 using namespace std;
 
@@ -41,6 +42,34 @@ MultiDatabase::size() const
     return shards.size();
 }
 
+void
+MultiDatabase::push_back(Xapian::Database::Internal* shard)
+{
+    shards.push_back(shard);
+    set_contiguous(docid_map.is_contiguous());
+}
+
+void
+MultiDatabase::set_contiguous(bool contiguous)
+{
+    if (!contiguous) {
+	docid_map = ShardDocIdMap(shards.size());
+	return;
+    }
+
+    vector<Xapian::docid> offsets;
+    offsets.reserve(shards.size());
+    Xapian::docid offset = 0;
+    for (auto&& shard : shards) {
+	offsets.push_back(offset);
+	auto old_offset = offset;
+	offset += shard->get_lastdocid();
+	if (offset < old_offset)
+	    throw Xapian::DatabaseError("docid overflowed!");
+    }
+    docid_map = ShardDocIdMap(std::move(offsets));
+}
+
 bool
 MultiDatabase::reopen()
 {
@@ -50,6 +79,10 @@ MultiDatabase::reopen()
 	    result = true;
 	}
     }
+    if (result && docid_map.is_contiguous()) {
+	// The offsets depend on the last docid in each shard.
+	set_contiguous(true);
+    }
     return result;
 }
 
@@ -71,6 +104,8 @@ MultiDatabase::open_post_list(string_view term) const
 	    postlists[count] = shard->open_post_list(term);
 	    ++count;
 	}
+	if (docid_map.is_contiguous())
+	    return new ConcatPostList(count, postlists, docid_map);
 	return new MultiPostList(count, postlists);
     } catch (...) {
 	while (count)
@@ -97,10 +132,9 @@ MultiDatabase::open_term_list(Xapian::docid did) const
 TermList*
 MultiDatabase::open_term_list_direct(Xapian::docid did) const
 {
-    Xapian::doccount n_shards = shards.size();
-    auto shard_index = shard_number(did, n_shards);
+    auto shard_index = docid_map.shard_number(did);
     auto shard = shards[shard_index];
-    Xapian::docid shard_did = shard_docid(did, n_shards);
+    Xapian::docid shard_did = docid_map.shard_docid(did);
     TermList* res = shard->open_term_list(shard_did);
     res->shard_index = shard_index;
     return res;
@@ -139,9 +173,8 @@ MultiDatabase::has_positions() const
 PositionList*
 MultiDatabase::open_position_list(Xapian::docid did, string_view term) const
 {
-    auto n_shards = shards.size();
-    auto shard = shards[shard_number(did, n_shards)];
-    auto shard_did = shard_docid(did, n_shards);
+    auto shard = shards[docid_map.shard_number(did)];
+    auto shard_did = docid_map.shard_docid(did);
     return shard->open_position_list(shard_did, term);
 }
 
@@ -170,7 +203,7 @@ MultiDatabase::get_lastdocid() const
 	    // combined database.
 	    continue;
 	}
-	result = max(result, unshard(shard_lastdocid, shard, n_shards));
+	result = max(result, docid_map.unshard(shard_lastdocid, shard));
     }
     return result;
 }
@@ -347,7 +380,7 @@ MultiDatabase::open_value_list(Xapian::valueno slot) const
 	    valuelists[count] = new SubValueList(vl, count);
 	    ++count;
 	}
-	return new MultiValueList(count, valuelists, slot);
+	return new MultiValueList(count, valuelists, slot, docid_map);
     } catch (...) {
 	while (count)
 	    delete valuelists[--count];
@@ -361,9 +394,8 @@ MultiDatabase::get_doclength(Xapian::docid did) const
 {
     Assert(did != 0);
 
-    auto n_shards = shards.size();
-    auto shard = shards[shard_number(did, n_shards)];
-    auto shard_did = shard_docid(did, n_shards);
+    auto shard = shards[docid_map.shard_number(did)];
+    auto shard_did = docid_map.shard_docid(did);
     return shard->get_doclength(shard_did);
 }
 
@@ -372,9 +404,8 @@ MultiDatabase::get_unique_terms(Xapian::docid did) const
 {
     Assert(did != 0);
 
-    auto n_shards = shards.size();
-    auto shard = shards[shard_number(did, n_shards)];
-    auto shard_did = shard_docid(did, n_shards);
+    auto shard = shards[docid_map.shard_number(did)];
+    auto shard_did = docid_map.shard_docid(did);
     return shard->get_unique_terms(shard_did);
 }
 
@@ -383,9 +414,8 @@ MultiDatabase::get_wdfdocmax(Xapian::docid did) const
 {
     Assert(did != 0);
 
-    auto n_shards = shards.size();
-    auto shard = shards[shard_number(did, n_shards)];
-    auto shard_did = shard_docid(did, n_shards);
+    auto shard = shards[docid_map.shard_number(did)];
+    auto shard_did = docid_map.shard_docid(did);
     return shard->get_wdfdocmax(shard_did);
 }
 
@@ -394,9 +424,8 @@ MultiDatabase::open_document(Xapian::docid did, bool lazy) const
 {
     Assert(did != 0);
 
-    auto n_shards = shards.size();
-    auto shard = shards[shard_number(did, n_shards)];
-    auto shard_did = shard_docid(did, n_shards);
+    auto shard = shards[docid_map.shard_number(did)];
+    auto shard_did = docid_map.shard_docid(did);
     return shard->open_document(shard_did, lazy);
 }
 
@@ -576,6 +605,22 @@ MultiDatabase::get_revision() const
 					"more than one subdatabase");
 }
 
+void
+MultiDatabase::set_filter_cache_size(size_t max_bytes)
+{
+    for (auto&& shard : shards) {
+	shard->set_filter_cache_size(max_bytes);
+    }
+}
+
+void
+MultiDatabase::set_doclength_cache(bool enable)
+{
+    for (auto&& shard : shards) {
+	shard->set_doclength_cache(enable);
+    }
+}
+
 void
 MultiDatabase::invalidate_doc_object(Xapian::Document::Internal*) const
 {
@@ -635,18 +680,16 @@ MultiDatabase::add_document(const Xapian::Document& doc)
 				    "before you can add more documents");
     }
 
-    auto n_shards = shards.size();
-    auto shard = shards[shard_number(did, n_shards)];
-    shard->replace_document(shard_docid(did, n_shards), doc);
+    auto shard = shards[docid_map.shard_number(did)];
+    shard->replace_document(docid_map.shard_docid(did), doc);
     return did;
 }
 
 void
 MultiDatabase::delete_document(Xapian::docid did)
 {
-    auto n_shards = shards.size();
-    auto shard = shards[shard_number(did, n_shards)];
-    shard->delete_document(shard_docid(did, n_shards));
+    auto shard = shards[docid_map.shard_number(did)];
+    shard->delete_document(docid_map.shard_docid(did));
 }
 
 void
@@ -660,15 +703,13 @@ MultiDatabase::delete_document(string_view term)
 void
 MultiDatabase::replace_document(Xapian::docid did, const Xapian::Document& doc)
 {
-    auto n_shards = shards.size();
-    auto shard = shards[shard_number(did, n_shards)];
-    shard->replace_document(shard_docid(did, n_shards), doc);
+    auto shard = shards[docid_map.shard_number(did)];
+    shard->replace_document(docid_map.shard_docid(did), doc);
 }
 
 Xapian::docid
 MultiDatabase::replace_document(string_view term, const Xapian::Document& doc)
 {
-    auto n_shards = shards.size();
     unique_ptr<PostList> pl(open_post_list(term));
     if (!pl || (pl->next(), pl->at_end())) {
 	// unique_term not in the database, so this is just an add_document().
@@ -680,19 +721,19 @@ MultiDatabase::replace_document(string_view term, const Xapian::Document& doc)
 					"gaps before you can add more "
 					"documents");
 	}
-	auto shard = shards[shard_number(did, n_shards)];
+	auto shard = shards[docid_map.shard_number(did)];
 	return shard->add_document(doc);
     }
 
     Xapian::docid result = pl->get_docid();
-    auto replacing_shard = shards[shard_number(result, n_shards)];
-    replacing_shard->replace_document(shard_docid(result, n_shards), doc);
+    auto replacing_shard = shards[docid_map.shard_number(result)];
+    replacing_shard->replace_document(docid_map.shard_docid(result), doc);
 
     // Delete any other occurrences of the unique term.
     while (pl->next(), !pl->at_end()) {
 	Xapian::docid did = pl->get_docid();
-	auto shard = shards[shard_number(did, n_shards)];
-	shard->delete_document(shard_docid(did, n_shards));
+	auto shard = shards[docid_map.shard_number(did)];
+	shard->delete_document(docid_map.shard_docid(did));
     }
 
     return result;
@@ -703,9 +744,8 @@ MultiDatabase::request_document(Xapian::docid did) const
 {
     Assert(did != 0);
 
-    auto n_shards = shards.size();
-    auto shard = shards[shard_number(did, n_shards)];
-    auto shard_did = shard_docid(did, n_shards);
+    auto shard = shards[docid_map.shard_number(did)];
+    auto shard_did = docid_map.shard_docid(did);
     shard->request_document(shard_did);
 }
 
@@ -767,9 +807,8 @@ MultiDatabase::reconstruct_text(Xapian::docid did,
 {
     Assert(did != 0);
 
-    auto n_shards = shards.size();
-    auto shard = shards[shard_number(did, n_shards)];
-    auto shard_did = shard_docid(did, n_shards);
+    auto shard = shards[docid_map.shard_number(did)];
+    auto shard_did = docid_map.shard_docid(did);
     return shard->reconstruct_text(shard_did, length, prefix,
 				   start_pos, end_pos);
 }
@@ -23,6 +23,7 @@
 
 #include "api/termlist.h"
 #include "backends/databaseinternal.h"
+#include "backends/multi.h"
 #include "backends/valuelist.h"
 
 #include <string_view>
@@ -49,6 +50,9 @@ class MultiDatabase : public Xapian::Database::Internal {
 
     Xapian::SmallVectorI<Xapian::Database::Internal> shards;
 
+    /// Mapping between our docids and those of the shards.
+    ShardDocIdMap docid_map;
+
   public:
     explicit MultiDatabase(size_type reserve_size, bool read_only)
 	: Xapian::Database::Internal(read_only ?
@@ -60,9 +64,16 @@ class MultiDatabase : public Xapian::Database::Internal {
 
     void reserve(size_type new_size) { shards.reserve(new_size); }
 
-    void push_back(Xapian::Database::Internal* shard) {
-	shards.push_back(shard);
-    }
+    void push_back(Xapian::Database::Internal* shard);
+
+    /** Select how our docids map to those of the shards.
+     *
+     *  @param contiguous	If true, concatenate the docid ranges of the
+     *				shards.  If false, interleave them.
+     */
+    void set_contiguous(bool contiguous);
+
+    const ShardDocIdMap& get_docid_map() const { return docid_map; }
 
     bool reopen();
 
@@ -151,6 +162,10 @@ class MultiDatabase : public Xapian::Database::Internal {
 
     Xapian::rev get_revision() const;
 
+    void set_filter_cache_size(size_t max_bytes);
+
+    void set_doclength_cache(bool enable);
+
     int get_backend_info(std::string* path) const;
 
     void commit();
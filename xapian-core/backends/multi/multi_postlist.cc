@@ -194,3 +194,124 @@ MultiPostList::get_description() const
     desc.back() = ')';
     return desc;
 }
+
+ConcatPostList::~ConcatPostList()
+{
+    while (n_shards)
+	delete postlists[--n_shards];
+    delete [] postlists;
+}
+
+Xapian::docid
+ConcatPostList::get_docid() const
+{
+    return docid_map.unshard(postlists[shard]->get_docid(), shard);
+}
+
+Xapian::termcount
+ConcatPostList::get_wdf() const
+{
+    return postlists[shard]->get_wdf();
+}
+
+double
+ConcatPostList::get_weight(Xapian::termcount,
+			   Xapian::termcount,
+			   Xapian::termcount) const
+{
+    // ConcatPostList is only used by PostingIterator which should never call
+    // this method.
+    Assert(false);
+    return 0;
+}
+
+bool
+ConcatPostList::at_end() const
+{
+    return shard == n_shards;
+}
+
+double
+ConcatPostList::recalc_maxweight()
+{
+    // ConcatPostList is only used by PostingIterator which should never call
+    // this method.
+    Assert(false);
+    return 0;
+}
+
+PositionList*
+ConcatPostList::open_position_list() const
+{
+    return postlists[shard]->open_position_list();
+}
+
+void
+ConcatPostList::next_shard(double w_min)
+{
+    delete postlists[shard];
+    postlists[shard] = NULL;
+    while (++shard != n_shards) {
+	PostList* pl = postlists[shard];
+	if (!pl) continue;
+	pl->next(w_min);
+	if (!pl->at_end())
+	    return;
+	delete pl;
+	postlists[shard] = NULL;
+    }
+}
+
+PostList*
+ConcatPostList::next(double w_min)
+{
+    PostList* pl = postlists[shard];
+    if (pl) {
+	// Before the first call this is the PostList for shard 0, which will
+	// then advance to its first entry.
+	pl->next(w_min);
+	if (!pl->at_end())
+	    return NULL;
+    }
+    next_shard(w_min);
+    return NULL;
+}
+
+PostList*
+ConcatPostList::skip_to(Xapian::docid did, double w_min)
+{
+    Xapian::doccount target = docid_map.shard_number(did);
+    if (target < shard) {
+	// We're already past did.
+	return NULL;
+    }
+    while (shard != target) {
+	delete postlists[shard];
+	postlists[shard] = NULL;
+	++shard;
+    }
+    PostList* pl = postlists[shard];
+    if (pl) {
+	pl->skip_to(docid_map.shard_docid(did), w_min);
+	if (!pl->at_end())
+	    return NULL;
+    }
+    next_shard(w_min);
+    return NULL;
+}
+
+std::string
+ConcatPostList::get_description() const
+{
+    string desc = "ConcatPostList(";
+    for (Xapian::doccount i = 0; i != n_shards; ++i) {
+	if (postlists[i]) {
+	    desc += postlists[i]->get_description();
+	    desc += ',';
+	} else {
+	    desc += "NULL,";
+	}
+    }
+    desc.back() = ')';
+    return desc;
+}
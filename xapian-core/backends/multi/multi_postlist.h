@@ -24,6 +24,7 @@
 
 #include <string>
 
+#include "backends/multi.h"
 #include "backends/postlist.h"
 #include "backends/positionlist.h"
 
@@ -135,4 +136,69 @@ class MultiPostList : public PostList {
     std::string get_description() const;
 };
 
+/** Class for combining PostList objects from shards with contiguous docids.
+ *
+ *  Each shard's docids map to a separate range of docids, in shard order, so
+ *  we can just iterate through each shard's PostList in turn.
+ */
+class ConcatPostList : public PostList {
+    /// Don't allow assignment.
+    void operator=(const ConcatPostList &) = delete;
+
+    /// Don't allow copying.
+    ConcatPostList(const ConcatPostList &) = delete;
+
+    /// Number of PostList* entries in @a postlists.
+    Xapian::doccount n_shards;
+
+    /// Sub-postlists, which are deleted once we've moved past them.
+    PostList** postlists;
+
+    /// Mapping between the docids of the shards and our docids.
+    ShardDocIdMap docid_map;
+
+    /// The shard we're currently in.
+    Xapian::doccount shard = 0;
+
+    /** Advance to the first entry in the next non-empty shard.
+     *
+     *  The current shard's PostList is deleted.
+     */
+    void next_shard(double w_min);
+
+  public:
+    /// Constructor.
+    ConcatPostList(Xapian::doccount n_shards_,
+		   PostList** postlists_,
+		   const ShardDocIdMap& docid_map_)
+	: n_shards(n_shards_), postlists(postlists_), docid_map(docid_map_)
+    {
+	// Like MultiPostList, we're only used by PostingIterator which should
+	// never read the termfreq so leave it uninitialised.
+    }
+
+    /// Destructor.
+    ~ConcatPostList();
+
+    Xapian::docid get_docid() const;
+
+    Xapian::termcount get_wdf() const;
+
+    double get_weight(Xapian::termcount doclen,
+		      Xapian::termcount unique_terms,
+		      Xapian::termcount wdfdocmax) const;
+
+    bool at_end() const;
+
+    double recalc_maxweight();
+
+    PositionList * open_position_list() const;
+
+    PostList* next(double w_min);
+
+    PostList* skip_to(Xapian::docid, double w_min);
+
+    std::string get_description() const;
+};
+
 #endif // XAPIAN_INCLUDED_MULTI_POSTLIST_H
@@ -33,9 +33,20 @@ using namespace std;
 using Xapian::Internal::intrusive_ptr;
 
 /// Comparison functor which orders SubValueList* by ascending docid.
-struct CompareSubValueListsByDocId {
+class CompareSubValueListsByDocId {
+    /// Are the docid ranges of the shards concatenated?
+    bool contiguous;
+
+  public:
+    explicit CompareSubValueListsByDocId(const ShardDocIdMap& docid_map)
+	: contiguous(docid_map.is_contiguous()) {}
+
     /// Order by ascending docid.
     bool operator()(const SubValueList *a, const SubValueList *b) const {
+	if (contiguous && a->shard != b->shard) {
+	    // All the docids in an earlier shard come first.
+	    return a->shard > b->shard;
+	}
 	Xapian::docid did_a = a->get_docid();
 	Xapian::docid did_b = b->get_docid();
 	if (did_a > did_b) return true;
@@ -100,24 +111,24 @@ MultiValueList::next()
 	    return;
 
 	Heap::make(valuelists, valuelists + count,
-		   CompareSubValueListsByDocId());
+		   CompareSubValueListsByDocId(docid_map));
     } else {
 	// Advance to the next docid.
 	SubValueList * vl = valuelists[0];
 	vl->next();
 	if (vl->at_end()) {
 	    Heap::pop(valuelists, valuelists + count,
-		      CompareSubValueListsByDocId());
+		      CompareSubValueListsByDocId(docid_map));
 	    delete vl;
 	    if (--count == 0)
 		return;
 	} else {
 	    Heap::replace(valuelists, valuelists + count,
-			  CompareSubValueListsByDocId());
+			  CompareSubValueListsByDocId(docid_map));
 	}
     }
 
-    current_docid = valuelists[0]->get_merged_docid(n_shards);
+    current_docid = valuelists[0]->get_merged_docid(docid_map);
 }
 
 void
@@ -128,7 +139,7 @@ MultiValueList::skip_to(Xapian::docid did)
     // approach more like that next() uses if this ever gets heavy use.
     Xapian::doccount j = 0;
     for (Xapian::doccount i = 0; i != count; ++i) {
-	valuelists[i]->skip_to(did, n_shards);
+	valuelists[i]->skip_to(did, docid_map);
 	if (valuelists[i]->at_end()) {
 	    delete valuelists[i];
 	    valuelists[i] = 0;
@@ -142,9 +153,10 @@ MultiValueList::skip_to(Xapian::docid did)
     if (rare(count == 0))
 	return;
 
-    Heap::make(valuelists, valuelists + count, CompareSubValueListsByDocId());
+    Heap::make(valuelists, valuelists + count,
+	       CompareSubValueListsByDocId(docid_map));
 
-    current_docid = valuelists[0]->get_merged_docid(n_shards);
+    current_docid = valuelists[0]->get_merged_docid(docid_map);
 }
 
 bool
@@ -39,21 +39,18 @@ struct SubValueList {
 	delete valuelist;
     }
 
-    void skip_to(Xapian::docid did, Xapian::doccount n_shards) {
+    void skip_to(Xapian::docid did, const ShardDocIdMap& docid_map) {
 	// Calculate the docid in this shard which is the same or later than
 	// did (which may be in a different shard).
-	Xapian::docid shard_did = shard_docid(did, n_shards);
-	if (shard_number(did, n_shards) > shard)
-	    ++shard_did;
-	valuelist->skip_to(shard_did);
+	valuelist->skip_to(docid_map.shard_docid_upto(did - 1, shard) + 1);
     }
 
     Xapian::docid get_docid() const {
 	return valuelist->get_docid();
     }
 
-    Xapian::docid get_merged_docid(unsigned n_shards) const {
-	return unshard(valuelist->get_docid(), shard, n_shards);
+    Xapian::docid get_merged_docid(const ShardDocIdMap& docid_map) const {
+	return docid_map.unshard(valuelist->get_docid(), shard);
     }
 
     std::string get_value() const { return valuelist->get_value(); }
@@ -85,17 +82,19 @@ class MultiValueList : public ValueList {
     /// The value slot we're iterating over.
     Xapian::valueno slot;
 
-    Xapian::doccount n_shards;
+    /// Mapping between the docids of the shards and our docids.
+    ShardDocIdMap docid_map;
 
   public:
     /// Constructor.
     MultiValueList(Xapian::doccount n_shards_,
 		   SubValueList** valuelists_,
-		   Xapian::valueno slot_)
+		   Xapian::valueno slot_,
+		   const ShardDocIdMap& docid_map_)
 	: count(n_shards_),
 	  valuelists(valuelists_),
 	  slot(slot_),
-	  n_shards(n_shards_)
+	  docid_map(docid_map_)
     {
     }
 
@@ -683,6 +683,7 @@ RemoteDatabase::set_query(const Xapian::Query& query,
 			  Xapian::Enquire::Internal::sort_setting sort_by,
 			  bool sort_value_forward,
 			  double time_limit,
+			  bool time_limit_stop,
 			  int percent_threshold, double weight_threshold,
 			  const Xapian::Weight& wtscheme,
 			  const Xapian::RSet &omrset,
@@ -702,6 +703,7 @@ RemoteDatabase::set_query(const Xapian::Query& query,
     }
     pack_bool(message, sort_value_forward);
     message += serialise_double(time_limit);
+    pack_bool(message, time_limit_stop);
     message += char(percent_threshold);
     message += serialise_double(weight_threshold);
 
@@ -738,6 +740,7 @@ void
 RemoteDatabase::send_global_stats(Xapian::doccount first,
 				  Xapian::doccount maxitems,
 				  Xapian::doccount check_at_least,
+				  const Result* after,
 				  const Xapian::KeyMaker* sorter,
 				  const Xapian::Weight::Internal &stats) const
 {
@@ -745,6 +748,12 @@ RemoteDatabase::send_global_stats(Xapian::doccount first,
     pack_uint(message, first);
     pack_uint(message, maxitems);
     pack_uint(message, check_at_least);
+    pack_bool(message, after != NULL);
+    if (after) {
+	message += serialise_double(after->get_weight());
+	pack_string(message, after->get_sort_key());
+	pack_uint(message, after->get_docid());
+    }
     if (!sorter) {
 	pack_string_empty(message);
     } else {
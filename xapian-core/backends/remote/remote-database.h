@@ -37,6 +37,7 @@ namespace Xapian {
 }
 
 class NetworkPostList;
+class Result;
 
 /** RemoteDatabase is the baseclass for remote database implementations.
  *
@@ -184,6 +185,8 @@ class RemoteDatabase : public Xapian::Database::Internal {
      * @param sort_value_forward	Sort order for values.
      * @param time_limit_		Seconds to reduce check_at_least after
      *					(or <= 0 for no limit).
+     * @param time_limit_stop		Stop the match entirely once
+     *					time_limit is reached?
      * @param percent_threshold		Lower bound on percentage score.
      * @param weight_threshold		Lower bound on weight.
      * @param wtscheme			Weighting scheme.
@@ -199,6 +202,7 @@ class RemoteDatabase : public Xapian::Database::Internal {
 		   Xapian::Enquire::Internal::sort_setting sort_by,
 		   bool sort_value_forward,
 		   double time_limit,
+		   bool time_limit_stop,
 		   int percent_threshold, double weight_threshold,
 		   const Xapian::Weight& wtscheme,
 		   const Xapian::RSet &omrset,
@@ -220,6 +224,7 @@ class RemoteDatabase : public Xapian::Database::Internal {
     void send_global_stats(Xapian::doccount first,
 			   Xapian::doccount maxitems,
 			   Xapian::doccount check_at_least,
+			   const Result* after,
 			   const Xapian::KeyMaker* sorter,
 			   const Xapian::Weight::Internal &stats) const;
 
@@ -26,6 +26,7 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <iostream>
 
 #include "gnu_getopt.h"
@@ -40,6 +41,12 @@ using namespace std;
 #define OPT_HELP 1
 #define OPT_VERSION 2
 #define OPT_NO_RENUMBER 3
+#define OPT_REORDER 4
+#define OPT_DOCID_MAP 5
+#define OPT_SORT_BY_VALUE 6
+#define OPT_SORT_REVERSE 7
+#define OPT_TERM_FILTER 8
+#define OPT_BLOCK_POSITIONS 9
 
 static void show_usage() {
     cout << "Usage: " PROG_NAME " [OPTIONS] SOURCE_DATABASE... DESTINATION_DATABASE\n\n"
@@ -61,6 +68,27 @@ static void show_usage() {
 "                     unique ids from an external source).  Currently this\n"
 "                     option is only supported when merging databases if they\n"
 "                     have disjoint ranges of used document ids\n"
+"      --reorder[=SLOT]\n"
+"                     Renumber documents so that documents with similar terms\n"
+"                     have nearby document ids, which makes the database\n"
+"                     smaller and faster to search.  If SLOT is specified,\n"
+"                     documents are first sorted by the value in that slot\n"
+"                     (e.g. a hostname)\n"
+"      --sort-by-value=SLOT\n"
+"                     Store documents in ascending order of the value in SLOT\n"
+"                     so searches sorted by that value can stop early (only\n"
+"                     supported for honey output)\n"
+"      --sort-reverse With --sort-by-value, use descending order\n"
+"      --docid-map=FILE\n"
+"                     If documents are renumbered by --reorder or\n"
+"                     --sort-by-value, write a line to FILE for each document\n"
+"                     giving its old and new document ids\n"
+"      --term-filter  Store a filter over the terms so that looking up terms\n"
+"                     which aren't present is faster (only supported for honey\n"
+"                     output)\n"
+"      --block-positions\n"
+"                     Store long position lists in a form which is larger but\n"
+"                     faster to decode (only supported for honey output)\n"
 "  -s, --single-file  Produce a single file database\n"
 "  --help             display this help and exit\n"
 "  --version          output version information and exit\n";
@@ -69,17 +97,39 @@ static void show_usage() {
 class MyCompactor : public Xapian::Compactor {
     bool quiet;
 
+    Xapian::valueno reorder_slot = Xapian::BAD_VALUENO;
+
+    ofstream docid_map;
+
   public:
     MyCompactor() : quiet(false) { }
 
     void set_quiet(bool quiet_) { quiet = quiet_; }
 
+    void set_reorder_slot(Xapian::valueno slot) { reorder_slot = slot; }
+
+    bool open_docid_map(const char* file) {
+	docid_map.open(file);
+	return bool(docid_map);
+    }
+
     void set_status(const string& table, const string& status) override;
 
     string
     resolve_duplicate_metadata(const string & key,
 			       size_t n,
 			       const string tags[]) override;
+
+    string get_reorder_key(const Xapian::Document& doc) override {
+	if (reorder_slot == Xapian::BAD_VALUENO) return string();
+	return doc.get_value(reorder_slot);
+    }
+
+    void set_new_docid(Xapian::docid old_did,
+		       Xapian::docid new_did) override {
+	if (docid_map.is_open())
+	    docid_map << old_did << ' ' << new_did << '\n';
+    }
 };
 
 void
@@ -121,6 +171,12 @@ main(int argc, char **argv)
 	{"blocksize",	required_argument, 0, 'b'},
 	{"backend",	required_argument, 0, 'B'},
 	{"no-renumber", no_argument, 0, OPT_NO_RENUMBER},
+	{"reorder",	optional_argument, 0, OPT_REORDER},
+	{"docid-map",	required_argument, 0, OPT_DOCID_MAP},
+	{"sort-by-value", required_argument, 0, OPT_SORT_BY_VALUE},
+	{"sort-reverse", no_argument, 0, OPT_SORT_REVERSE},
+	{"term-filter", no_argument, 0, OPT_TERM_FILTER},
+	{"block-positions", no_argument, 0, OPT_BLOCK_POSITIONS},
 	{"single-file", no_argument, 0, 's'},
 	{"quiet",	no_argument, 0, 'q'},
 	{"help",	no_argument, 0, OPT_HELP},
@@ -133,6 +189,8 @@ main(int argc, char **argv)
     unsigned backend = 0;
     unsigned flags = 0;
     unsigned block_size = 0;
+    Xapian::valueno sort_slot = Xapian::BAD_VALUENO;
+    bool sort_reverse = false;
 
     int c;
     while ((c = gnu_getopt_long(argc, argv, opts, long_opts, 0)) != -1) {
@@ -182,6 +240,46 @@ main(int argc, char **argv)
 	    case OPT_NO_RENUMBER:
 		flags |= Xapian::DBCOMPACT_NO_RENUMBER;
 		break;
+	    case OPT_REORDER:
+		flags |= Xapian::DBCOMPACT_REORDER;
+		if (optarg) {
+		    char* p;
+		    unsigned long slot = strtoul(optarg, &p, 10);
+		    if (*p || p == optarg || slot >= Xapian::BAD_VALUENO) {
+			cerr << PROG_NAME": Bad value '" << optarg << "' "
+				"passed for reorder slot\n";
+			exit(1);
+		    }
+		    compactor.set_reorder_slot(Xapian::valueno(slot));
+		}
+		break;
+	    case OPT_SORT_BY_VALUE: {
+		char* p;
+		unsigned long slot = strtoul(optarg, &p, 10);
+		if (*p || p == optarg || slot >= Xapian::BAD_VALUENO) {
+		    cerr << PROG_NAME": Bad value '" << optarg << "' passed "
+			    "for sort slot\n";
+		    exit(1);
+		}
+		sort_slot = Xapian::valueno(slot);
+		break;
+	    }
+	    case OPT_SORT_REVERSE:
+		sort_reverse = true;
+		break;
+	    case OPT_TERM_FILTER:
+		flags |= Xapian::DBCOMPACT_TERM_FILTER;
+		break;
+	    case OPT_BLOCK_POSITIONS:
+		flags |= Xapian::DBCOMPACT_BLOCK_POSITIONS;
+		break;
+	    case OPT_DOCID_MAP:
+		if (!compactor.open_docid_map(optarg)) {
+		    cerr << PROG_NAME": Failed to open '" << optarg
+			 << "' for writing\n";
+		    exit(1);
+		}
+		break;
 	    case 's':
 		flags |= Xapian::DBCOMPACT_SINGLE_FILE;
 		break;
@@ -211,6 +309,10 @@ main(int argc, char **argv)
 
     flags |= backend | level;
 
+    if (sort_slot != Xapian::BAD_VALUENO) {
+	compactor.set_sort_by_value(sort_slot, sort_reverse);
+    }
+
     try {
 	Xapian::Database src;
 	for (int i = optind; i < argc - 1; ++i) {
@@ -26,6 +26,7 @@
 #include "debuglog.h"
 
 #include <cmath>
+#include <utility>
 
 using namespace std;
 using namespace Xapian;
@@ -47,15 +48,24 @@ CosineDistance::similarity(const PointType& a, const PointType& b) const
     if (denom_a == 0 || denom_b == 0)
 	return 0.0;
 
-    for (TermIterator it = a.termlist_begin(); it != a.termlist_end(); ++it) {
+    // Iterate over the point with fewer terms, and look them up in the
+    // other.
+    const PointType* p = &a;
+    const PointType* q = &b;
+    if (p->termlist_size() > q->termlist_size())
+	swap(p, q);
+
+    for (TermIterator it = p->termlist_begin();
+	 it != p->termlist_end();
+	 ++it) {
 	const string& term = *it;
-	double a_weight = a.get_weight(term);
-	if (a_weight == 0)
+	double p_weight = p->get_weight(term);
+	if (p_weight == 0)
 	    continue;
-	double b_weight = b.get_weight(term);
-	if (b_weight == 0)
+	double q_weight = q->get_weight(term);
+	if (q_weight == 0)
 	    continue;
-	inner_product += a_weight * b_weight;
+	inner_product += p_weight * q_weight;
     }
 
     return 1 - (inner_product / (sqrt(denom_a * denom_b)));
@@ -26,7 +26,12 @@
 
 #include "debuglog.h"
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
+#include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 // Threshold value for checking convergence in KMeans
@@ -78,6 +83,158 @@ KMeans::initialise_points(const MSet& source)
 	points.push_back(Point(tlg, it.get_document()));
 }
 
+namespace {
+
+/** Points and centroids using dense integer term ids.
+ *
+ *  Looking up terms by string in each Point and Centroid for every
+ *  point/centroid pair dominates the cost of clustering, so for the
+ *  iterations we map the terms to dense ids, and store each point as a
+ *  sparse vector sorted by term id and the centroids as dense vectors.
+ *  The centroids are interleaved by term (the weight of term t in centroid
+ *  c is at t * k + c) so that the distances from a point to all the
+ *  centroids are computed together by a loop which the compiler can
+ *  vectorise.
+ */
+class KMeansVectors {
+    /// Number of clusters.
+    unsigned k;
+
+    /// Offset in ids and weights of the start of each point (and the end).
+    vector<size_t> point_start;
+
+    /// Term ids of the terms in each point.
+    vector<unsigned> ids;
+
+    /// Weights of the terms in each point.
+    vector<double> weights;
+
+    /// Squared magnitude of each point.
+    vector<double> point_magnitude;
+
+    /// Centroid weights, interleaved by term.
+    vector<double> centroids;
+
+    /// Squared magnitude of each centroid.
+    vector<double> centroid_magnitude;
+
+  public:
+    KMeansVectors(const vector<Point>& points, doccount n, unsigned k_)
+	: k(k_)
+    {
+	unordered_map<string, unsigned> term_ids;
+	point_start.reserve(n + 1);
+	point_magnitude.reserve(n);
+	vector<pair<unsigned, double>> point_terms;
+	for (doccount j = 0; j != n; ++j) {
+	    const Point& point = points[j];
+	    point_terms.clear();
+	    for (TermIterator t = point.termlist_begin();
+		 t != point.termlist_end();
+		 ++t) {
+		auto id = term_ids.emplace(*t, term_ids.size()).first->second;
+		point_terms.emplace_back(id, point.get_weight(*t));
+	    }
+	    sort(point_terms.begin(), point_terms.end());
+	    point_start.push_back(ids.size());
+	    for (auto&& term : point_terms) {
+		ids.push_back(term.first);
+		weights.push_back(term.second);
+	    }
+	    point_magnitude.push_back(point.get_magnitude());
+	}
+	point_start.push_back(ids.size());
+	centroids.resize(term_ids.size() * k);
+	centroid_magnitude.resize(k);
+    }
+
+    /// Set centroid @a c to point @a j.
+    void set_centroid(unsigned c, doccount j) {
+	for (size_t i = point_start[j]; i != point_start[j + 1]; ++i) {
+	    centroids[ids[i] * size_t(k) + c] = weights[i];
+	}
+	centroid_magnitude[c] = point_magnitude[j];
+    }
+
+    /// Return the index of the closest centroid to point @a j.
+    unsigned closest_centroid(doccount j, vector<double>& dots) const {
+	dots.assign(k, 0.0);
+	double* d = dots.data();
+	for (size_t i = point_start[j]; i != point_start[j + 1]; ++i) {
+	    const double* cw = centroids.data() + ids[i] * size_t(k);
+	    double w = weights[i];
+	    for (unsigned c = 0; c != k; ++c) {
+		d[c] += w * cw[c];
+	    }
+	}
+
+	// This replicates CosineDistance::similarity().
+	double closest_cluster_distance = numeric_limits<double>::max();
+	unsigned closest_cluster = 0;
+	for (unsigned c = 0; c != k; ++c) {
+	    double dist = 0.0;
+	    if (point_magnitude[j] != 0 && centroid_magnitude[c] != 0) {
+		dist = 1 - dots[c] / sqrt(point_magnitude[j] *
+					  centroid_magnitude[c]);
+	    }
+	    if (closest_cluster_distance > dist) {
+		closest_cluster_distance = dist;
+		closest_cluster = c;
+	    }
+	}
+	return closest_cluster;
+    }
+
+    /** Recalculate the centroids as the mean of their points.
+     *
+     *  @return	true if no centroid has moved by more than
+     *		CONVERGENCE_THRESHOLD.
+     */
+    bool recalculate(const vector<unsigned>& assignment) {
+	vector<double> old_centroids(centroids.size());
+	swap(old_centroids, centroids);
+	vector<double> old_magnitude(k);
+	swap(old_magnitude, centroid_magnitude);
+
+	vector<doccount> cluster_size(k);
+	for (doccount j = 0; j != assignment.size(); ++j) {
+	    unsigned c = assignment[j];
+	    ++cluster_size[c];
+	    for (size_t i = point_start[j]; i != point_start[j + 1]; ++i) {
+		centroids[ids[i] * size_t(k) + c] += weights[i];
+	    }
+	}
+	vector<double> inv_size(k);
+	for (unsigned c = 0; c != k; ++c) {
+	    if (cluster_size[c]) inv_size[c] = 1.0 / cluster_size[c];
+	}
+
+	vector<double> dots(k);
+	for (size_t t = 0; t != centroids.size(); t += k) {
+	    double* cw = centroids.data() + t;
+	    const double* old_cw = old_centroids.data() + t;
+	    for (unsigned c = 0; c != k; ++c) {
+		double w = cw[c] * inv_size[c];
+		cw[c] = w;
+		centroid_magnitude[c] += w * w;
+		dots[c] += w * old_cw[c];
+	    }
+	}
+
+	for (unsigned c = 0; c != k; ++c) {
+	    if (old_magnitude[c] == 0 || centroid_magnitude[c] == 0)
+		continue;
+	    double dist = 1 - dots[c] / sqrt(old_magnitude[c] *
+					     centroid_magnitude[c]);
+	    if (dist > CONVERGENCE_THRESHOLD)
+		return false;
+	}
+	return true;
+    }
+};
+
+}
+
 ClusterSet
 KMeans::cluster(const MSet& mset)
 {
@@ -88,49 +245,30 @@ KMeans::cluster(const MSet& mset)
     initialise_points(mset);
     ClusterSet cset;
     initialise_clusters(cset, size);
-    CosineDistance distance;
-    vector<Centroid> previous_centroids;
+
+    KMeansVectors vectors(points, size, k);
+    for (unsigned int c = 0; c < k; ++c) {
+	vectors.set_centroid(c, (c * size) / k);
+    }
+
+    vector<unsigned> assignment(size);
+    vector<double> dots;
     for (unsigned int i = 0; i < max_iters; ++i) {
 	// Assign each point to the cluster corresponding to its
 	// closest cluster centroid
-	cset.clear_clusters();
-	for (unsigned int j = 0; j < size; ++j) {
-	    double closest_cluster_distance = numeric_limits<double>::max();
-	    unsigned int closest_cluster = 0;
-	    for (unsigned int c = 0; c < k; ++c) {
-		const Centroid& centroid = cset[c].get_centroid();
-		double dist = distance.similarity(points[j], centroid);
-		if (closest_cluster_distance > dist) {
-		    closest_cluster_distance = dist;
-		    closest_cluster = c;
-		}
-	    }
-	    cset.add_to_cluster(points[j], closest_cluster);
+	for (doccount j = 0; j < size; ++j) {
+	    assignment[j] = vectors.closest_centroid(j, dots);
 	}
 
-	// Remember the previous centroids
-	previous_centroids.clear();
-	for (unsigned int j = 0; j < k; ++j)
-	    previous_centroids.push_back(cset[j].get_centroid());
-
-	// Recalculate the centroids for current iteration
-	cset.recalculate_centroids();
-
-	// Check whether centroids have converged
-	bool has_converged = true;
-	for (unsigned int j = 0; j < k; ++j) {
-	    const Centroid& centroid = cset[j].get_centroid();
-	    double dist = distance.similarity(previous_centroids[j], centroid);
-	    // If distance between any two centroids has changed by
-	    // more than the threshold, then KMeans hasn't converged
-	    if (dist > CONVERGENCE_THRESHOLD) {
-		has_converged = false;
-		break;
-	    }
-	}
-	// If converged, then break from the loop
-	if (has_converged)
+	// Recalculate the centroids, and stop if they've converged.
+	if (vectors.recalculate(assignment))
 	    break;
     }
+
+    cset.clear_clusters();
+    for (doccount j = 0; j < size; ++j) {
+	cset.add_to_cluster(points[j], assignment[j]);
+    }
+    cset.recalculate_centroids();
     return cset;
 }
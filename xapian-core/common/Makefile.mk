@@ -2,6 +2,7 @@ noinst_HEADERS +=\
 	common/alignment_cast.h\
 	common/append_filename_arg.h\
 	common/bitstream.h\
+	common/blockpositions.h\
 	common/closefrom.h\
 	common/compression_stream.h\
 	common/debuglog.h\
@@ -54,6 +55,7 @@ EXTRA_DIST +=\
 
 lib_src +=\
 	common/bitstream.cc\
+	common/blockpositions.cc\
 	common/closefrom.cc\
 	common/debuglog.cc\
 	common/errno_to_string.cc\
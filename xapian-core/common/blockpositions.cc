@@ -0,0 +1,185 @@
+/** @file
+ * @brief Block-packed encoding of position lists.
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <config.h>
+
+#include "blockpositions.h"
+
+#include "xapian/error.h"
+
+#include "omassert.h"
+#include "pack.h"
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace std;
+
+namespace Xapian {
+
+/// Largest bit width we use for a delta.
+static const unsigned MAX_WIDTH = 32;
+
+bool
+encode_block_positions(string& s, const Xapian::VecCOW<Xapian::termpos>& vec)
+{
+    Assert(!vec.empty());
+    string out("\x80\0", 2);
+    pack_uint(out, vec.size());
+    pack_uint(out, vec.back());
+
+    Xapian::termpos prev_first = 0;
+    for (size_t b = 0; b < vec.size(); b += BLOCK_POSITIONS_SIZE) {
+	size_t e = min(b + BLOCK_POSITIONS_SIZE, vec.size());
+	Xapian::termpos max_delta = 0;
+	for (size_t i = b + 1; i < e; ++i) {
+	    AssertRel(vec[i - 1],<,vec[i]);
+	    max_delta = max(max_delta, vec[i] - vec[i - 1] - 1);
+	}
+	unsigned width = 0;
+	while (width < sizeof(max_delta) * 8 && (max_delta >> width)) ++width;
+	if (width > MAX_WIDTH) return false;
+
+	pack_uint(out, vec[b] - prev_first);
+	prev_first = vec[b];
+	out += char(width);
+
+	uint64_t acc = 0;
+	unsigned bits = 0;
+	for (size_t i = b + 1; i < e; ++i) {
+	    acc |= uint64_t(vec[i] - vec[i - 1] - 1) << bits;
+	    bits += width;
+	    while (bits >= 8) {
+		out += char(acc);
+		acc >>= 8;
+		bits -= 8;
+	    }
+	}
+	if (bits) out += char(acc);
+    }
+
+    s += out;
+    return true;
+}
+
+void
+BlockPositionReader::read_block_header(Xapian::termpos prev_first)
+{
+    if (remaining == 0) {
+	next_count = 0;
+	return;
+    }
+
+    Xapian::termpos delta;
+    if (!unpack_uint(&p, end, &delta) || p == end) {
+	throw Xapian::DatabaseCorruptError("Position list block header "
+					   "corrupt");
+    }
+    next_first = prev_first + delta;
+    next_width = static_cast<unsigned char>(*p++);
+    if (next_width > MAX_WIDTH) {
+	throw Xapian::DatabaseCorruptError("Position list block width "
+					   "invalid");
+    }
+    next_count = unsigned(min(remaining,
+			      Xapian::termcount(BLOCK_POSITIONS_SIZE)));
+    remaining -= next_count;
+    size_t bytes = (size_t(next_count - 1) * next_width + 7) / 8;
+    if (size_t(end - p) < bytes) {
+	throw Xapian::DatabaseCorruptError("Position list block truncated");
+    }
+    next_data = p;
+    p += bytes;
+}
+
+void
+BlockPositionReader::next_block()
+{
+    if (rare(next_count == 0)) {
+	throw Xapian::DatabaseCorruptError("Position list ends before last "
+					   "position");
+    }
+    width = next_width;
+    count = next_count;
+    data = next_data;
+    idx = 0;
+    unpacked = (count == 1);
+    block[0] = next_first;
+    read_block_header(next_first);
+}
+
+void
+BlockPositionReader::unpack()
+{
+    const unsigned char* d = reinterpret_cast<const unsigned char*>(data);
+    const uint64_t mask = (uint64_t(1) << width) - 1;
+    uint64_t acc = 0;
+    unsigned bits = 0;
+    Xapian::termpos pos = block[0];
+    for (unsigned i = 1; i < count; ++i) {
+	while (bits < width) {
+	    acc |= uint64_t(*d++) << bits;
+	    bits += 8;
+	}
+	pos += Xapian::termpos(acc & mask) + 1;
+	acc >>= width;
+	bits -= width;
+	block[i] = pos;
+    }
+    unpacked = true;
+}
+
+void
+BlockPositionReader::init(const char* p_, const char* end_,
+			  Xapian::termcount& size, Xapian::termpos& last)
+{
+    Assert(is_block_positions(p_, end_));
+    p = p_ + 2;
+    end = end_;
+    if (!unpack_uint(&p, end, &size) ||
+	!unpack_uint(&p, end, &last) ||
+	size == 0) {
+	throw Xapian::DatabaseCorruptError("Position list data corrupt");
+    }
+    remaining = size;
+    read_block_header(0);
+    next_block();
+}
+
+Xapian::termpos
+BlockPositionReader::skip_to(Xapian::termpos target)
+{
+    while (next_count && next_first <= target) {
+	next_block();
+    }
+    if (block[idx] < target) {
+	if (!unpacked) unpack();
+	while (++idx < count) {
+	    if (block[idx] >= target) return block[idx];
+	}
+	// The target is after the end of this block, but before the start of
+	// the next.
+	next_block();
+    }
+    return block[idx];
+}
+
+}
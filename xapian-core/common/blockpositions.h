@@ -0,0 +1,173 @@
+/** @file
+ * @brief Block-packed encoding of position lists.
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#ifndef XAPIAN_INCLUDED_BLOCKPOSITIONS_H
+#define XAPIAN_INCLUDED_BLOCKPOSITIONS_H
+
+#include <xapian/types.h>
+
+#include "api/smallvector.h"
+
+#include <string>
+
+/* The encoding is:
+ *
+ *   "\x80\x00" (an overlong pack_uint() encoding of 0, which pack_uint()
+ *   never produces, so this can't be confused with interpolative coded data)
+ *   pack_uint(number of positions)
+ *   pack_uint(last position)
+ *
+ * followed by a block for each BLOCK_POSITIONS_SIZE positions (the final block
+ * may be shorter):
+ *
+ *   pack_uint(first position in block - first position in previous block)
+ *   a byte holding the bit width w
+ *   (positions in block - 1) deltas minus one, each w bits, least
+ *   significant bit first, padded to a whole number of bytes.
+ *
+ * The length of a block can be calculated from its header, so the block
+ * headers act as a skip list and a reader only needs to unpack the blocks
+ * which it actually returns positions from.
+ */
+
+namespace Xapian {
+
+/// Number of positions in each block.
+const unsigned BLOCK_POSITIONS_SIZE = 64;
+
+/// Check if encoded position list data uses the block-packed encoding.
+inline bool
+is_block_positions(const char* p, const char* end)
+{
+    return end - p >= 2 && p[0] == '\x80' && p[1] == '\0';
+}
+
+/** Append a block-packed encoding of a position list to a string.
+ *
+ *  @param s	The string to append to.
+ *  @param vec	The positions, which must be non-empty and strictly
+ *		increasing.
+ *
+ *  @return false if @a vec can't be encoded this way (because the gap
+ *	    between two positions is too large), in which case @a s is left
+ *	    unchanged.
+ */
+bool encode_block_positions(std::string& s,
+			    const Xapian::VecCOW<Xapian::termpos>& vec);
+
+/// Decode a position list created by encode_block_positions().
+class BlockPositionReader {
+    /// Start of the block after the next one.
+    const char* p;
+
+    /// End of the encoded data.
+    const char* end;
+
+    /// Positions in the blocks after the next one.
+    Xapian::termcount remaining;
+
+    /// First position in the next block.
+    Xapian::termpos next_first;
+
+    /// Bit width of the deltas in the next block.
+    unsigned next_width;
+
+    /// Number of positions in the next block (0 if there isn't one).
+    unsigned next_count;
+
+    /// Start of the packed deltas in the next block.
+    const char* next_data;
+
+    /// Bit width of the deltas in the current block.
+    unsigned width;
+
+    /// Number of positions in the current block.
+    unsigned count;
+
+    /// Start of the packed deltas in the current block.
+    const char* data;
+
+    /// Index of the current position in @a block.
+    unsigned idx;
+
+    /// Have the deltas in the current block been unpacked into @a block?
+    bool unpacked;
+
+    /// The positions in the current block.
+    Xapian::termpos block[BLOCK_POSITIONS_SIZE];
+
+    /// Read the header of the block at @a p into the next_* members.
+    void read_block_header(Xapian::termpos prev_first);
+
+    /// Move on to the next block.
+    void next_block();
+
+    /// Unpack the positions in the current block.
+    void unpack();
+
+  public:
+    /** Start decoding.
+     *
+     *  @param p_	Start of the encoded data (which must satisfy
+     *			is_block_positions()).
+     *  @param end_	End of the encoded data.
+     *  @param size	Set to the number of positions.
+     *  @param last	Set to the last position.
+     *
+     *  On return the reader is positioned on the first position.
+     *
+     *  @exception Xapian::DatabaseCorruptError if the data is invalid.
+     */
+    void init(const char* p_, const char* end_,
+	      Xapian::termcount& size, Xapian::termpos& last);
+
+    /// Return the current position.
+    Xapian::termpos get_position() const { return block[idx]; }
+
+    /** Advance to the next position.
+     *
+     *  Must not be called when on the last position.
+     */
+    Xapian::termpos next() {
+	if (++idx < count) {
+	    if (!unpacked) unpack();
+	    return block[idx];
+	}
+	next_block();
+	return block[0];
+    }
+
+    /** Advance to the first position >= @a target.
+     *
+     *  @a target must be greater than the current position and no greater
+     *  than the last position.  Whole blocks are skipped using the block
+     *  headers without unpacking them.
+     */
+    Xapian::termpos skip_to(Xapian::termpos target);
+};
+
+}
+
+using Xapian::BlockPositionReader;
+using Xapian::encode_block_positions;
+using Xapian::is_block_positions;
+
+#endif // XAPIAN_INCLUDED_BLOCKPOSITIONS_H
@@ -28,16 +28,26 @@
 #endif
 
 #include <xapian/constants.h>
+#include <xapian/types.h>
 #include <xapian/visibility.h>
 #include <string>
 
 namespace Xapian {
 
 class Database;
+class Document;
 
 /** Compact a database, or merge and compact several.
  */
 class XAPIAN_VISIBILITY_DEFAULT Compactor {
+    friend class Database;
+
+    /// Value slot to order documents by (Xapian::BAD_VALUENO for none).
+    Xapian::valueno sort_slot = Xapian::BAD_VALUENO;
+
+    /// Order documents by descending value?
+    bool sort_reverse = false;
+
   public:
     /** Compaction level. */
     typedef enum {
@@ -54,6 +64,29 @@ class XAPIAN_VISIBILITY_DEFAULT Compactor {
 
     virtual ~Compactor();
 
+    /** Store documents in order of a value slot.
+     *
+     *  Documents in the output database are ordered by the value in @a
+     *  sort_key (as compared by Enquire::set_sort_by_value()), reassigning
+     *  document ids if the inputs aren't already in this order.  The order
+     *  is recorded in the output database, and a search which is sorted by
+     *  just this value (with the default docid order) can then stop once it
+     *  has found enough matches, rather than having to consider every
+     *  matching document.
+     *
+     *  Only supported when compacting to the honey backend.  The new
+     *  document ids are reported via set_new_docid().
+     *
+     *  @param sort_key	The value slot to order by.
+     *  @param reverse	If true, order by descending value.
+     *
+     *  @since 1.5.0
+     */
+    void set_sort_by_value(Xapian::valueno sort_key, bool reverse) {
+	sort_slot = sort_key;
+	sort_reverse = reverse;
+    }
+
     /** Update progress.
      *
      *  Subclass this method if you want to get progress updates during
@@ -93,6 +126,41 @@ class XAPIAN_VISIBILITY_DEFAULT Compactor {
     virtual std::string
     resolve_duplicate_metadata(const std::string & key,
 			       size_t num_tags, const std::string tags[]);
+
+    /** Return the key to order a document by when reordering.
+     *
+     *  Only called when compacting with Xapian::DBCOMPACT_REORDER.
+     *  Documents are put in ascending order of their keys, and documents
+     *  with the same key are ordered so that documents with similar terms
+     *  are close together.  For example, returning the hostname from a URL
+     *  stored in a value slot keeps documents from the same site together.
+     *
+     *  The default implementation returns an empty string, so all documents
+     *  are ordered by their terms.
+     *
+     *  @param doc	The document.
+     *
+     *  @since 1.5.0
+     */
+    virtual std::string get_reorder_key(const Xapian::Document& doc);
+
+    /** Report the new document id for a document.
+     *
+     *  Only called when compacting with Xapian::DBCOMPACT_REORDER, or when
+     *  set_sort_by_value() has been used and the documents need reordering.
+     *  It's called once for each document, so callers can update any
+     *  external references to document ids.
+     *
+     *  The default implementation does nothing.
+     *
+     *  @param old_did	The document id in the database being compacted
+     *			(for a database with several shards, this is the
+     *			document id in the combined database).
+     *  @param new_did	The document id in the output database.
+     *
+     *  @since 1.5.0
+     */
+    virtual void set_new_docid(Xapian::docid old_did, Xapian::docid new_did);
 };
 
 }
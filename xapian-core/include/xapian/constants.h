@@ -274,6 +274,63 @@ const int DBCOMPACT_MULTIPASS = 8;
  */
 const int DBCOMPACT_SINGLE_FILE = 16;
 
+/** Also store impact-ordered postings in the output database.
+ *
+ *  For each term, the postings are additionally stored grouped by a quantised
+ *  BM25 weight contribution (with the default BM25Weight parameters), highest
+ *  first.  These are used by Xapian::ImpactPostingSource.
+ *
+ *  Only supported when compacting to the honey backend.
+ *
+ *  @since 1.5.0
+ */
+const int DBCOMPACT_IMPACTS = 32;
+
+/** Reassign document ids to make the output database smaller and faster.
+ *
+ *  Documents are ordered by the key returned by
+ *  Xapian::Compactor::get_reorder_key() (all documents have the same key by
+ *  default), and documents with the same key are ordered by recursive graph
+ *  bisection so that documents with similar terms get nearby document ids.
+ *  This makes postlists compress better and gives longer skips.  The new
+ *  document ids are reported via Xapian::Compactor::set_new_docid().
+ *
+ *  Can't be used with DBCOMPACT_NO_RENUMBER, or when compacting to a file
+ *  descriptor.
+ *
+ *  @since 1.5.0
+ */
+const int DBCOMPACT_REORDER = 64;
+
+/** Also store a filter over the terms in the output database.
+ *
+ *  This is a Bloom filter which is checked before looking up a term, so most
+ *  lookups of terms which aren't in the database (e.g. by
+ *  Database::term_exists(), Database::get_termfreq(), or when opening a
+ *  postlist to run a query) don't need to search the postlist table.  It takes
+ *  a little over a byte per term.
+ *
+ *  Only supported when compacting to the honey backend.
+ *
+ *  @since 1.5.0
+ */
+const int DBCOMPACT_TERM_FILTER = 128;
+
+/** Store long position lists block-packed.
+ *
+ *  Position lists are split into blocks of packed deltas rather than using
+ *  interpolative coding.  This takes more disk space, but is faster to
+ *  decode and allows whole blocks to be skipped, which can make phrase and
+ *  NEAR matching on long documents much faster.
+ *
+ *  Only supported when compacting to the honey backend.  Without this flag,
+ *  block-packed position lists in a honey source database are converted
+ *  back to interpolative coding.
+ *
+ *  @since 1.5.0
+ */
+const int DBCOMPACT_BLOCK_POSITIONS = 2048;
+
 /** Assume document id is valid.
  *
  *  By default, Database::get_document() checks that the document id passed is
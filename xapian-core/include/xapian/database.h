@@ -114,6 +114,36 @@ class XAPIAN_VISIBILITY_DEFAULT Database {
     /** Return number of shards in this Database object. */
     size_t size() const;
 
+    /** Select how the docids of the shards map to the combined docids.
+     *
+     *  By default the docids of the shards are interleaved, so with N shards
+     *  docid D in shard S (counting from 0) becomes (D - 1) * N + S + 1 in
+     *  the combined database.
+     *
+     *  If @a contiguous is true, the docid ranges of the shards are instead
+     *  concatenated in order, so docid D in shard S becomes D plus the sum of
+     *  get_lastdocid() for shards 0 to S - 1.  This is a natural fit when each
+     *  shard holds a contiguous block of documents, and is cheaper to iterate
+     *  over, as postlists from the shards can be read in turn rather than
+     *  merged.  Documents added via a WritableDatabase go in the last shard.
+     *
+     *  The offsets for concatenated docid ranges are calculated from the
+     *  shards' last docids at the time of this call, and recalculated by
+     *  reopen() and when shards are added.  Adding documents to a shard other
+     *  than the last by other means renumbers the documents in the shards
+     *  which follow it once the offsets are recalculated.
+     *
+     *  This setting is shared by all Database objects which share the same
+     *  shards, and it should be called after all the shards have been added
+     *  - it has no effect with fewer than two shards.
+     *
+     *  @param contiguous	true to concatenate the docid ranges of the
+     *				shards; false to interleave them (the default).
+     *
+     *  @since 1.5.0
+     */
+    void set_contiguous_shards(bool contiguous = true);
+
     /** Construct a Database containing no shards.
      *
      *  You can then add shards by calling add_database().  A Database
@@ -633,6 +663,61 @@ class XAPIAN_VISIBILITY_DEFAULT Database {
      */
     Xapian::rev get_revision() const;
 
+    /** Set the size of the cache for boolean filter subqueries.
+     *
+     *  When enabled, the documents matched by the second and subsequent
+     *  subqueries of an OP_FILTER (i.e. the unweighted filter conditions) are
+     *  stored in a compressed bitmap the first time they're used, and later
+     *  queries with the same filter subquery iterate this bitmap rather than
+     *  reading postings from the database.  This can help considerably if
+     *  most queries share a small set of filters.
+     *
+     *  Each sub-database has its own cache, which is discarded automatically
+     *  if the sub-database's revision changes (e.g. after reopen()).  When
+     *  the cache is full, the least recently used entries are discarded.
+     *
+     *  The cache is only used for read-only glass and honey sub-databases -
+     *  for other sub-databases this setting is ignored.  Filter subqueries
+     *  which contain a PostingSource or are used inside a positional query
+     *  aren't cached.
+     *
+     *  A filter subquery is only cached if the cache could hold a bitmap of
+     *  every document in the sub-database, which needs at most about 1 bit
+     *  per document id (and at most 4 bytes per document) - otherwise it is
+     *  evaluated as normal.
+     *
+     *  The cache is disabled by default.
+     *
+     *  @param max_bytes  The approximate maximum number of bytes of memory
+     *		      each sub-database's cache may use (0 disables the cache
+     *		      and discards any cached entries).
+     *
+     *  @since 1.5.0
+     */
+    void set_filter_cache_size(size_t max_bytes);
+
+    /** Keep the document lengths in memory.
+     *
+     *  When enabled, the length of every document is read into a compact
+     *  in-memory array (using just enough bits per document for the longest
+     *  document), so looking up a document's length (as most weighting
+     *  schemes need to for every candidate document) is a simple array
+     *  access rather than a B-tree lookup.
+     *
+     *  The array is loaded when this method is called, and reloaded by
+     *  reopen() if the revision has changed.  It's shared by all Database
+     *  objects which share the same sub-database.
+     *
+     *  This is only supported for read-only glass sub-databases - for other
+     *  sub-databases this setting is ignored.
+     *
+     *  @param enable	true to load the document lengths (the default is not
+     *			to); false to discard them.
+     *
+     *  @since 1.5.0
+     */
+    void set_doclength_cache(bool enable = true);
+
     /** Check the integrity of a database or database table.
      *
      *  @param path	Path to database or table
@@ -684,6 +769,17 @@ class XAPIAN_VISIBILITY_DEFAULT Database {
      *   - Xapian::DBCOMPACT_SINGLE_FILE
      *		Produce a single-file database (only supported for glass
      *		currently).
+     *   - Xapian::DBCOMPACT_IMPACTS
+     *		Also store impact-ordered postings for use by
+     *		Xapian::ImpactPostingSource (only supported when compacting
+     *		to honey).
+     *   - Xapian::DBCOMPACT_REORDER
+     *		Reassign document ids so that similar documents are close
+     *		together (not supported when compacting to a file
+     *		descriptor) - see Xapian::Compactor::get_reorder_key().
+     *   - Xapian::DBCOMPACT_BLOCK_POSITIONS
+     *		Store long position lists block-packed, which is faster to
+     *		decode (only supported when compacting to honey).
      *   - At most one of:
      *     - Xapian::Compactor::STANDARD - Don't split items unnecessarily.
      *     - Xapian::Compactor::FULL     - Split items whenever it saves space
@@ -742,6 +838,17 @@ class XAPIAN_VISIBILITY_DEFAULT Database {
      *   - Xapian::DBCOMPACT_SINGLE_FILE
      *		Produce a single-file database (only supported for glass
      *		currently).
+     *   - Xapian::DBCOMPACT_IMPACTS
+     *		Also store impact-ordered postings for use by
+     *		Xapian::ImpactPostingSource (only supported when compacting
+     *		to honey).
+     *   - Xapian::DBCOMPACT_REORDER
+     *		Reassign document ids so that similar documents are close
+     *		together (not supported when compacting to a file
+     *		descriptor) - see Xapian::Compactor::get_reorder_key().
+     *   - Xapian::DBCOMPACT_BLOCK_POSITIONS
+     *		Store long position lists block-packed, which is faster to
+     *		decode (only supported when compacting to honey).
      *   - At most one of:
      *     - Xapian::Compactor::STANDARD - Don't split items unnecessarily.
      *     - Xapian::Compactor::FULL     - Split items whenever it saves space
@@ -795,6 +902,17 @@ class XAPIAN_VISIBILITY_DEFAULT Database {
      *   - Xapian::DBCOMPACT_SINGLE_FILE
      *		Produce a single-file database (only supported for glass
      *		currently).
+     *   - Xapian::DBCOMPACT_IMPACTS
+     *		Also store impact-ordered postings for use by
+     *		Xapian::ImpactPostingSource (only supported when compacting
+     *		to honey).
+     *   - Xapian::DBCOMPACT_REORDER
+     *		Reassign document ids so that similar documents are close
+     *		together (not supported when compacting to a file
+     *		descriptor) - see Xapian::Compactor::get_reorder_key().
+     *   - Xapian::DBCOMPACT_BLOCK_POSITIONS
+     *		Store long position lists block-packed, which is faster to
+     *		decode (only supported when compacting to honey).
      *   - At most one of:
      *     - Xapian::Compactor::STANDARD - Don't split items unnecessarily.
      *     - Xapian::Compactor::FULL     - Split items whenever it saves space
@@ -856,6 +974,17 @@ class XAPIAN_VISIBILITY_DEFAULT Database {
      *   - Xapian::DBCOMPACT_SINGLE_FILE
      *		Produce a single-file database (only supported for glass
      *		currently).
+     *   - Xapian::DBCOMPACT_IMPACTS
+     *		Also store impact-ordered postings for use by
+     *		Xapian::ImpactPostingSource (only supported when compacting
+     *		to honey).
+     *   - Xapian::DBCOMPACT_REORDER
+     *		Reassign document ids so that similar documents are close
+     *		together (not supported when compacting to a file
+     *		descriptor) - see Xapian::Compactor::get_reorder_key().
+     *   - Xapian::DBCOMPACT_BLOCK_POSITIONS
+     *		Store long position lists block-packed, which is faster to
+     *		decode (only supported when compacting to honey).
      *   - At most one of:
      *     - Xapian::Compactor::STANDARD - Don't split items unnecessarily.
      *     - Xapian::Compactor::FULL     - Split items whenever it saves space
@@ -45,6 +45,7 @@ class ExpandDecider;
 class KeyMaker;
 class MatchDecider;
 class MatchSpy;
+class MatchVisitor;
 class Query;
 class RSet;
 class Weight;
@@ -345,18 +346,30 @@ class XAPIAN_VISIBILITY_DEFAULT Enquire {
      *  cases.  You can set a time limit on this, after which check_at_least
      *  will be turned off.
      *
+     *  The time limit is checked cooperatively by the matcher, which reads a
+     *  monotonic clock at an interval adapted to how quickly candidate
+     *  documents are being processed, so this doesn't need any support from
+     *  the platform beyond std::chrono::steady_clock.
+     *
      *  @param time_limit  time in seconds after which to disable
      *			   check_at_least (default: 0.0 which means no
      *			   time limit)
+     *  @param stop_match  if true, stop the match entirely once the time
+     *			   limit is reached and return the results found so
+     *			   far (which may be fewer than requested, and may not
+     *			   be the best matching documents).  Use
+     *			   MSet::timed_out() to check if this happened.
+     *			   (default: false, added in Xapian 1.5.0)
      *
      *  Limitations:
      *
-     *  This feature is currently supported on platforms which support POSIX
-     *  interval timers.  Interaction with the remote backend when using
-     *  multiple databases may have bugs.  There's not currently a way to
-     *  force the match to end after a certain time.
+     *  Interaction with the remote backend when using multiple databases may
+     *  have bugs.  Each remote shard applies the time limit independently.
+     *  A single call to PostingSource::next() or a MatchDecider which takes
+     *  longer than the time limit can't be interrupted, so the limit may be
+     *  overshot by that much.
      */
-    void set_time_limit(double time_limit);
+    void set_time_limit(double time_limit, bool stop_match = false);
 
     /** Run the query.
      *
@@ -409,6 +422,124 @@ class XAPIAN_VISIBILITY_DEFAULT Enquire {
 	return get_mset(first, maxitems, 0, rset, mdecider);
     }
 
+    /** Run the query, returning the results after a cursor.
+     *
+     *  This allows deep pagination without the cost growing with the page
+     *  number: instead of asking for results starting at rank @a first, pass
+     *  the weight, sort key and document ID of the last result on the
+     *  previous page and the returned MSet will start with the result
+     *  immediately after it in the result ordering.  The matcher only needs
+     *  to keep track of @a maxitems results however deep you go.
+     *
+     *  The other settings of this Enquire object (the query, weighting
+     *  scheme, sort order, etc) should be the same as those used to get the
+     *  previous page.  If the database has changed since then, results may be
+     *  missed or repeated.
+     *
+     *  When collapsing, documents are only collapsed against other documents
+     *  after the cursor.
+     *
+     *  MSet::get_firstitem() on the returned MSet will be 0, while the
+     *  bounds and estimate of the number of matches still cover all the
+     *  results (including those before the cursor).
+     *
+     *  @param last_weight	The weight of the last result on the previous
+     *				page (as returned by MSetIterator::get_weight())
+     *  @param last_sort_key	The sort key of the last result on the
+     *				previous page (as returned by
+     *				MSetIterator::get_sort_key())
+     *  @param last_did		The document ID of the last result on the
+     *				previous page
+     *  @param maxitems		The maximum number of documents to return.
+     *  @param checkatleast	Check at least this many documents (see
+     *				get_mset() for details).  (default: 0)
+     *  @param rset		Documents marked as relevant (default: no
+     *				documents have been marked as relevant)
+     *  @param mdecider		Xapian::MatchDecider object - this acts as a
+     *				yes/no filter on documents which match the
+     *				query.  (default: no Xapian::MatchDecider)
+     *
+     *  @since 1.5.0
+     */
+    MSet get_mset_after(double last_weight,
+			const std::string& last_sort_key,
+			docid last_did,
+			doccount maxitems,
+			doccount checkatleast = 0,
+			const RSet* rset = NULL,
+			const MatchDecider* mdecider = NULL) const;
+
+    /** Run the query, returning the results after a cursor.
+     *
+     *  Convenience overloaded form, taking the cursor from an MSetIterator
+     *  pointing to the last result on the previous page.
+     *
+     *  @param last		The last result on the previous page.
+     *  @param maxitems		The maximum number of documents to return.
+     *  @param checkatleast	Check at least this many documents (see
+     *				get_mset() for details).  (default: 0)
+     *  @param rset		Documents marked as relevant (default: no
+     *				documents have been marked as relevant)
+     *  @param mdecider		Xapian::MatchDecider object - this acts as a
+     *				yes/no filter on documents which match the
+     *				query.  (default: no Xapian::MatchDecider)
+     *
+     *  @since 1.5.0
+     */
+    MSet get_mset_after(const MSetIterator& last,
+			doccount maxitems,
+			doccount checkatleast = 0,
+			const RSet* rset = NULL,
+			const MatchDecider* mdecider = NULL) const {
+	return get_mset_after(last.get_weight(), last.get_sort_key(), *last,
+			      maxitems, checkatleast, rset, mdecider);
+    }
+
+    /** Pass every document matching the query to a visitor.
+     *
+     *  This is intended for bulk consumers which want all the matches (for
+     *  example, to export them or to build a secondary index) and have no
+     *  use for them being ranked.  Unlike get_mset() no candidate result set
+     *  is built, so the memory used doesn't grow with the number of matches.
+     *
+     *  The documents are passed in ascending docid order (with multiple
+     *  shards, the shards are iterated in step to achieve this).
+     *
+     *  The sort order, collapsing, cutoffs, time limit and matchspies set on
+     *  this Enquire are ignored.
+     *
+     *  @param visitor		Xapian::MatchVisitor object to call for each
+     *				matching document.  If it returns false the
+     *				match stops.
+     *  @param want_weights	If true, calculate the weight of each document
+     *				using the weighting scheme.  If false (the
+     *				default), no weights are calculated and the
+     *				weight passed to @a visitor is always 0.
+     *
+     *  @return The number of documents passed to @a visitor.
+     *
+     *  @exception Xapian::UnimplementedError is thrown if the database
+     *		   includes remote shards.
+     *
+     *  @since 1.5.0
+     */
+    doccount visit_matches(MatchVisitor& visitor,
+			   bool want_weights = false) const;
+
+    /** Count the documents matching the query exactly.
+     *
+     *  This is much cheaper than calling get_mset() with @a checkatleast set
+     *  to the number of documents in the database and then looking at
+     *  MSet::get_matches_estimated(), since no weights are calculated and no
+     *  candidate result set is built.
+     *
+     *  The sort order, collapsing, cutoffs, time limit and matchspies set on
+     *  this Enquire are ignored.
+     *
+     *  @since 1.5.0
+     */
+    doccount get_matches_count() const;
+
     /** Iterate query terms matching a document.
      *
      *  Takes terms from the query set by @a set_query() and from the document
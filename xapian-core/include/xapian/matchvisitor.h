@@ -0,0 +1,69 @@
+/** @file
+ * @brief Abstract base class for visiting every match
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef XAPIAN_INCLUDED_MATCHVISITOR_H
+#define XAPIAN_INCLUDED_MATCHVISITOR_H
+
+#if !defined XAPIAN_IN_XAPIAN_H && !defined XAPIAN_LIB_BUILD
+# error Never use <xapian/matchvisitor.h> directly; include <xapian.h> instead.
+#endif
+
+#include <xapian/attributes.h>
+#include <xapian/types.h>
+#include <xapian/visibility.h>
+
+namespace Xapian {
+
+/** Abstract base class for visiting every match.
+ *
+ *  Subclass this and pass an instance to Enquire::visit_matches() to be
+ *  called for each document matching the query.
+ *
+ *  @since 1.5.0
+ */
+class XAPIAN_VISIBILITY_DEFAULT MatchVisitor {
+  private:
+    /// Don't allow assignment.
+    void operator=(const MatchVisitor &) = delete;
+
+    /// Don't allow copying.
+    MatchVisitor(const MatchVisitor &) = delete;
+
+  public:
+    /// Default constructor, needed by subclass constructors.
+    MatchVisitor() noexcept {}
+
+    /** Virtual destructor, because we have virtual methods. */
+    virtual ~MatchVisitor() { }
+
+    /** Process a matching document.
+     *
+     *  @param did	The document ID.
+     *  @param weight	The weight of the document (always 0 unless weights
+     *			were asked for).
+     *
+     *  @return true to continue the match, or false to stop it.
+     */
+    virtual bool operator()(Xapian::docid did, double weight) = 0;
+};
+
+}
+
+#endif // XAPIAN_INCLUDED_MATCHVISITOR_H
@@ -237,6 +237,29 @@ class XAPIAN_VISIBILITY_DEFAULT MSet {
     /** The maximum possible weight any document could achieve. */
     double get_max_possible() const;
 
+    /** Did the match stop early because the time limit was reached?
+     *
+     *  This can only happen if Enquire::set_time_limit() was called with
+     *  @a stop_match set to true.  If it returns true then the MSet only
+     *  reflects the candidates considered before the limit was reached, and
+     *  the match count bounds and estimate are calculated as if
+     *  check_at_least had been reached at that point.
+     *
+     *  @since Added in Xapian 1.5.0.
+     */
+    bool timed_out() const;
+
+    /** The number of matching documents the matcher evaluated.
+     *
+     *  Documents skipped by the matcher's optimisations (for example because
+     *  they couldn't score highly enough to make it into the MSet) aren't
+     *  counted.  If timed_out() returns true this indicates how far the
+     *  match got before it was stopped.
+     *
+     *  @since Added in Xapian 1.5.0.
+     */
+    Xapian::doccount get_docs_checked() const;
+
     enum {
 	/** Model the relevancy of non-query terms in MSet::snippet().
 	 *
@@ -36,6 +36,8 @@
 
 #include <string>
 #include <map>
+#include <utility>
+#include <vector>
 
 namespace Xapian {
 
@@ -750,6 +752,84 @@ class XAPIAN_VISIBILITY_DEFAULT FixedWeightPostingSource : public PostingSource
     std::string get_description() const override;
 };
 
+/** A posting source which scores documents using stored impacts.
+ *
+ *  This requires a database compacted to honey with Xapian::DBCOMPACT_IMPACTS,
+ *  which stores each term's postings grouped by their quantised BM25 weight
+ *  contribution (the "impact").  The postings for all the terms are processed
+ *  in decreasing order of impact ("score-at-a-time"), summing the impacts for
+ *  each document, which gives weights approximating an OR of the terms using
+ *  the default BM25Weight.
+ *
+ *  A limit can be set on the number of postings to process, in which case
+ *  only the highest impact postings are considered.  This gives predictable
+ *  costs for long queries at the expense of some accuracy, since documents
+ *  only matching in lower impact postings will be omitted and others will get
+ *  lower weights than they should.
+ *
+ *  @since 1.5.0
+ */
+class XAPIAN_VISIBILITY_DEFAULT ImpactPostingSource : public PostingSource {
+    /// The terms to score.
+    std::vector<std::string> terms;
+
+    /// Maximum number of postings to process (0 for no limit).
+    Xapian::doccount max_postings;
+
+    /// Matching docids and their summed impacts, in ascending docid order.
+    std::vector<std::pair<Xapian::docid, unsigned>> matches;
+
+    /// Weight of one unit of impact.
+    double scale = 0.0;
+
+    /// Index of the current entry in @a matches.
+    size_t pos = 0;
+
+    /// Flag indicating if we've started (true if we have).
+    bool started = false;
+
+    /// Skip entries which can't achieve @a min_wt.
+    void skip_low_weights(double min_wt);
+
+  public:
+    /** Construct an ImpactPostingSource.
+     *
+     *  @param terms_	      The terms to score documents for.
+     *  @param max_postings_  The maximum number of postings to process (0
+     *			      means no limit, which is the default).
+     */
+    explicit
+    ImpactPostingSource(const std::vector<std::string>& terms_,
+			Xapian::doccount max_postings_ = 0)
+	: terms(terms_), max_postings(max_postings_) { }
+
+    Xapian::doccount get_termfreq_min() const override;
+    Xapian::doccount get_termfreq_est() const override;
+    Xapian::doccount get_termfreq_max() const override;
+
+    double get_weight() const override;
+
+    void next(double min_wt) override;
+    void skip_to(Xapian::docid min_docid, double min_wt) override;
+
+    bool at_end() const override;
+
+    Xapian::docid get_docid() const override;
+
+    ImpactPostingSource* clone() const override;
+    std::string name() const override;
+    std::string serialise() const override;
+    ImpactPostingSource*
+	unserialise(const std::string& serialised) const override;
+
+    /** @exception Xapian::InvalidOperationError if @a db_ doesn't contain
+     *		    impact-ordered postings.
+     */
+    void reset(const Database& db_, Xapian::doccount shard_index) override;
+
+    std::string get_description() const override;
+};
+
 }
 
 #endif // XAPIAN_INCLUDED_POSTINGSOURCE_H
@@ -2,18 +2,22 @@ noinst_HEADERS +=\
 	matcher/andmaybepostlist.h\
 	matcher/andnotpostlist.h\
 	matcher/andpostlist.h\
+	matcher/bitmappostlist.h\
 	matcher/boolorpostlist.h\
 	matcher/collapser.h\
 	matcher/deciderpostlist.h\
+	matcher/docidbitmap.h\
 	matcher/estimateop.h\
 	matcher/exactphrasepostlist.h\
 	matcher/externalpostlist.h\
 	matcher/extraweightpostlist.h\
+	matcher/filtercache.h\
 	matcher/localsubmatch.h\
 	matcher/matcher.h\
 	matcher/matchtimeout.h\
 	matcher/maxpostlist.h\
 	matcher/msetcmp.h\
+	matcher/multiorpostlist.h\
 	matcher/nearpostlist.h\
 	matcher/orpositionlist.h\
 	matcher/orpospostlist.h\
@@ -39,17 +43,21 @@ lib_src +=\
 	matcher/andmaybepostlist.cc\
 	matcher/andnotpostlist.cc\
 	matcher/andpostlist.cc\
+	matcher/bitmappostlist.cc\
 	matcher/boolorpostlist.cc\
 	matcher/collapser.cc\
 	matcher/deciderpostlist.cc\
+	matcher/docidbitmap.cc\
 	matcher/estimateop.cc\
 	matcher/exactphrasepostlist.cc\
 	matcher/externalpostlist.cc\
 	matcher/extraweightpostlist.cc\
+	matcher/filtercache.cc\
 	matcher/localsubmatch.cc\
 	matcher/matcher.cc\
 	matcher/maxpostlist.cc\
 	matcher/msetcmp.cc\
+	matcher/multiorpostlist.cc\
 	matcher/nearpostlist.cc\
 	matcher/orpositionlist.cc\
 	matcher/orpospostlist.cc\
@@ -0,0 +1,102 @@
+/** @file
+ * @brief PostList iterating a DocIdBitmap
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <config.h>
+
+#include "bitmappostlist.h"
+
+#include "omassert.h"
+#include "str.h"
+
+using namespace std;
+
+Xapian::docid
+BitmapPostList::get_docid() const
+{
+    Assert(did != 0);
+    Assert(!at_end_);
+    return did;
+}
+
+double
+BitmapPostList::get_weight(Xapian::termcount,
+			   Xapian::termcount,
+			   Xapian::termcount) const
+{
+    return 0.0;
+}
+
+bool
+BitmapPostList::at_end() const
+{
+    return at_end_;
+}
+
+double
+BitmapPostList::recalc_maxweight()
+{
+    return 0.0;
+}
+
+PostList*
+BitmapPostList::next(double)
+{
+    Assert(!at_end_);
+    if (did == bitmap->get_last()) {
+	at_end_ = true;
+	return NULL;
+    }
+    did = bitmap->lower_bound(chunk, did + 1);
+    return NULL;
+}
+
+PostList*
+BitmapPostList::skip_to(Xapian::docid did_min, double)
+{
+    Assert(!at_end_);
+    if (did_min > did) {
+	did = bitmap->lower_bound(chunk, did_min);
+	at_end_ = (did == 0);
+    }
+    return NULL;
+}
+
+void
+BitmapPostList::get_docid_range(Xapian::docid& first,
+				Xapian::docid& last) const
+{
+    first = bitmap->get_first();
+    last = bitmap->get_last();
+}
+
+string
+BitmapPostList::get_description() const
+{
+    string desc = "BitmapPostList(";
+    desc += str(termfreq);
+    desc += ')';
+    return desc;
+}
+
+Xapian::termcount
+BitmapPostList::count_matching_subqs() const
+{
+    return 0;
+}
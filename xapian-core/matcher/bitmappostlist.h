@@ -0,0 +1,78 @@
+/** @file
+ * @brief PostList iterating a DocIdBitmap
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef XAPIAN_INCLUDED_BITMAPPOSTLIST_H
+#define XAPIAN_INCLUDED_BITMAPPOSTLIST_H
+
+#include "backends/postlist.h"
+#include "docidbitmap.h"
+
+/** PostList iterating a DocIdBitmap.
+ *
+ *  This is used for boolean filter subqueries whose matching documents have
+ *  been cached as a bitmap, so it always returns weight 0.
+ */
+class BitmapPostList : public PostList {
+    /// Don't allow assignment.
+    void operator=(const BitmapPostList&) = delete;
+
+    /// Don't allow copying.
+    BitmapPostList(const BitmapPostList&) = delete;
+
+    /// The bitmap we're iterating.
+    Xapian::Internal::intrusive_ptr<const DocIdBitmap> bitmap;
+
+    /// Index of the bitmap chunk we're currently in.
+    size_t chunk = 0;
+
+    /// The current docid, or zero if we haven't started.
+    Xapian::docid did = 0;
+
+    /// True if we've reached the end.
+    bool at_end_ = false;
+
+  public:
+    explicit BitmapPostList(const DocIdBitmap* bitmap_)
+	: bitmap(bitmap_) {
+	termfreq = bitmap->size();
+    }
+
+    Xapian::docid get_docid() const;
+
+    double get_weight(Xapian::termcount doclen,
+		      Xapian::termcount unique_terms,
+		      Xapian::termcount wdfdocmax) const;
+
+    bool at_end() const;
+
+    double recalc_maxweight();
+
+    PostList* next(double w_min);
+
+    PostList* skip_to(Xapian::docid did, double w_min);
+
+    void get_docid_range(Xapian::docid& first, Xapian::docid& last) const;
+
+    std::string get_description() const;
+
+    Xapian::termcount count_matching_subqs() const;
+};
+
+#endif // XAPIAN_INCLUDED_BITMAPPOSTLIST_H
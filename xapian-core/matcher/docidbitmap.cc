@@ -0,0 +1,149 @@
+/** @file
+ * @brief Compressed bitmap of document ids
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <config.h>
+
+#include "docidbitmap.h"
+
+#include "omassert.h"
+
+#include <algorithm>
+
+using namespace std;
+
+/// Return the index of the lowest set bit in non-zero @a word.
+static inline unsigned
+lowest_set_bit(uint64_t word)
+{
+    Assert(word != 0);
+    if (false) {
+#if HAVE_DECL___BUILTIN_CTZL
+    } else if constexpr(sizeof(uint64_t) == sizeof(unsigned long)) {
+	return __builtin_ctzl(word);
+#endif
+#if HAVE_DECL___BUILTIN_CTZLL
+    } else if constexpr(sizeof(uint64_t) == sizeof(unsigned long long)) {
+	return __builtin_ctzll(word);
+#endif
+    } else {
+	unsigned result = 0;
+	while ((word & 1) == 0) {
+	    word >>= 1;
+	    ++result;
+	}
+	return result;
+    }
+}
+
+void
+DocIdBitmap::add(Xapian::docid did)
+{
+    AssertRel(did, >, last_did);
+    last_did = did;
+    ++count;
+    Xapian::docid key = did >> 16;
+    unsigned low = did & 0xffff;
+    if (chunks.empty() || chunks.back().key != key) {
+	chunks.emplace_back(key);
+    }
+    Chunk& chunk = chunks.back();
+    if (!chunk.bits.empty()) {
+	chunk.bits[low >> 6] |= uint64_t(1) << (low & 63);
+	return;
+    }
+    if (chunk.array.size() < ARRAY_MAX) {
+	chunk.array.push_back(uint16_t(low));
+	return;
+    }
+    // This chunk is dense enough that a bitmap takes less space.
+    chunk.bits.resize(BITMAP_WORDS);
+    for (unsigned v : chunk.array) {
+	chunk.bits[v >> 6] |= uint64_t(1) << (v & 63);
+    }
+    chunk.bits[low >> 6] |= uint64_t(1) << (low & 63);
+    vector<uint16_t>().swap(chunk.array);
+}
+
+Xapian::docid
+DocIdBitmap::get_first() const
+{
+    size_t chunk = 0;
+    return lower_bound(chunk, 1);
+}
+
+size_t
+DocIdBitmap::get_memory_used() const
+{
+    size_t result = sizeof(*this) + chunks.capacity() * sizeof(Chunk);
+    for (auto&& chunk : chunks) {
+	result += chunk.array.capacity() * sizeof(uint16_t);
+	result += chunk.bits.capacity() * sizeof(uint64_t);
+    }
+    return result;
+}
+
+size_t
+DocIdBitmap::max_memory_used(Xapian::doccount n, Xapian::docid last)
+{
+    size_t n_chunks = min(size_t(n), size_t(last >> 16) + 1);
+    // The chunks vector may have up to twice the capacity needed.  The data
+    // in each chunk takes at most the size of a bitmap, and as array chunks
+    // have at most twice the capacity needed, at most 4 bytes per docid.
+    size_t chunk_data = min(n_chunks * BITMAP_WORDS * sizeof(uint64_t),
+			    size_t(n) * 2 * sizeof(uint16_t));
+    return sizeof(DocIdBitmap) + 2 * n_chunks * sizeof(Chunk) + chunk_data;
+}
+
+Xapian::docid
+DocIdBitmap::lower_bound(size_t& chunk, Xapian::docid did) const
+{
+    Xapian::docid key = did >> 16;
+    if (chunk < chunks.size() && chunks[chunk].key < key) {
+	// Binary chop for the first chunk with a key >= the one we want.
+	auto it = std::lower_bound(chunks.begin() + chunk, chunks.end(), key,
+				   [](const Chunk& c, Xapian::docid k) {
+				       return c.key < k;
+				   });
+	chunk = it - chunks.begin();
+    }
+    while (chunk < chunks.size()) {
+	const Chunk& c = chunks[chunk];
+	unsigned low = (c.key == key) ? (did & 0xffff) : 0;
+	Xapian::docid base = c.key << 16;
+	if (c.bits.empty()) {
+	    auto it = std::lower_bound(c.array.begin(), c.array.end(), low);
+	    if (it != c.array.end()) {
+		return base | *it;
+	    }
+	} else {
+	    unsigned w = low >> 6;
+	    uint64_t word = c.bits[w] & (~uint64_t(0) << (low & 63));
+	    while (true) {
+		if (word) {
+		    return base | (w << 6 | lowest_set_bit(word));
+		}
+		if (++w == BITMAP_WORDS) break;
+		word = c.bits[w];
+	    }
+	}
+	++chunk;
+    }
+    return 0;
+}
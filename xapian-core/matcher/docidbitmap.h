@@ -0,0 +1,123 @@
+/** @file
+ * @brief Compressed bitmap of document ids
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef XAPIAN_INCLUDED_DOCIDBITMAP_H
+#define XAPIAN_INCLUDED_DOCIDBITMAP_H
+
+#include "xapian/intrusive_ptr.h"
+#include "xapian/types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/** Compressed bitmap of document ids.
+ *
+ *  This uses the same layout as a "roaring bitmap": the docid space is split
+ *  into chunks of 65536 docids keyed by the high bits of the docid, and each
+ *  non-empty chunk is stored either as a sorted array of the low 16 bits (if
+ *  it is sparse) or as a fixed size bitmap (if it is dense).  So the size is
+ *  bounded by 2 bytes per docid for sparse sets and by 1 bit per docid in the
+ *  covered range for dense sets.
+ *
+ *  The bitmap is built by calling add() with docids in ascending order, and
+ *  is immutable after that.
+ */
+class DocIdBitmap : public Xapian::Internal::intrusive_base {
+    /// Don't allow assignment.
+    void operator=(const DocIdBitmap&) = delete;
+
+    /// Don't allow copying.
+    DocIdBitmap(const DocIdBitmap&) = delete;
+
+    /// Number of 64-bit words in a bitmap chunk.
+    static constexpr unsigned BITMAP_WORDS = 65536 / 64;
+
+    /** Maximum number of entries in an array chunk.
+     *
+     *  Above this an array chunk takes more space than a bitmap chunk.
+     */
+    static constexpr unsigned ARRAY_MAX = 4096;
+
+    struct Chunk {
+	/// The high bits of the docids in this chunk.
+	Xapian::docid key;
+
+	/// Sorted low 16 bits of the docids, if this is an array chunk.
+	std::vector<uint16_t> array;
+
+	/// Bitmap of the low 16 bits, if this is a bitmap chunk.
+	std::vector<uint64_t> bits;
+
+	explicit Chunk(Xapian::docid key_) : key(key_) { }
+    };
+
+    /// The chunks in ascending order of key.
+    std::vector<Chunk> chunks;
+
+    /// The number of docids in the bitmap.
+    Xapian::doccount count = 0;
+
+    /// The last docid added.
+    Xapian::docid last_did = 0;
+
+  public:
+    DocIdBitmap() { }
+
+    /** Add a docid.
+     *
+     *  @param did  The docid to add, which must be greater than any docid
+     *		    previously added.
+     */
+    void add(Xapian::docid did);
+
+    /// Return the number of docids in the bitmap.
+    Xapian::doccount size() const { return count; }
+
+    /// Return the lowest docid in the bitmap (or 0 if it's empty).
+    Xapian::docid get_first() const;
+
+    /// Return the highest docid in the bitmap (or 0 if it's empty).
+    Xapian::docid get_last() const { return last_did; }
+
+    /// Return the approximate number of bytes of memory used.
+    size_t get_memory_used() const;
+
+    /** Return an upper bound on get_memory_used() for a bitmap.
+     *
+     *  @param n	Upper bound on the number of docids in the bitmap.
+     *  @param last	Upper bound on the docids in the bitmap.
+     */
+    static size_t max_memory_used(Xapian::doccount n, Xapian::docid last);
+
+    /** Find the first docid >= @a did.
+     *
+     *  @param[in,out] chunk  Index of the chunk to start searching from,
+     *			      which is updated to the chunk the result is in
+     *			      (so it can be passed again for a subsequent
+     *			      call with a larger @a did).  Pass 0 initially.
+     *  @param did	      The docid to search from.
+     *
+     *  @return  The docid found, or 0 if there are no docids >= @a did.
+     */
+    Xapian::docid lower_bound(size_t& chunk, Xapian::docid did) const;
+};
+
+#endif // XAPIAN_INCLUDED_DOCIDBITMAP_H
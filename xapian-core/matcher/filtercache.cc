@@ -0,0 +1,78 @@
+/** @file
+ * @brief LRU cache of bitmaps for boolean filter subqueries
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <config.h>
+
+#include "filtercache.h"
+
+#include "omassert.h"
+
+using namespace std;
+
+void
+FilterCache::evict(size_t limit)
+{
+    while (used_bytes > limit) {
+	Assert(!lru.empty());
+	Entry& victim = lru.back();
+	used_bytes -= victim.bytes;
+	index.erase(victim.key);
+	lru.pop_back();
+    }
+}
+
+void
+FilterCache::set_max_size(size_t max_bytes_)
+{
+    max_bytes = max_bytes_;
+    evict(max_bytes);
+}
+
+void
+FilterCache::clear()
+{
+    index.clear();
+    lru.clear();
+    used_bytes = 0;
+}
+
+const DocIdBitmap*
+FilterCache::find(const string& key, Xapian::rev rev)
+{
+    check_revision(rev);
+    auto i = index.find(key);
+    if (i == index.end()) return NULL;
+    // Move the entry to the front of the LRU list.
+    lru.splice(lru.begin(), lru, i->second);
+    return i->second->bitmap.get();
+}
+
+void
+FilterCache::insert(string&& key, Xapian::rev rev, const DocIdBitmap* bitmap)
+{
+    check_revision(rev);
+    size_t bytes = entry_size(key.size(), bitmap->get_memory_used());
+    if (!fits(bytes)) return;
+    if (index.find(key) != index.end()) return;
+    evict(max_bytes - bytes);
+    lru.emplace_front(std::move(key), bitmap, bytes);
+    index.emplace(lru.front().key, lru.begin());
+    used_bytes += bytes;
+}
@@ -0,0 +1,132 @@
+/** @file
+ * @brief LRU cache of bitmaps for boolean filter subqueries
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef XAPIAN_INCLUDED_FILTERCACHE_H
+#define XAPIAN_INCLUDED_FILTERCACHE_H
+
+#include "docidbitmap.h"
+#include "xapian/types.h"
+
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/** LRU cache of bitmaps for boolean filter subqueries.
+ *
+ *  There's one of these per shard.  Entries are keyed by the serialised
+ *  subquery, and are only valid for the revision of the shard they were
+ *  built from - if the revision changes, the whole cache is discarded.
+ *
+ *  The total size of the cached bitmaps is kept within a specified number of
+ *  bytes by discarding the least recently used entries.
+ */
+class FilterCache {
+    /// Don't allow assignment.
+    void operator=(const FilterCache&) = delete;
+
+    /// Don't allow copying.
+    FilterCache(const FilterCache&) = delete;
+
+    struct Entry {
+	/// The serialised subquery.
+	std::string key;
+
+	/// The bitmap for the subquery.
+	Xapian::Internal::intrusive_ptr<const DocIdBitmap> bitmap;
+
+	/// The number of bytes this entry is counted as using.
+	size_t bytes;
+
+	Entry(std::string&& key_, const DocIdBitmap* bitmap_, size_t bytes_)
+	    : key(std::move(key_)), bitmap(bitmap_), bytes(bytes_) { }
+    };
+
+    /// The entries, most recently used first.
+    std::list<Entry> lru;
+
+    /// Index of the entries by key (which point into the Entry objects).
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index;
+
+    /// The revision the cached entries are for.
+    Xapian::rev revision = 0;
+
+    /// Maximum number of bytes to use.
+    size_t max_bytes;
+
+    /// Number of bytes currently used.
+    size_t used_bytes = 0;
+
+    /// Discard entries until at most @a limit bytes are used.
+    void evict(size_t limit);
+
+    /// Discard all entries if @a rev isn't the revision they're for.
+    void check_revision(Xapian::rev rev) {
+	if (rev != revision) {
+	    clear();
+	    revision = rev;
+	}
+    }
+
+  public:
+    explicit FilterCache(size_t max_bytes_) : max_bytes(max_bytes_) { }
+
+    /** Return the number of bytes an entry is counted as using.
+     *
+     *  @param key_size	    The size of the serialised subquery.
+     *  @param bitmap_bytes The memory used by the bitmap.
+     */
+    static size_t entry_size(size_t key_size, size_t bitmap_bytes) {
+	// Allow for the key and the per-entry overheads of the list and the
+	// hash table as well as the bitmap itself.
+	return bitmap_bytes + key_size + 128;
+    }
+
+    /// Could an entry using @a bytes be added?
+    bool fits(size_t bytes) const { return bytes <= max_bytes; }
+
+    /// Set the maximum number of bytes to use.
+    void set_max_size(size_t max_bytes_);
+
+    /// Discard all entries.
+    void clear();
+
+    /** Look up the bitmap for a subquery.
+     *
+     *  @param key	The serialised subquery.
+     *  @param rev	The current revision of the shard.
+     *
+     *  @return The cached bitmap, or NULL if there isn't one.
+     */
+    const DocIdBitmap* find(const std::string& key, Xapian::rev rev);
+
+    /** Add the bitmap for a subquery.
+     *
+     *  If @a bitmap is too large to fit in the cache at all then it isn't
+     *  added.
+     *
+     *  @param key	The serialised subquery.
+     *  @param rev	The revision of the shard @a bitmap was built from.
+     *  @param bitmap	The bitmap.
+     */
+    void insert(std::string&& key, Xapian::rev rev, const DocIdBitmap* bitmap);
+};
+
+#endif // XAPIAN_INCLUDED_FILTERCACHE_H
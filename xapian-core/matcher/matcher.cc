@@ -35,6 +35,7 @@
 #include "spymaster.h"
 #include "valuestreamdocument.h"
 #include "weight/weightinternal.h"
+#include "xapian/matchvisitor.h"
 
 #include <xapian/version.h> // For XAPIAN_HAS_REMOTE_BACKEND
 
@@ -47,6 +48,8 @@
 #include <algorithm>
 #include <cerrno>
 #include <cfloat> // For DBL_EPSILON.
+#include <functional>
+#include <queue>
 #include <vector>
 
 #ifdef HAVE_POLL_H
@@ -75,6 +78,28 @@ static void unimplemented(const char* msg)
     throw Xapian::UnimplementedError(msg);
 }
 
+/** Convert a cursor docid in the combined database to one for a shard.
+ *
+ *  Items which compare equal apart from the docid are ordered by docid in the
+ *  combined database.  The docids in a shard map monotonically to those, so
+ *  we can find a docid for the shard which compares the same way against all
+ *  the documents in the shard.
+ */
+static Xapian::docid
+shard_cursor_docid(Xapian::docid did,
+		   Xapian::doccount shard,
+		   const ShardDocIdMap& docid_map,
+		   bool sort_forward)
+{
+    if (sort_forward) {
+	// Items after the cursor have a shard docid greater than the number of
+	// documents in the shard which map to a docid <= did.
+	return docid_map.shard_docid_upto(did, shard);
+    }
+    // Items after the cursor have shard docid less than this.
+    return did ? docid_map.shard_docid_upto(did - 1, shard) + 1 : 0;
+}
+
 template<typename Action>
 inline void
 Matcher::for_all_remotes(Action action)
@@ -194,6 +219,7 @@ Matcher::Matcher(const Xapian::Database& db_,
 		 Xapian::Enquire::Internal::sort_setting sort_by,
 		 bool sort_val_reverse,
 		 double time_limit,
+		 bool time_limit_stop,
 		 const vector<opt_intrusive_ptr<Xapian::MatchSpy>>& matchspies)
     : db(db_)
 {
@@ -201,9 +227,14 @@ Matcher::Matcher(const Xapian::Database& db_,
     Assert(!query.empty());
 
     Xapian::doccount n_shards = db.internal->size();
+    if (n_shards > 1) {
+	auto multidb = static_cast<const MultiDatabase*>(db.internal.get());
+	docid_map = multidb->get_docid_map();
+    }
+
     vector<Xapian::RSet> subrsets;
     if (rset && rset->internal) {
-	rset->internal->shard(n_shards, subrsets);
+	rset->internal->shard(docid_map, subrsets);
     } else {
 	subrsets.resize(n_shards);
     }
@@ -225,7 +256,7 @@ Matcher::Matcher(const Xapian::Database& db_,
 	    as_rem->set_query(query, query_length,
 			      collapse_key, collapse_max,
 			      order, sort_key, sort_by, sort_val_reverse,
-			      time_limit,
+			      time_limit, time_limit_stop,
 			      n_shards == 1 ? percent_threshold : 0,
 			      weight_threshold,
 			      wtscheme,
@@ -245,6 +276,7 @@ Matcher::Matcher(const Xapian::Database& db_,
 	(void)sort_by;
 	(void)sort_val_reverse;
 	(void)time_limit;
+	(void)time_limit_stop;
 	(void)matchspies;
 #endif /* XAPIAN_HAS_REMOTE_BACKEND */
 	if (locals.size() != i)
@@ -354,6 +386,8 @@ Matcher::get_local_mset(Xapian::doccount first,
 			Xapian::Enquire::Internal::sort_setting sort_by,
 			bool sort_val_reverse,
 			double time_limit,
+			bool time_limit_stop,
+			const Result* after,
 			const vector<opt_ptr_spy>& matchspies)
 {
     Assert(!locals.empty());
@@ -479,10 +513,24 @@ Matcher::get_local_mset(Xapian::doccount first,
     bool sort_forward = (order != Xapian::Enquire::DESCENDING);
     auto mcmp = get_msetcmp_function(sort_by, sort_forward, sort_val_reverse);
 
-    // Can we stop once the ProtoMSet is full?
-    bool stop_once_full = (sort_forward &&
-			   n_shards == 1 &&
-			   sort_by == DOCID);
+    // Can we stop once the ProtoMSet is full?  We can if documents are
+    // considered in the order they're ranked in, which is the case when
+    // sorting by ascending docid, or when sorting by just a value (with
+    // ascending docid as the tie-breaker) if the documents are stored in
+    // order of that value.
+    bool stop_once_full = false;
+    if (sort_forward && n_shards == 1) {
+	if (sort_by == DOCID) {
+	    stop_once_full = true;
+	} else if (sort_by == VAL && !sorter && percent_threshold == 0) {
+	    Xapian::valueno order_slot;
+	    bool order_reverse;
+	    if (db.internal->get_value_order(order_slot, order_reverse)) {
+		stop_once_full = (order_slot == sort_key &&
+				  order_reverse == sort_val_reverse);
+	    }
+	}
+    }
 
     ProtoMSet proto_mset(first, maxitems, check_at_least,
 			 mcmp, sort_by, total_subqs,
@@ -491,10 +539,16 @@ Matcher::get_local_mset(Xapian::doccount first,
 			 percent_threshold, percent_threshold_factor,
 			 max_possible,
 			 stop_once_full,
-			 time_limit);
+			 time_limit,
+			 time_limit_stop,
+			 after);
     proto_mset.set_new_min_weight(weight_threshold);
 
     while (true) {
+	if (proto_mset.out_of_time()) {
+	    break;
+	}
+
 	double min_weight = proto_mset.get_min_weight();
 	if (!pltree.next(min_weight)) {
 	    break;
@@ -531,6 +585,10 @@ Matcher::get_local_mset(Xapian::doccount first,
 		continue;
 	}
 
+	if (proto_mset.before_cursor(new_item, calculated_weight, spymaster,
+				     doc))
+	    continue;
+
 	// Apply any MatchSpy objects.
 	if (spymaster) {
 	    if (!calculated_weight) {
@@ -575,6 +633,8 @@ Matcher::get_mset(Xapian::doccount first,
 		  Xapian::Enquire::Internal::sort_setting sort_by,
 		  bool sort_val_reverse,
 		  double time_limit,
+		  bool time_limit_stop,
+		  const Result* after,
 		  const vector<opt_intrusive_ptr<Xapian::MatchSpy>>& matchspies)
 {
     AssertRel(check_at_least, >=, first + maxitems);
@@ -583,8 +643,8 @@ Matcher::get_mset(Xapian::doccount first,
     if (locals.empty() && remotes.size() == 1) {
 	// Short cut for a single remote database.
 	Assert(remotes[0]);
-	remotes[0]->start_match(first, maxitems, check_at_least, sorter,
-				stats);
+	remotes[0]->start_match(first, maxitems, check_at_least, after,
+				sorter, stats);
 	return remotes[0]->get_mset(matchspies);
     }
 #endif
@@ -596,6 +656,8 @@ Matcher::get_mset(Xapian::doccount first,
     // precision on x86.
     percent_threshold_factor -= DBL_EPSILON;
 
+    bool sort_forward = (order != Xapian::Enquire::DESCENDING);
+
 #ifdef XAPIAN_HAS_REMOTE_BACKEND
     for (auto&& submatch : remotes) {
 	Assert(submatch);
@@ -609,8 +671,19 @@ Matcher::get_mset(Xapian::doccount first,
 	    AssertRel(check_at_least, >=, first + maxitems);
 	    remote_maxitems = check_at_least;
 	}
-	submatch->start_match(0, remote_maxitems, check_at_least, sorter,
-			      stats);
+	if (after) {
+	    Result shard_after(after->get_weight(),
+			       shard_cursor_docid(after->get_docid(),
+						  submatch->get_shard(),
+						  docid_map,
+						  sort_forward));
+	    shard_after.set_sort_key(after->get_sort_key());
+	    submatch->start_match(0, remote_maxitems, check_at_least,
+				  &shard_after, sorter, stats);
+	    continue;
+	}
+	submatch->start_match(0, remote_maxitems, check_at_least, NULL,
+			      sorter, stats);
     }
 #endif
 
@@ -648,7 +721,8 @@ Matcher::get_mset(Xapian::doccount first,
 				    percent_threshold,
 				    local_percent_threshold_factor,
 				    weight_threshold, order, sort_key, sort_by,
-				    sort_val_reverse, time_limit, matchspies);
+				    sort_val_reverse, time_limit,
+				    time_limit_stop, after, matchspies);
     }
 
 #ifdef XAPIAN_HAS_REMOTE_BACKEND
@@ -677,7 +751,7 @@ Matcher::get_mset(Xapian::doccount first,
 		return;
 	    }
 	    remote_mset.internal->unshard_docids(submatch->get_shard(),
-						 db.internal->size());
+						 docid_map);
 	    msets.push_back({remote_mset, 0});
 	});
 
@@ -704,7 +778,6 @@ Matcher::get_mset(Xapian::doccount first,
 	percent_threshold_factor = 0.0;
     }
 
-    bool sort_forward = (order != Xapian::Enquire::DESCENDING);
     auto mcmp = get_msetcmp_function(sort_by, sort_forward, sort_val_reverse);
     auto heap_cmp =
 	[&](const pair<Xapian::MSet, Xapian::doccount>& a,
@@ -838,3 +911,117 @@ Matcher::get_mset(Xapian::doccount first,
     return local_mset;
 #endif
 }
+
+bool
+Matcher::has_remote_shards(const Xapian::Database& db)
+{
+#ifdef XAPIAN_HAS_REMOTE_BACKEND
+    Xapian::doccount n_shards = db.internal->size();
+    for (Xapian::doccount i = 0; i != n_shards; ++i) {
+	const Xapian::Database::Internal* subdb = db.internal.get();
+	if (n_shards > 1) {
+	    auto multidb = static_cast<const MultiDatabase*>(subdb);
+	    subdb = multidb->shards[i];
+	}
+	if (subdb->get_backend_info(NULL) == BACKEND_REMOTE)
+	    return true;
+    }
+#else
+    (void)db;
+#endif
+    return false;
+}
+
+Xapian::doccount
+Matcher::visit_matches(Xapian::Weight::Internal& stats,
+		       const Xapian::Weight& wtscheme,
+		       Xapian::MatchVisitor* visitor)
+{
+#ifdef XAPIAN_HAS_REMOTE_BACKEND
+    Assert(remotes.empty());
+#endif
+    if (locals.empty())
+	return 0;
+
+    for (auto&& submatch : locals) {
+	if (submatch)
+	    submatch->start_match(stats);
+    }
+
+    ValueStreamDocument vsdoc(db);
+    ++vsdoc._refs;
+
+    vector<PostList*> postlists;
+    postlists.reserve(locals.size());
+    PostListTree pltree(vsdoc, db, wtscheme);
+    try {
+	bool all_null = true;
+	for (size_t i = 0; i != locals.size(); ++i) {
+	    if (!locals[i]) {
+		postlists.push_back(NULL);
+		continue;
+	    }
+	    Xapian::termcount total_subqs_i = 0;
+	    PostList* pl = locals[i]->get_postlist(&pltree, &total_subqs_i);
+	    if (pl != NULL)
+		all_null = false;
+	    postlists.push_back(pl);
+	}
+
+	if (all_null)
+	    return 0;
+    } catch (...) {
+	for (auto pl : postlists) delete pl;
+	throw;
+    }
+
+    pltree.set_postlists(&postlists[0], postlists.size());
+
+    // If all the weights are zero (which is always the case if weights
+    // weren't asked for) we can skip calculating them.
+    bool calc_weights = (pltree.recalc_maxweight() != 0.0);
+
+    // There's no candidate set, so no minimum weight to pass to next().
+    Xapian::doccount count = 0;
+    if (!visitor) {
+	while (pltree.next(0.0))
+	    ++count;
+	return count;
+    }
+
+    size_t n_shards = postlists.size() - std::count(postlists.begin(),
+						    postlists.end(), nullptr);
+    if (n_shards == 1) {
+	while (pltree.next(0.0)) {
+	    double weight = calc_weights ? pltree.get_weight() : 0.0;
+	    ++count;
+	    if (!(*visitor)(pltree.get_docid(), weight))
+		break;
+	}
+	return count;
+    }
+
+    // Advance the shards in step so the documents are visited in ascending
+    // order of combined docid.
+    typedef pair<Xapian::docid, Xapian::doccount> item;
+    priority_queue<item, vector<item>, greater<item>> queue;
+    for (Xapian::doccount i = 0; i != postlists.size(); ++i) {
+	if (!postlists[i]) continue;
+	pltree.set_current_shard(i);
+	if (pltree.next_in_shard())
+	    queue.emplace(pltree.get_docid(), i);
+    }
+    while (!queue.empty()) {
+	auto [did, shard] = queue.top();
+	queue.pop();
+	pltree.set_current_shard(shard);
+	double weight = calc_weights ? pltree.get_weight() : 0.0;
+	++count;
+	if (!(*visitor)(did, weight))
+	    break;
+	if (pltree.next_in_shard())
+	    queue.emplace(pltree.get_docid(), shard);
+    }
+
+    return count;
+}
@@ -26,6 +26,7 @@
 #endif
 
 #include "api/enquireinternal.h"
+#include "backends/multi.h"
 #include "localsubmatch.h"
 #include "remotesubmatch.h"
 #include "weight/weightinternal.h"
@@ -35,9 +36,12 @@
 #include <memory>
 #include <vector>
 
+class Result;
+
 namespace Xapian {
     class KeyMaker;
     class MatchDecider;
+    class MatchVisitor;
     class MSet;
     class Query;
     class Weight;
@@ -48,6 +52,9 @@ class Matcher {
 
     Xapian::Database db;
 
+    /// Mapping between the docids of the shards and the combined docids.
+    ShardDocIdMap docid_map;
+
     /** LocalSubMatch objects for local databases.
      *
      *  The entries are at the same index as the corresponding shard in the
@@ -107,6 +114,8 @@ class Matcher {
 				Xapian::Enquire::Internal::sort_setting sort_by,
 				bool sort_val_reverse,
 				double time_limit,
+				bool time_limit_stop,
+				const Result* after,
 				const std::vector<opt_ptr_spy>& matchspies);
 
     /// Perform action on remotes as they become ready using poll() or select().
@@ -134,6 +143,7 @@ class Matcher {
      *  @param sort_val_reverse	Reverse direction keys sort in?
      *  @param time_limit	time in seconds after which to disable
      *				check_at_least (0.0 means don't).
+     *  @param time_limit_stop	Stop the match when @a time_limit is reached?
      *  @param matchspies	MatchSpy objects to use
      */
     Matcher(const Xapian::Database& db_,
@@ -152,6 +162,7 @@ class Matcher {
 	    Xapian::Enquire::Internal::sort_setting sort_by,
 	    bool sort_val_reverse,
 	    double time_limit,
+	    bool time_limit_stop,
 	    const std::vector<opt_ptr_spy>& matchspies);
 
     /** Run the match and produce an MSet object.
@@ -188,6 +199,9 @@ class Matcher {
      *  @param sort_val_reverse	Reverse direction keys sort in?
      *  @param time_limit	time in seconds after which to disable
      *				check_at_least (0.0 means don't).
+     *  @param time_limit_stop	Stop the match when @a time_limit is reached?
+     *  @param after		Only return items ranked after this one (NULL
+     *				for no cursor)
      *  @param matchspies	MatchSpy objects to use
      */
     Xapian::MSet get_mset(Xapian::doccount first,
@@ -206,7 +220,27 @@ class Matcher {
 			  Xapian::Enquire::Internal::sort_setting sort_by,
 			  bool sort_val_reverse,
 			  double time_limit,
+			  bool time_limit_stop,
+			  const Result* after,
 			  const std::vector<opt_ptr_spy>& matchspies);
+
+    /// Does @a db include any remote shards?
+    static bool has_remote_shards(const Xapian::Database& db);
+
+    /** Pass every matching document to a visitor.
+     *
+     *  Only supported for local shards.
+     *
+     *  @param stats		Object to collate stats into
+     *  @param wtscheme		Weighting scheme
+     *  @param visitor		MatchVisitor to call for each match (NULL to
+     *				just count the matches)
+     *
+     *  @return The number of documents passed to @a visitor.
+     */
+    Xapian::doccount visit_matches(Xapian::Weight::Internal& stats,
+				   const Xapian::Weight& wtscheme,
+				   Xapian::MatchVisitor* visitor);
 };
 
 #endif // XAPIAN_INCLUDED_MATCHER_H
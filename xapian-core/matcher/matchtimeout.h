@@ -26,52 +26,46 @@
 # error config.h must be included first in each C++ source file
 #endif
 
-#ifdef HAVE_TIMER_CREATE
-#include "realtime.h"
-
-#include <signal.h>
-#include <time.h>
-#include "safeunistd.h" // For _POSIX_* feature test macros.
-
-extern "C" {
-
-static void
-set_timeout_flag(union sigval sv)
-{
-    *(reinterpret_cast<volatile bool*>(sv.sival_ptr)) = true;
-}
-
-}
-
-// The monotonic clock is the better basis for timeouts, but not always
-// available.
-
-#ifndef _POSIX_MONOTONIC_CLOCK
-const clockid_t TIMEOUT_CLOCK = CLOCK_REALTIME;
-#elif defined __sun
-// Solaris defines CLOCK_MONOTONIC, but "man timer_create" doesn't mention it
-// and when using it timer_create() fails with "EPERM" (perhaps you need to be
-// root to use it?  I can't test that).
-//
-// Solaris defines _POSIX_MONOTONIC_CLOCK so we need to special case.
-const clockid_t TIMEOUT_CLOCK = CLOCK_REALTIME;
-#elif defined __CYGWIN__
-// https://cygwin.com/cygwin-api/std-notes.html currently (2023-04-18) says:
-//
-//     clock_nanosleep currently supports only CLOCK_REALTIME and
-//     CLOCK_MONOTONIC.  clock_setres, clock_settime, and timer_create
-//     currently support only CLOCK_REALTIME.
-//
-// So CLOCK_MONOTONIC is defined, but not supported by timer_create().
-const clockid_t TIMEOUT_CLOCK = CLOCK_REALTIME;
-#else
-const clockid_t TIMEOUT_CLOCK = CLOCK_MONOTONIC;
-#endif
+#include <chrono>
 
+/** Cooperative match time limit.
+ *
+ *  We used to use a POSIX interval timer to set a flag asynchronously, but
+ *  that costs a kernel timer and two system calls per search, and isn't
+ *  available on all platforms.  Instead the matcher polls timed_out(), which
+ *  only actually reads the clock every check_interval calls.  The interval
+ *  adapts so that we read the clock roughly every TARGET_CHECK_PERIOD - when
+ *  each candidate is cheap to process we double the interval (up to
+ *  MAX_CHECK_INTERVAL), and when candidates are slow to process we halve it
+ *  (down to 1), so an expensive PostingSource or MatchDecider can't make us
+ *  overshoot the limit by many candidates.
+ *
+ *  std::chrono::steady_clock is monotonic, and on the common platforms is
+ *  read without a system call (e.g. via the vDSO on Linux).
+ */
 class TimeOut {
-    struct sigevent sev;
-    timer_t timerid;
-    volatile bool expired = false;
+    typedef std::chrono::steady_clock clock;
+
+    /// Aim to read the clock about this often.
+    static constexpr std::chrono::microseconds TARGET_CHECK_PERIOD{100};
+
+    /// Upper bound on how many calls to timed_out() we make between checks.
+    static constexpr unsigned MAX_CHECK_INTERVAL = 1024;
+
+    clock::time_point end_time;
+
+    clock::time_point last_check;
+
+    /// Number of calls between reads of the clock.
+    unsigned check_interval = 1;
+
+    /** Number of calls until we next read the clock.
+     *
+     *  Zero if there's no time limit, or if it's already expired.
+     */
+    unsigned countdown = 0;
+
+    bool expired = false;
 
     TimeOut(const TimeOut&) = delete;
 
@@ -80,41 +74,38 @@ class TimeOut {
   public:
     explicit TimeOut(double limit) {
 	if (limit > 0) {
-	    sev.sigev_notify = SIGEV_THREAD;
-	    sev.sigev_notify_function = set_timeout_flag;
-	    sev.sigev_notify_attributes = NULL;
-	    sev.sigev_value.sival_ptr =
-		static_cast<void*>(const_cast<bool*>(&expired));
-	    if (usual(timer_create(TIMEOUT_CLOCK, &sev, &timerid) == 0)) {
-		struct itimerspec interval;
-		interval.it_interval.tv_sec = 0;
-		interval.it_interval.tv_nsec = 0;
-		RealTime::to_timespec(limit, &interval.it_value);
-		if (usual(timer_settime(timerid, 0, &interval, NULL) == 0)) {
-		    // Timeout successfully set.
-		    return;
-		}
-		timer_delete(timerid);
-	    }
+	    last_check = clock::now();
+	    end_time = last_check +
+		std::chrono::duration_cast<clock::duration>(
+		    std::chrono::duration<double>(limit));
+	    countdown = 1;
 	}
-	sev.sigev_notify = SIGEV_NONE;
     }
 
-    ~TimeOut() {
-	if (sev.sigev_notify != SIGEV_NONE) {
-	    timer_delete(timerid);
-	    sev.sigev_notify = SIGEV_NONE;
+    /** Has the time limit been reached?
+     *
+     *  Cheap enough to call for every candidate document.
+     */
+    bool timed_out() {
+	if (usual(countdown == 0 || --countdown != 0)) {
+	    return expired;
 	}
-    }
 
-    bool timed_out() const { return expired; }
-};
-#else
-class TimeOut {
-  public:
-    explicit TimeOut(double) { }
-    bool timed_out() const { return false; }
+	auto now = clock::now();
+	if (now >= end_time) {
+	    expired = true;
+	    return true;
+	}
+
+	if (now - last_check < TARGET_CHECK_PERIOD) {
+	    if (check_interval < MAX_CHECK_INTERVAL) check_interval *= 2;
+	} else if (check_interval > 1) {
+	    check_interval /= 2;
+	}
+	last_check = now;
+	countdown = check_interval;
+	return false;
+    }
 };
-#endif
 
 #endif // XAPIAN_INCLUDED_MATCHTIMEOUT_H
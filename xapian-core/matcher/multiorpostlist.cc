@@ -0,0 +1,321 @@
+/** @file
+ * @brief N-way OR postlist using the MaxScore algorithm
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <config.h>
+
+#include "multiorpostlist.h"
+
+#include "omassert.h"
+#include "postlisttree.h"
+
+#include <algorithm>
+
+using namespace std;
+
+MultiOrPostList::~MultiOrPostList()
+{
+    for (auto&& kid : kids) {
+	delete kid.pl;
+    }
+}
+
+void
+MultiOrPostList::partition(double w_min)
+{
+    partition_w_min = w_min;
+    n_non_essential = 0;
+    non_essential_max = 0.0;
+    // Always leave at least one essential sub-postlist to drive the
+    // iteration.  If even the sum of all the maximum weights can't reach
+    // w_min, PostListTree will notice and end the match.
+    size_t limit = kids.size() - 1;
+    while (n_non_essential != limit) {
+	double m = non_essential_max + kids[n_non_essential].max_wt;
+	if (m >= w_min) break;
+	non_essential_max = m;
+	++n_non_essential;
+    }
+}
+
+void
+MultiOrPostList::erase_kid(size_t i)
+{
+    delete kids[i].pl;
+    max_total -= kids[i].max_wt;
+    kids.erase(kids.begin() + i);
+    // Recalculate the partition before it's next used.
+    partition_w_min = -1.0;
+    pltree->force_recalc();
+}
+
+PostList*
+MultiOrPostList::prune(Xapian::docid target, double w_min)
+{
+    AssertEq(kids.size(), 1);
+    PostList* result = kids[0].pl;
+    if (kids[0].did < target) {
+	// This sub-postlist may be behind target, or (if the last call on it
+	// was a check() which came back !valid) its position is unspecified.
+	PostList* res = result->skip_to(target, w_min);
+	if (res) {
+	    delete result;
+	    result = res;
+	}
+    }
+    kids.clear();
+    pltree->force_recalc();
+    return result;
+}
+
+PostList*
+MultiOrPostList::advance(Xapian::docid target, double w_min)
+{
+    if (w_min != partition_w_min) partition(w_min);
+    // Work backwards so that erasing a sub-postlist doesn't affect the
+    // indices of those we still need to process.
+    size_t i = kids.size();
+    while (i != n_non_essential) {
+	auto& kid = kids[--i];
+	if (kid.did >= target) continue;
+
+	double kid_w_min = w_min - (max_total - kid.max_wt);
+	PostList* res;
+	// If kid.did is 0 and target is 1 then we haven't started yet, and
+	// need to call next() rather than skip_to().  Otherwise kid.did being
+	// 0 means a check() came back !valid, so target must be larger.
+	if (kid.did == target - 1) {
+	    res = kid.pl->next(kid_w_min);
+	} else {
+	    res = kid.pl->skip_to(target, kid_w_min);
+	}
+	if (res) {
+	    delete kid.pl;
+	    kid.pl = res;
+	}
+
+	if (kid.pl->at_end()) {
+	    erase_kid(i);
+	    if (kids.size() == 1) {
+		return prune(target, w_min);
+	    }
+	    // Removing an essential sub-postlist may leave none, in which case
+	    // the partition will change, so start again.
+	    partition(w_min);
+	    i = kids.size();
+	    continue;
+	}
+
+	kid.did = kid.pl->get_docid();
+    }
+    return NULL;
+}
+
+PostList*
+MultiOrPostList::find_next_match(Xapian::docid target, double w_min)
+{
+    while (true) {
+	// The candidate is the lowest docid any essential sub-postlist is on.
+	Xapian::docid candidate = Xapian::docid(-1);
+	double bound = 0.0;
+	for (size_t i = n_non_essential; i != kids.size(); ++i) {
+	    const auto& kid = kids[i];
+	    if (kid.did < candidate) {
+		candidate = kid.did;
+		bound = kid.max_wt;
+	    } else if (kid.did == candidate) {
+		bound += kid.max_wt;
+	    }
+	}
+	bound += non_essential_max;
+
+	// Check the non-essential sub-postlists, starting with the one with
+	// the highest maximum weight since that's the most likely to allow us
+	// to reject the candidate.  Stop as soon as the candidate can't
+	// achieve w_min.
+	size_t i = n_non_essential;
+	while (i != 0 && bound >= w_min) {
+	    auto& kid = kids[--i];
+	    if (kid.did == candidate) continue;
+	    if (kid.did > candidate) {
+		bound -= kid.max_wt;
+		continue;
+	    }
+
+	    bool valid;
+	    PostList* res = kid.pl->check(candidate,
+					  w_min - (bound - kid.max_wt),
+					  valid);
+	    if (res) {
+		Assert(valid);
+		delete kid.pl;
+		kid.pl = res;
+	    }
+	    if (!valid) {
+		kid.did = 0;
+		bound -= kid.max_wt;
+		continue;
+	    }
+	    if (kid.pl->at_end()) {
+		bound -= kid.max_wt;
+		non_essential_max -= kid.max_wt;
+		erase_kid(i);
+		--n_non_essential;
+		// The essential sub-postlists are unaffected, so the partition
+		// is still valid for the rest of this call.
+		partition_w_min = w_min;
+		if (kids.size() == 1) {
+		    return prune(target, w_min);
+		}
+		continue;
+	    }
+	    kid.did = kid.pl->get_docid();
+	    if (kid.did != candidate) {
+		bound -= kid.max_wt;
+	    }
+	}
+
+	did = candidate;
+	if (bound >= w_min) {
+	    return NULL;
+	}
+
+	// The candidate can't achieve w_min so move on.
+	target = candidate + 1;
+	PostList* result = advance(target, w_min);
+	if (result) return result;
+    }
+}
+
+Xapian::docid
+MultiOrPostList::get_docid() const
+{
+    Assert(did != 0);
+    return did;
+}
+
+double
+MultiOrPostList::get_weight(Xapian::termcount doclen,
+			    Xapian::termcount unique_terms,
+			    Xapian::termcount wdfdocmax) const
+{
+    double result = 0.0;
+    for (auto&& kid : kids) {
+	if (kid.did == did)
+	    result += kid.pl->get_weight(doclen, unique_terms, wdfdocmax);
+    }
+    return result;
+}
+
+bool
+MultiOrPostList::at_end() const
+{
+    // We never need to return true here - if all but one child reaches
+    // at_end(), we prune to leave just that child.  If all children reach
+    // at_end() together, we prune to leave one of them which will then
+    // indicate at_end() for us.
+    return false;
+}
+
+double
+MultiOrPostList::recalc_maxweight()
+{
+    max_total = 0.0;
+    for (auto&& kid : kids) {
+	kid.max_wt = kid.pl->recalc_maxweight();
+	max_total += kid.max_wt;
+    }
+    stable_sort(kids.begin(), kids.end());
+    partition_w_min = -1.0;
+    return max_total;
+}
+
+PostList*
+MultiOrPostList::next(double w_min)
+{
+    PostList* result = advance(did + 1, w_min);
+    if (result) return result;
+    return find_next_match(did + 1, w_min);
+}
+
+PostList*
+MultiOrPostList::skip_to(Xapian::docid did_min, double w_min)
+{
+    if (rare(did_min <= did)) return NULL;
+    PostList* result = advance(did_min, w_min);
+    if (result) return result;
+    return find_next_match(did_min, w_min);
+}
+
+void
+MultiOrPostList::get_docid_range(Xapian::docid& first,
+				 Xapian::docid& last) const
+{
+    kids[0].pl->get_docid_range(first, last);
+    for (size_t i = 1; i != kids.size(); ++i) {
+	Xapian::docid f = 1, l = Xapian::docid(-1);
+	kids[i].pl->get_docid_range(f, l);
+	first = min(first, f);
+	last = max(last, l);
+    }
+}
+
+std::string
+MultiOrPostList::get_description() const
+{
+    string desc = "MultiOrPostList(";
+    desc += kids[0].pl->get_description();
+    for (size_t i = 1; i < kids.size(); ++i) {
+	desc += ", ";
+	desc += kids[i].pl->get_description();
+    }
+    desc += ')';
+    return desc;
+}
+
+Xapian::termcount
+MultiOrPostList::get_wdf() const
+{
+    Xapian::termcount result = 0;
+    for (auto&& kid : kids) {
+	if (kid.did == did)
+	    result += kid.pl->get_wdf();
+    }
+    return result;
+}
+
+Xapian::termcount
+MultiOrPostList::count_matching_subqs() const
+{
+    Xapian::termcount result = 0;
+    for (auto&& kid : kids) {
+	if (kid.did == did)
+	    result += kid.pl->count_matching_subqs();
+    }
+    return result;
+}
+
+void
+MultiOrPostList::gather_position_lists(OrPositionList* orposlist)
+{
+    for (auto&& kid : kids) {
+	if (kid.did == did)
+	    kid.pl->gather_position_lists(orposlist);
+    }
+}
@@ -0,0 +1,169 @@
+/** @file
+ * @brief N-way OR postlist using the MaxScore algorithm
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef XAPIAN_INCLUDED_MULTIORPOSTLIST_H
+#define XAPIAN_INCLUDED_MULTIORPOSTLIST_H
+
+#include "backends/postlist.h"
+
+#include <vector>
+
+class PostListTree;
+
+/** N-way PostList class implementing Query::OP_OR.
+ *
+ *  For a query with many terms, a tree of binary OrPostList objects means
+ *  each posting passes through O(log(n)) virtual method calls.  Instead this
+ *  class uses the MaxScore algorithm: the sub-postlists are kept in ascending
+ *  order of maximum weight, and the longest prefix whose maximum weights sum
+ *  to less than w_min is "non-essential" - a document which only matches
+ *  non-essential sub-postlists can't achieve w_min.  So we only iterate the
+ *  essential sub-postlists to find candidate documents, and only call check()
+ *  on the non-essential sub-postlists for candidates where the essential
+ *  matches leave it possible to reach w_min.
+ *
+ *  As w_min rises during the match, more sub-postlists become non-essential.
+ */
+class MultiOrPostList : public PostList {
+    /// Don't allow assignment.
+    void operator=(const MultiOrPostList&) = delete;
+
+    /// Don't allow copying.
+    MultiOrPostList(const MultiOrPostList&) = delete;
+
+    struct SubPostList {
+	PostList* pl;
+
+	/** The docid this sub-postlist is positioned on.
+	 *
+	 *  Zero if it hasn't started yet or if the last call was a check()
+	 *  which came back !valid.
+	 */
+	Xapian::docid did = 0;
+
+	/// Maximum weight this sub-postlist can return.
+	double max_wt = 0.0;
+
+	explicit SubPostList(PostList* pl_) : pl(pl_) { }
+
+	bool operator<(const SubPostList& o) const {
+	    return max_wt < o.max_wt;
+	}
+    };
+
+    /// The current docid, or zero if we haven't started.
+    Xapian::docid did = 0;
+
+    /// Sub-postlists, in ascending order of maximum weight.
+    std::vector<SubPostList> kids;
+
+    /// The number of non-essential sub-postlists (at the start of kids).
+    size_t n_non_essential = 0;
+
+    /// Sum of the maximum weights of the non-essential sub-postlists.
+    double non_essential_max = 0.0;
+
+    /// Sum of the maximum weights of all the sub-postlists.
+    double max_total = 0.0;
+
+    /** The w_min which the current partition was calculated for.
+     *
+     *  Negative if the partition needs recalculating.
+     */
+    double partition_w_min = -1.0;
+
+    /// Pointer to the matcher object, so we can report pruning.
+    PostListTree* pltree;
+
+    /// Split the sub-postlists into non-essential and essential.
+    void partition(double w_min);
+
+    /// Remove sub-postlist @a i, which has reached its end.
+    void erase_kid(size_t i);
+
+    /** Prune down to the only remaining sub-postlist.
+     *
+     *  The returned PostList is positioned at or after @a target.
+     */
+    PostList* prune(Xapian::docid target, double w_min);
+
+    /// Position all the essential sub-postlists at or after @a target.
+    PostList* advance(Xapian::docid target, double w_min);
+
+    /** Find the first candidate from the essential sub-postlists which
+     *  could achieve @a w_min.
+     *
+     *  The essential sub-postlists must already be positioned at or after
+     *  @a target.
+     */
+    PostList* find_next_match(Xapian::docid target, double w_min);
+
+  public:
+    /** Construct from 2 random-access iterators to a container of PostList*,
+     *  a pointer to the matcher, and the document collection size.
+     */
+    template<class RandomItor>
+    MultiOrPostList(RandomItor pl_begin, RandomItor pl_end,
+		    PostListTree* pltree_, Xapian::doccount db_size)
+	: kids(pl_begin, pl_end), pltree(pltree_)
+    {
+	// We shortcut an empty shard and avoid creating a postlist tree for it.
+	Assert(db_size);
+	AssertRel(kids.size(), >=, 2);
+	// We calculate the estimate assuming independence.  The simplest
+	// way to calculate this seems to be a series of (n - 1) pairwise
+	// calculations, which gives the same answer regardless of the order.
+	double scale = 1.0 / db_size;
+	double P_est = kids[0].pl->get_termfreq() * scale;
+	for (size_t i = 1; i < kids.size(); ++i) {
+	    double P_i = kids[i].pl->get_termfreq() * scale;
+	    P_est += P_i - P_est * P_i;
+	}
+	termfreq = static_cast<Xapian::doccount>(P_est * db_size + 0.5);
+    }
+
+    ~MultiOrPostList();
+
+    Xapian::docid get_docid() const;
+
+    double get_weight(Xapian::termcount doclen,
+		      Xapian::termcount unique_terms,
+		      Xapian::termcount wdfdocmax) const;
+
+    bool at_end() const;
+
+    double recalc_maxweight();
+
+    PostList* next(double w_min);
+
+    PostList* skip_to(Xapian::docid did, double w_min);
+
+    void get_docid_range(Xapian::docid& first, Xapian::docid& last) const;
+
+    std::string get_description() const;
+
+    Xapian::termcount get_wdf() const;
+
+    Xapian::termcount count_matching_subqs() const;
+
+    void gather_position_lists(OrPositionList* orposlist);
+};
+
+#endif // XAPIAN_INCLUDED_MULTIORPOSTLIST_H
@@ -52,6 +52,9 @@ class PostListTree {
     /// The number of shards.
     Xapian::doccount n_shards = 0;
 
+    /// Mapping between the docids of the shards and the combined docids.
+    ShardDocIdMap docid_map;
+
     /** Document proxy used for valuestream caching.
      *
      *  Each time we move to a new shard we must notify this object so it can
@@ -94,6 +97,10 @@ class PostListTree {
     void set_postlists(PostList** pls, Xapian::doccount n_shards_) {
 	shard_pls = pls;
 	n_shards = n_shards_;
+	if (n_shards > 1) {
+	    auto multidb = static_cast<const MultiDatabase*>(db.internal.get());
+	    docid_map = multidb->get_docid_map();
+	}
 	while (shard_pls[current_shard] == NULL) {
 	    ++current_shard;
 	    Assert(current_shard != n_shards);
@@ -127,7 +134,7 @@ class PostListTree {
     }
 
     Xapian::docid get_docid() const {
-	return unshard(pl->get_docid(), current_shard, n_shards);
+	return docid_map.unshard(pl->get_docid(), current_shard);
     }
 
     Xapian::termcount get_doclength(Xapian::docid shard_did) const {
@@ -183,6 +190,35 @@ class PostListTree {
 	}
     }
 
+    /** Make @a shard the current shard.
+     *
+     *  Used to iterate the shards' postlists in step, rather than one after
+     *  the other as next() does.
+     */
+    void set_current_shard(Xapian::doccount shard) {
+	if (shard == current_shard) return;
+	current_shard = shard;
+	pl = shard_pls[shard];
+	auto multidb = static_cast<const MultiDatabase*>(db.internal.get());
+	shard_db = multidb->shards[shard];
+	vsdoc.new_shard(shard);
+    }
+
+    /** Advance the current shard's postlist.
+     *
+     *  Unlike next(), this doesn't move on to the next shard.
+     *
+     *  @return false if the current shard's postlist is at the end.
+     */
+    bool next_in_shard() {
+	PostList* result = pl->next(0.0);
+	if (rare(result)) {
+	    delete pl;
+	    shard_pls[current_shard] = pl = result;
+	}
+	return !pl->at_end();
+    }
+
     void get_doc_stats(Xapian::docid shard_did,
 		       Xapian::termcount& doclen,
 		       Xapian::termcount& unique_terms,
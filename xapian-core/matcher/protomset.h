@@ -126,8 +126,24 @@ class ProtoMSet {
 
     bool stop_once_full;
 
+    /// Stop the match entirely once the time limit is reached?
+    bool stop_on_timeout;
+
+    /// Set once the match has been stopped because it ran out of time.
+    bool stopped_early = false;
+
     TimeOut timeout;
 
+    /** The last item of the previous page when paginating with a cursor.
+     *
+     *  Only items which rank strictly after this are kept.  NULL if there's
+     *  no cursor.
+     */
+    const Result* after;
+
+    /// The number of matching items skipped because of @a after.
+    Xapian::doccount skipped_by_cursor = 0;
+
     Xapian::doccount size() const { return Xapian::doccount(results.size()); }
 
   public:
@@ -144,7 +160,9 @@ class ProtoMSet {
 	      double percent_threshold_factor_,
 	      double max_possible_,
 	      bool stop_once_full_,
-	      double time_limit)
+	      double time_limit,
+	      bool stop_on_timeout_,
+	      const Result* after_)
 	: max_size(first_ + max_items),
 	  check_at_least(check_at_least_),
 	  sort_by(sort_by_),
@@ -157,7 +175,9 @@ class ProtoMSet {
 	  collapser(collapse_key, collapse_max, results, mcmp),
 	  max_possible(max_possible_),
 	  stop_once_full(stop_once_full_),
-	  timeout(time_limit)
+	  stop_on_timeout(stop_on_timeout_),
+	  timeout(time_limit),
+	  after(after_)
     {
 	results.reserve(max_size);
     }
@@ -194,6 +214,21 @@ class ProtoMSet {
 	return false;
     }
 
+    /** Should the match stop now because the time limit has been reached?
+     *
+     *  Only ever true if we were asked to stop the match on timeout.
+     */
+    bool out_of_time() {
+	if (!stop_on_timeout || !timeout.timed_out()) {
+	    return false;
+	}
+	stopped_early = true;
+	// Treat what we've seen as enough, so the bounds and estimate get
+	// calculated from the EstimateOp stack below.
+	check_at_least = known_matching_docs;
+	return true;
+    }
+
     /** Resolve a pending min_weight change.
      *
      *  Only called when there's a percentage weight cut-off.
@@ -292,6 +327,28 @@ class ProtoMSet {
 	return false;
     }
 
+    /** Skip new_item if it doesn't rank after the cursor.
+     *
+     *  @return true if new_item should be skipped.
+     */
+    bool before_cursor(const Result& new_item,
+		       bool calculated_weight,
+		       SpyMaster& spymaster,
+		       const Xapian::Document& doc) {
+	if (!after || mcmp(*after, new_item))
+	    return false;
+
+	// The candidate was on an earlier page, but it still counts as a
+	// matching document.
+	++known_matching_docs;
+	++skipped_by_cursor;
+	double weight =
+	    calculated_weight ? new_item.get_weight() : pltree.get_weight();
+	spymaster(doc, weight);
+	update_max_weight(weight);
+	return true;
+    }
+
     /** Process new_item.
      *
      *  Conceptually this is "add new_item", but taking into account
@@ -498,16 +555,17 @@ class ProtoMSet {
 	Xapian::doccount uncollapsed_estimated;
 	Xapian::doccount uncollapsed_upper_bound;
 
-	if (!collapser && (!full() || known_matching_docs < check_at_least)) {
+	if (!collapser && !stopped_early &&
+	    (!full() || known_matching_docs < check_at_least)) {
 	    // Under these conditions we know exactly how many matching docs
 	    // there are for the full match so we don't need to resolve the
 	    // EstimateOp stack.
 	    Xapian::doccount m;
 	    if (!full()) {
 		// We didn't get all the results requested, so we know that
-		// we've got all there are, and the bounds and estimate are
-		// all equal to that number.
-		m = size();
+		// we've got all there are (plus any before the cursor), and
+		// the bounds and estimate are all equal to that number.
+		m = size() + skipped_by_cursor;
 		// And that should equal known_matching_docs, unless a percentage
 		// threshold caused some matches to be excluded.
 		if (!percent_threshold) {
@@ -547,11 +605,11 @@ class ProtoMSet {
 	    uncollapsed_estimated = matches_estimated;
 	    uncollapsed_upper_bound = matches_upper_bound;
 
-	    if (!full()) {
+	    if (!full() && !stopped_early) {
 		// We didn't get all the results requested, so we know that we've
-		// got all there are, and the bounds and estimate are all equal to
-		// that number.
-		matches_lower_bound = size();
+		// got all there are (plus any before the cursor), and the bounds
+		// and estimate are all equal to that number.
+		matches_lower_bound = size() + skipped_by_cursor;
 		matches_estimated = matches_lower_bound;
 		matches_upper_bound = matches_lower_bound;
 
@@ -706,17 +764,19 @@ class ProtoMSet {
 	AssertRel(matches_estimated, <=, uncollapsed_estimated);
 	AssertRel(matches_upper_bound, <=, uncollapsed_upper_bound);
 
-	return Xapian::MSet(new Xapian::MSet::Internal(first,
-						       matches_upper_bound,
-						       matches_lower_bound,
-						       matches_estimated,
-						       uncollapsed_upper_bound,
-						       uncollapsed_lower_bound,
-						       uncollapsed_estimated,
-						       max_possible,
-						       max_weight,
-						       std::move(results),
-						       percent_scale * 100.0));
+	auto mset_internal = new Xapian::MSet::Internal(first,
+							matches_upper_bound,
+							matches_lower_bound,
+							matches_estimated,
+							uncollapsed_upper_bound,
+							uncollapsed_lower_bound,
+							uncollapsed_estimated,
+							max_possible,
+							max_weight,
+							std::move(results),
+							percent_scale * 100.0);
+	mset_internal->set_match_progress(known_matching_docs, stopped_early);
+	return Xapian::MSet(mset_internal);
     }
 };
 
@@ -69,15 +69,19 @@ class RemoteSubMatch {
      *  @param first          The first item in the result set to return.
      *  @param maxitems       The maximum number of items to return.
      *  @param check_at_least The minimum number of items to check.
+     *  @param after	      Only return items ranked after this one (NULL
+     *			      for no cursor).  The docid must be one in this
+     *			      shard's docid space.
      *  @param sorter	      KeyMaker for sort keys (NULL for none).
      *  @param total_stats    The total statistics for the collection.
      */
     void start_match(Xapian::doccount first,
 		     Xapian::doccount maxitems,
 		     Xapian::doccount check_at_least,
+		     const Result* after,
 		     const Xapian::KeyMaker* sorter,
 		     const Xapian::Weight::Internal& total_stats) {
-	db->send_global_stats(first, maxitems, check_at_least, sorter,
+	db->send_global_stats(first, maxitems, check_at_least, after, sorter,
 			      total_stats);
     }
 
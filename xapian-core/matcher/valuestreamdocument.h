@@ -47,6 +47,16 @@ class ValueStreamDocument : public Xapian::Document::Internal {
 
     Xapian::doccount n_shards;
 
+    /// Docid mapping of the MultiDatabase, or NULL for a single shard.
+    const ShardDocIdMap* docid_map = nullptr;
+
+    /** Range of combined docids covered by the shard last looked up.
+     *
+     *  Only used with contiguous docid ranges.  The range is (base, end], so
+     *  the shard docid is did - base.
+     */
+    Xapian::docid base = 0, end = 0;
+
     mutable Xapian::Document::Internal * doc = NULL;
 
     /** Private constructor.
@@ -60,7 +70,24 @@ class ValueStreamDocument : public Xapian::Document::Internal {
 		   static_cast<MultiDatabase*>(db_.internal.get())->shards[0],
 		   0),
 	  db(db_),
-	  n_shards(n_shards_) {}
+	  n_shards(n_shards_) {
+	if (n_shards > 1) {
+	    auto multidb = static_cast<const MultiDatabase*>(db.internal.get());
+	    docid_map = &multidb->get_docid_map();
+	}
+    }
+
+    /// Find the range of combined docids for the shard containing @a did_.
+    void find_shard_range(Xapian::docid did_) {
+	Xapian::doccount shard = docid_map->shard_number(did_);
+	AssertEq(current, shard);
+	base = docid_map->offset(shard);
+	if (shard + 1 < n_shards) {
+	    end = docid_map->offset(shard + 1);
+	} else {
+	    end = Xapian::docid(-1);
+	}
+    }
 
   public:
     explicit ValueStreamDocument(const Xapian::Database& db_)
@@ -79,8 +106,19 @@ class ValueStreamDocument : public Xapian::Document::Internal {
     }
 
     void set_document(Xapian::docid did_) {
-	AssertEq(current, shard_number(did_, n_shards));
-	set_shard_document(shard_docid(did_, n_shards));
+	if (n_shards == 1) {
+	    set_shard_document(did_);
+	    return;
+	}
+	if (!docid_map->is_contiguous()) {
+	    AssertEq(current, shard_number(did_, n_shards));
+	    set_shard_document(shard_docid(did_, n_shards));
+	    return;
+	}
+	// Only search the offsets when did_ is outside the cached range.
+	if (rare(did_ <= base || did_ > end))
+	    find_shard_range(did_);
+	set_shard_document(did_ - base);
     }
 
     // Optimise away the virtual call when the matcher wants to know a value.
@@ -60,7 +60,9 @@
 // 46: pre-1.5.0 Drop unused fields; front-code term names in serialised stats
 // 46.1: pre-1.5.0 MSG_REQUESTDOCUMENT added
 // 47: 1.5.0 Updated Weight::Internal serialisation for db_*_bound
-#define XAPIAN_REMOTE_PROTOCOL_MAJOR_VERSION 47
+// 48: 1.5.0 Option to stop match at time limit; MSet reports match progress
+// 49: 1.5.0 MSG_GETMSET can specify a cursor to return results after
+#define XAPIAN_REMOTE_PROTOCOL_MAJOR_VERSION 49
 #define XAPIAN_REMOTE_PROTOCOL_MINOR_VERSION 0
 
 /** Message types (client -> server).
@@ -554,6 +554,11 @@ RemoteServer::msg_query(const string &message_in)
 
     double time_limit = unserialise_double(&p, p_end);
 
+    bool time_limit_stop;
+    if (!unpack_bool(&p, p_end, &time_limit_stop)) {
+	throw Xapian::NetworkError("bad message (time_limit_stop)");
+    }
+
     int percent_threshold = *p++;
     if (percent_threshold < 0 || percent_threshold > 100) {
 	throw Xapian::NetworkError("bad message (percent_threshold)");
@@ -617,7 +622,7 @@ RemoteServer::msg_query(const string &message_in)
 		    collapse_key, collapse_max,
 		    percent_threshold, weight_threshold,
 		    order, sort_key, sort_by, sort_value_forward, time_limit,
-		    matchspies);
+		    time_limit_stop, matchspies);
 
     send_message(REPLY_STATS, serialise_stats(local_stats));
 
@@ -630,10 +635,26 @@ RemoteServer::msg_query(const string &message_in)
     Xapian::termcount maxitems;
     Xapian::termcount check_at_least;
     string sorter_type;
+    bool have_after;
     if (!unpack_uint(&p, p_end, &first) ||
 	!unpack_uint(&p, p_end, &maxitems) ||
 	!unpack_uint(&p, p_end, &check_at_least) ||
-	!unpack_string(&p, p_end, sorter_type)) {
+	!unpack_bool(&p, p_end, &have_after)) {
+	throw Xapian::NetworkError("Bad MSG_GETMSET");
+    }
+    unique_ptr<Result> after;
+    if (have_after) {
+	double after_weight = unserialise_double(&p, p_end);
+	string after_sort_key;
+	Xapian::docid after_did;
+	if (!unpack_string(&p, p_end, after_sort_key) ||
+	    !unpack_uint(&p, p_end, &after_did)) {
+	    throw Xapian::NetworkError("Bad MSG_GETMSET");
+	}
+	after.reset(new Result(after_weight, after_did));
+	after->set_sort_key(after_sort_key);
+    }
+    if (!unpack_string(&p, p_end, sorter_type)) {
 	throw Xapian::NetworkError("Bad MSG_GETMSET");
     }
     unique_ptr<Xapian::KeyMaker> sorter;
@@ -660,7 +681,8 @@ RemoteServer::msg_query(const string &message_in)
 					 percent_threshold, weight_threshold,
 					 order,
 					 sort_key, sort_by, sort_value_forward,
-					 time_limit, matchspies);
+					 time_limit, time_limit_stop,
+					 after.get(), matchspies);
     // FIXME: The local side already has these stats, except for the maxpart
     // information.
     mset.internal->set_stats(total_stats.release());
@@ -221,6 +221,124 @@ DEFINE_TESTCASE(multidb2, backend && !multi) {
     mset_expect_order(mymset, 2, 3, 4, 10);
 }
 
+// test a multidb with contiguous docid ranges for the shards
+DEFINE_TESTCASE(multidb3, backend && !multi) {
+    const char* names[] = {
+	"apitest_simpledata", "apitest_simpledata2", "apitest_termorder"
+    };
+    vector<Xapian::Database> shards;
+    vector<Xapian::docid> offsets;
+    Xapian::Database db;
+    Xapian::docid offset = 0;
+    for (auto name : names) {
+	shards.push_back(get_database(name));
+	db.add_database(shards.back());
+	offsets.push_back(offset);
+	offset += shards.back().get_lastdocid();
+    }
+    db.set_contiguous_shards();
+    TEST_EQUAL(db.get_lastdocid(), offset);
+
+    for (size_t i = 0; i != shards.size(); ++i) {
+	for (Xapian::docid did = 1; did <= shards[i].get_lastdocid(); ++did) {
+	    Xapian::docid combined_did = offsets[i] + did;
+	    TEST_EQUAL(db.get_document(combined_did).get_data(),
+		       shards[i].get_document(did).get_data());
+	    TEST_EQUAL(db.get_doclength(combined_did),
+		       shards[i].get_doclength(did));
+	}
+    }
+
+    // Check postlists and value streams visit the shards in turn.
+    for (const char* term : { "this", "word", "inmemory", "paragraph" }) {
+	vector<Xapian::docid> expected;
+	for (size_t i = 0; i != shards.size(); ++i) {
+	    for (auto p = shards[i].postlist_begin(term);
+		 p != shards[i].postlist_end(term); ++p) {
+		expected.push_back(offsets[i] + *p);
+	    }
+	}
+	vector<Xapian::docid> actual(db.postlist_begin(term),
+				     db.postlist_end(term));
+	TEST_EQUAL(actual, expected);
+
+	// Check skip_to() to every docid finds the right entry.
+	for (Xapian::docid did = 1; did <= db.get_lastdocid(); ++did) {
+	    auto p = db.postlist_begin(term);
+	    p.skip_to(did);
+	    auto e = lower_bound(expected.begin(), expected.end(), did);
+	    if (e == expected.end()) {
+		TEST(p == db.postlist_end(term));
+	    } else {
+		TEST(p != db.postlist_end(term));
+		TEST_EQUAL(*p, *e);
+	    }
+	}
+    }
+    for (Xapian::valueno slot = 0; slot != 12; ++slot) {
+	vector<pair<Xapian::docid, string>> expected;
+	for (size_t i = 0; i != shards.size(); ++i) {
+	    for (auto v = shards[i].valuestream_begin(slot);
+		 v != shards[i].valuestream_end(slot); ++v) {
+		expected.emplace_back(offsets[i] + v.get_docid(), *v);
+	    }
+	}
+	vector<pair<Xapian::docid, string>> actual;
+	for (auto v = db.valuestream_begin(slot);
+	     v != db.valuestream_end(slot); ++v) {
+	    actual.emplace_back(v.get_docid(), *v);
+	}
+	TEST_EQUAL(actual.size(), expected.size());
+	TEST(actual == expected);
+	if (!expected.empty()) {
+	    auto v = db.valuestream_begin(slot);
+	    v.skip_to(expected.back().first);
+	    TEST(v != db.valuestream_end(slot));
+	    TEST_EQUAL(v.get_docid(), expected.back().first);
+	}
+    }
+
+    // Check matching gives the same docids as the postlists.
+    Xapian::Enquire enquire(db);
+    enquire.set_weighting_scheme(Xapian::BoolWeight());
+    enquire.set_query(Xapian::Query("this"));
+    Xapian::MSet mset = enquire.get_mset(0, 100);
+    vector<Xapian::docid> matched(mset.begin(), mset.end());
+    vector<Xapian::docid> expected(db.postlist_begin("this"),
+				   db.postlist_end("this"));
+    TEST_EQUAL(matched, expected);
+
+    // And with relevance ranking, check the documents are the same as those
+    // from the corresponding shard.
+    enquire.set_weighting_scheme(Xapian::BM25Weight());
+    mset = enquire.get_mset(0, 100);
+    TEST_EQUAL(mset.size(), expected.size());
+    for (auto m = mset.begin(); m != mset.end(); ++m) {
+	size_t i = upper_bound(offsets.begin(), offsets.end(), *m - 1) -
+		   offsets.begin() - 1;
+	TEST_EQUAL(m.get_document().get_data(),
+		   shards[i].get_document(*m - offsets[i]).get_data());
+    }
+
+    // Check sorting by value, which reads the values via the matcher's
+    // document proxy.
+    enquire.set_sort_by_value(1, false);
+    mset = enquire.get_mset(0, 100);
+    TEST_EQUAL(mset.size(), expected.size());
+    string prev;
+    for (auto m = mset.begin(); m != mset.end(); ++m) {
+	string value = m.get_document().get_value(1);
+	TEST_EQUAL(m.get_sort_key(), value);
+	TEST_REL(prev, <=, value);
+	prev = value;
+    }
+
+    // Check switching back to interleaved docids.
+    db.set_contiguous_shards(false);
+    TEST_EQUAL(db.get_document(2).get_data(),
+	       shards[1].get_document(1).get_data());
+}
+
 // tests that when specifying maxitems to get_mset, no more than
 // that are returned.
 DEFINE_TESTCASE(msetmaxitems1, backend) {
@@ -25,6 +25,8 @@
 
 #include <xapian.h>
 
+#include <cmath>
+
 #include "apitest.h"
 #include "testsuite.h"
 #include "testutils.h"
@@ -131,6 +133,9 @@ DEFINE_TESTCASE(cosine_distance1, backend)
     distance = d.similarity(x1, x2);
     TEST_REL(distance, >, 0);
     TEST_REL(distance, <=, 1);
+
+    // Check the distance is symmetric.
+    TEST_REL(std::fabs(d.similarity(x2, x1) - distance), <, 1e-12);
 }
 
 /** Round Robin Test
@@ -153,6 +158,40 @@ DEFINE_TESTCASE(round_robin1, backend)
     }
 }
 
+/** KMeans Test
+ *  Test that every document is in a cluster, and that each document is in
+ *  the cluster with the closest centroid.
+ */
+DEFINE_TESTCASE(kmeans1, backend)
+{
+    Xapian::Database db = get_database("stemmed_cluster", make_stemmed_cluster_db);
+    Xapian::Enquire enq(db);
+    enq.set_query(Xapian::Query("cluster"));
+    Xapian::MSet matches = enq.get_mset(0, 4);
+
+    unsigned num_clusters = 2;
+    Xapian::KMeans kmeans(num_clusters);
+    Xapian::ClusterSet cset = kmeans.cluster(matches);
+    TEST_EQUAL(cset.size(), num_clusters);
+
+    Xapian::CosineDistance d;
+    Xapian::doccount total = 0;
+    for (unsigned c = 0; c < cset.size(); ++c) {
+	const Xapian::Cluster& cluster = cset[c];
+	for (Xapian::doccount i = 0; i < cluster.size(); ++i) {
+	    const Xapian::Point& point = cluster[i];
+	    ++total;
+	    double dist = d.similarity(point, cluster.get_centroid());
+	    for (unsigned other = 0; other < cset.size(); ++other) {
+		double other_dist = d.similarity(point,
+						 cset[other].get_centroid());
+		TEST_REL(dist, <=, other_dist + 1e-9);
+	    }
+	}
+    }
+    TEST_EQUAL(total, matches.size());
+}
+
 DEFINE_TESTCASE(stem_stopper1, !backend)
 {
     Xapian::Stem stemmer("english");
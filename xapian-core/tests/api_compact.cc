@@ -35,8 +35,10 @@
 #include "testutils.h"
 
 #include <cerrno>
+#include <cmath>
 #include <cstdlib>
 #include <fstream>
+#include <map>
 
 #include <sys/types.h>
 #include "safesysstat.h"
@@ -587,6 +589,468 @@ DEFINE_TESTCASE(compactmultipass1, compact) {
     dbcheck(outdb, 29, 1041);
 }
 
+/// Return docid -> weight for the matches of @a query against @a db.
+static map<Xapian::docid, double>
+impact_weights(const Xapian::Database& db, const Xapian::Query& query)
+{
+    Xapian::Enquire enq(db);
+    enq.set_query(query);
+    Xapian::MSet mset = enq.get_mset(0, db.get_doccount());
+    map<Xapian::docid, double> result;
+    for (auto i = mset.begin(); i != mset.end(); ++i) {
+	result[*i] = i.get_weight();
+    }
+    return result;
+}
+
+// Test DBCOMPACT_IMPACTS and ImpactPostingSource.
+DEFINE_TESTCASE(compactimpacts1, compact) {
+    Xapian::Database indb(get_database("apitest_simpledata"));
+    const vector<string> terms = { "this", "line", "paragraph", "rubbish" };
+    Xapian::Query or_query(Xapian::Query::OP_OR, terms.begin(), terms.end());
+
+    if (get_dbtype().find("glass") != string::npos) {
+	string path = get_compaction_output_path("compactimpacts1glass");
+	rm_rf(path);
+	TEST_EXCEPTION(Xapian::InvalidArgumentError,
+		       indb.compact(path, Xapian::DB_BACKEND_GLASS |
+					  Xapian::DBCOMPACT_IMPACTS));
+    }
+
+    // The input database has no impact-ordered postings.
+    TEST_EXCEPTION(Xapian::InvalidOperationError,
+		   impact_weights(indb, Xapian::Query(
+		       (new Xapian::ImpactPostingSource(terms))->release())));
+
+    string outdbpath = get_compaction_output_path("compactimpacts1");
+    rm_rf(outdbpath);
+    indb.compact(outdbpath,
+		 Xapian::DB_BACKEND_HONEY | Xapian::DBCOMPACT_IMPACTS);
+    Xapian::Database outdb(outdbpath);
+    dbcheck(outdb, indb.get_doccount(), indb.get_lastdocid());
+
+    // The impacts are quantised BM25 weights with default parameters, so
+    // each term contributes an error of at most half a unit of impact.
+    double N = outdb.get_doccount();
+    double tw = (N - 0.5) / 1.5;
+    if (tw < 2) tw = tw * 0.5 + 1;
+    double max_error = terms.size() * log(tw) / 255.0 + 1e-9;
+
+    auto bm25 = impact_weights(outdb, or_query);
+    auto impacts = impact_weights(outdb, Xapian::Query(
+	(new Xapian::ImpactPostingSource(terms))->release()));
+    TEST_EQUAL(impacts.size(), bm25.size());
+    for (auto&& i : bm25) {
+	auto j = impacts.find(i.first);
+	TEST(j != impacts.end());
+	TEST_REL(fabs(j->second - i.second), <=, max_error);
+    }
+
+    // With a budget of one posting only the highest impact posting is used.
+    auto top = impact_weights(outdb, Xapian::Query(
+	(new Xapian::ImpactPostingSource(terms, 1))->release()));
+    TEST_EQUAL(top.size(), 1);
+
+    // Compacting again without the flag drops the impacts.
+    string outdbpath2 = get_compaction_output_path("compactimpacts1b");
+    rm_rf(outdbpath2);
+    outdb.compact(outdbpath2, Xapian::DB_BACKEND_HONEY);
+    Xapian::Database outdb2(outdbpath2);
+    TEST_EXCEPTION(Xapian::InvalidOperationError,
+		   impact_weights(outdb2, Xapian::Query(
+		       (new Xapian::ImpactPostingSource(terms))->release())));
+
+    // Check multipass compaction of several shards generates the impacts
+    // from the combined statistics.
+    string outdbpath3 = get_compaction_output_path("compactimpacts1c");
+    rm_rf(outdbpath3);
+    {
+	Xapian::Database db;
+	for (int n = 0; n != 4; ++n) db.add_database(outdb2);
+	db.compact(outdbpath3, Xapian::DB_BACKEND_HONEY |
+			       Xapian::DBCOMPACT_MULTIPASS |
+			       Xapian::DBCOMPACT_IMPACTS);
+    }
+    Xapian::Database outdb3(outdbpath3);
+    bm25 = impact_weights(outdb3, or_query);
+    impacts = impact_weights(outdb3, Xapian::Query(
+	(new Xapian::ImpactPostingSource(terms))->release()));
+    TEST_EQUAL(impacts.size(), bm25.size());
+    N = outdb3.get_doccount();
+    tw = (N - 0.5) / 1.5;
+    if (tw < 2) tw = tw * 0.5 + 1;
+    max_error = terms.size() * log(tw) / 255.0 + 1e-9;
+    for (auto&& i : bm25) {
+	auto j = impacts.find(i.first);
+	TEST(j != impacts.end());
+	TEST_REL(fabs(j->second - i.second), <=, max_error);
+    }
+}
+
+/// Check @a db has the same terms as @a indb, and none of @a absent.
+static void
+check_term_lookups(const Xapian::Database& db, const Xapian::Database& indb,
+		   const vector<string>& absent)
+{
+    for (auto t = indb.allterms_begin(); t != indb.allterms_end(); ++t) {
+	TEST(db.term_exists(*t));
+	TEST_EQUAL(db.get_termfreq(*t), t.get_termfreq());
+	TEST_EQUAL(db.get_collection_freq(*t), indb.get_collection_freq(*t));
+	TEST_REL(db.get_wdf_upper_bound(*t), >, 0);
+	Xapian::Enquire enq(db);
+	enq.set_query(Xapian::Query(*t));
+	TEST_EQUAL(enq.get_mset(0, 0, db.get_doccount()).get_matches_estimated(),
+		   t.get_termfreq());
+    }
+    for (auto&& term : absent) {
+	TEST(!indb.term_exists(term));
+	TEST(!db.term_exists(term));
+	TEST_EQUAL(db.get_termfreq(term), 0);
+	TEST_EQUAL(db.get_collection_freq(term), 0);
+	TEST(db.postlist_begin(term) == db.postlist_end(term));
+	Xapian::Enquire enq(db);
+	enq.set_query(Xapian::Query(term));
+	TEST(enq.get_mset(0, 10).empty());
+    }
+}
+
+// Test DBCOMPACT_TERM_FILTER.
+DEFINE_TESTCASE(compacttermfilter1, compact) {
+    Xapian::Database indb(get_database("apitest_simpledata"));
+
+    if (get_dbtype().find("glass") != string::npos) {
+	string path = get_compaction_output_path("compacttermfilter1glass");
+	rm_rf(path);
+	TEST_EXCEPTION(Xapian::InvalidArgumentError,
+		       indb.compact(path, Xapian::DB_BACKEND_GLASS |
+					  Xapian::DBCOMPACT_TERM_FILTER));
+    }
+
+    vector<string> absent = { "thi", "thiss", "paragraphs", "Qid", "zzz" };
+    for (int i = 0; i != 100; ++i) absent.push_back("XMISSING" + str(i));
+
+    string outdbpath = get_compaction_output_path("compacttermfilter1");
+    rm_rf(outdbpath);
+    indb.compact(outdbpath,
+		 Xapian::DB_BACKEND_HONEY | Xapian::DBCOMPACT_TERM_FILTER);
+    Xapian::Database outdb(outdbpath);
+    dbcheck(outdb, indb.get_doccount(), indb.get_lastdocid());
+    check_term_lookups(outdb, indb, absent);
+
+    // Compacting again without the flag drops the filter, and compacting
+    // several shards in multiple passes builds one over all their terms.
+    string outdbpath2 = get_compaction_output_path("compacttermfilter1b");
+    rm_rf(outdbpath2);
+    outdb.compact(outdbpath2, Xapian::DB_BACKEND_HONEY);
+    Xapian::Database outdb2(outdbpath2);
+    check_term_lookups(outdb2, indb, absent);
+
+    string outdbpath3 = get_compaction_output_path("compacttermfilter1c");
+    rm_rf(outdbpath3);
+    Xapian::Database shards;
+    for (int n = 0; n != 2; ++n) {
+	shards.add_database(outdb);
+	shards.add_database(outdb2);
+    }
+    shards.compact(outdbpath3, Xapian::DB_BACKEND_HONEY |
+			       Xapian::DBCOMPACT_MULTIPASS |
+			       Xapian::DBCOMPACT_TERM_FILTER);
+    Xapian::Database outdb3(outdbpath3);
+    check_term_lookups(outdb3, shards, absent);
+}
+
+/// Positions for terms "a" and "b" in make_block_positions_db().
+static vector<Xapian::termpos>
+block_positions_for(const string& term)
+{
+    // Enough positions for several blocks, with a mixture of gap sizes.
+    vector<Xapian::termpos> result;
+    Xapian::termpos p = (term == "a" ? 1 : 2);
+    for (int i = 0; i != 500; ++i) {
+	result.push_back(p);
+	p += (i % 7 == 0) ? 1000 + i : 3;
+    }
+    return result;
+}
+
+static void
+make_block_positions_db(Xapian::WritableDatabase& db, const string&)
+{
+    Xapian::Document doc;
+    for (auto pos : block_positions_for("a")) doc.add_posting("a", pos);
+    for (auto pos : block_positions_for("b")) doc.add_posting("b", pos);
+    // Short lists are always interpolative coded.
+    doc.add_posting("c", 2);
+    doc.add_posting("c", 7);
+    db.add_document(doc);
+}
+
+/// Check the positional data of a database from make_block_positions_db().
+static void
+check_block_positions(const Xapian::Database& db)
+{
+    const vector<Xapian::termpos> a_pos = block_positions_for("a");
+    Xapian::TermIterator t = db.termlist_begin(1);
+    TEST_EQUAL(*t, "a");
+    TEST_EQUAL(t.positionlist_count(), a_pos.size());
+    t.skip_to("c");
+    TEST_EQUAL(t.positionlist_count(), 2);
+    vector<Xapian::termpos> actual(db.positionlist_begin(1, "a"),
+				   db.positionlist_end(1, "a"));
+    TEST(actual == a_pos);
+
+    // Skip to positions in later blocks, and to ones between entries
+    // (including between the last entry in one block and the first in the
+    // next).
+    Xapian::PositionIterator it = db.positionlist_begin(1, "a");
+    it.skip_to(a_pos[127] + 1);
+    TEST_EQUAL(*it, a_pos[128]);
+    it.skip_to(a_pos[200]);
+    TEST_EQUAL(*it, a_pos[200]);
+    it.skip_to(a_pos[201] + 1);
+    TEST_EQUAL(*it, a_pos[202]);
+    it.skip_to(a_pos[450] - 1);
+    TEST_EQUAL(*it, a_pos[450]);
+    it.skip_to(a_pos.back());
+    TEST_EQUAL(*it, a_pos.back());
+    it.skip_to(a_pos.back() + 1);
+    TEST(it == db.positionlist_end(1, "a"));
+
+    Xapian::Enquire enq(db);
+    enq.set_query(Xapian::Query(Xapian::Query::OP_PHRASE,
+				Xapian::Query("a"), Xapian::Query("b")));
+    TEST_EQUAL(enq.get_mset(0, 10).size(), 1);
+    enq.set_query(Xapian::Query(Xapian::Query::OP_PHRASE,
+				Xapian::Query("b"), Xapian::Query("a")));
+    TEST_EQUAL(enq.get_mset(0, 10).size(), 0);
+}
+
+/// Feature test for Xapian::DBCOMPACT_BLOCK_POSITIONS.
+DEFINE_TESTCASE(compactblockpositions1, compact) {
+    Xapian::Database indb = get_database("compactblockpositions1",
+					 make_block_positions_db);
+
+    if (get_dbtype().find("glass") != string::npos) {
+	string path = get_compaction_output_path("compactblockpositions1glass");
+	rm_rf(path);
+	TEST_EXCEPTION(Xapian::InvalidArgumentError,
+		       indb.compact(path, Xapian::DB_BACKEND_GLASS |
+					  Xapian::DBCOMPACT_BLOCK_POSITIONS));
+    }
+
+    string outdbpath = get_compaction_output_path("compactblockpositions1");
+    rm_rf(outdbpath);
+    indb.compact(outdbpath,
+		 Xapian::DB_BACKEND_HONEY | Xapian::DBCOMPACT_BLOCK_POSITIONS);
+    Xapian::Database outdb(outdbpath);
+    check_block_positions(outdb);
+
+    // Compacting again without the flag converts back to interpolative
+    // coding, which is smaller for these lists.
+    string outdbpath2 = get_compaction_output_path("compactblockpositions1b");
+    rm_rf(outdbpath2);
+    outdb.compact(outdbpath2, Xapian::DB_BACKEND_HONEY);
+    Xapian::Database outdb2(outdbpath2);
+    check_block_positions(outdb2);
+    TEST_REL(file_size(outdbpath2 + "/position.honey"), <,
+	     file_size(outdbpath + "/position.honey"));
+}
+
+static void
+make_reorder_db(Xapian::WritableDatabase& db, const string&)
+{
+    for (int i = 0; i != 96; ++i) {
+	Xapian::Document doc;
+	doc.add_term("a" + str(i % 4));
+	doc.add_term("b" + str(i % 3));
+	doc.add_term("c" + str(i % 7));
+	doc.add_value(0, "host" + str(i % 2));
+	doc.set_data(str(i));
+	db.add_document(doc);
+    }
+    db.set_metadata("foo", "bar");
+}
+
+/// Estimate the cost of encoding the postlists of @a db as docid gaps.
+static double
+gap_cost(const Xapian::Database& db)
+{
+    double cost = 0.0;
+    for (auto t = db.allterms_begin(); t != db.allterms_end(); ++t) {
+	Xapian::docid prev = 0;
+	for (auto p = db.postlist_begin(*t); p != db.postlist_end(*t); ++p) {
+	    cost += log2(double(*p - prev));
+	    prev = *p;
+	}
+    }
+    return cost;
+}
+
+class ReorderCompactor : public Xapian::Compactor {
+    bool use_key;
+
+  public:
+    map<Xapian::docid, Xapian::docid> new_docids;
+
+    explicit ReorderCompactor(bool use_key_) : use_key(use_key_) { }
+
+    string get_reorder_key(const Xapian::Document& doc) override {
+	return use_key ? doc.get_value(0) : string();
+    }
+
+    void set_new_docid(Xapian::docid old_did,
+		       Xapian::docid new_did) override {
+	TEST(new_docids.emplace(old_did, new_did).second);
+    }
+};
+
+// Test DBCOMPACT_REORDER.
+DEFINE_TESTCASE(compactreorder1, compact) {
+    Xapian::Database indb = get_database("compactreorder1", make_reorder_db);
+    string outdbpath = get_compaction_output_path("compactreorder1");
+
+    TEST_EXCEPTION(Xapian::InvalidArgumentError,
+		   indb.compact(outdbpath, Xapian::DBCOMPACT_REORDER |
+					   Xapian::DBCOMPACT_NO_RENUMBER));
+
+    // Anything already at the path we'd use for the temporary database must
+    // be left alone.
+    string tmpdir = outdbpath + ".reorder-tmp";
+    rm_rf(tmpdir);
+    mkdir(tmpdir.c_str(), 0755);
+    touch(tmpdir + "/keep");
+
+    for (bool use_key : { false, true }) {
+	rm_rf(outdbpath);
+	ReorderCompactor compactor(use_key);
+	indb.compact(outdbpath, Xapian::DBCOMPACT_REORDER, 0, compactor);
+	Xapian::Database outdb(outdbpath);
+	dbcheck(outdb, indb.get_doccount(), indb.get_doccount());
+	TEST_EQUAL(outdb.get_metadata("foo"), "bar");
+	TEST(file_exists(tmpdir + "/keep"));
+	TEST(!file_exists(tmpdir + "/iamglass"));
+	TEST(!dir_exists(tmpdir + "1"));
+
+	// Check the mapping covers every document and each document ended
+	// up with the reported docid.
+	TEST_EQUAL(compactor.new_docids.size(), indb.get_doccount());
+	for (auto&& i : compactor.new_docids) {
+	    Xapian::Document in_doc = indb.get_document(i.first);
+	    Xapian::Document out_doc = outdb.get_document(i.second);
+	    TEST_EQUAL(out_doc.get_data(), in_doc.get_data());
+	    TEST_EQUAL(out_doc.get_value(0), in_doc.get_value(0));
+	    TEST_EQUAL(out_doc.termlist_count(), in_doc.termlist_count());
+	}
+
+	TEST_REL(gap_cost(outdb), <, gap_cost(indb));
+
+	if (use_key) {
+	    Xapian::doccount half = outdb.get_doccount() / 2;
+	    for (Xapian::docid did = 1; did <= outdb.get_doccount(); ++did) {
+		TEST_EQUAL(outdb.get_document(did).get_value(0),
+			   did <= half ? "host0" : "host1");
+	    }
+	}
+    }
+    rm_rf(tmpdir);
+}
+
+static void
+make_sortbyvalue_db(Xapian::WritableDatabase& db, const string&)
+{
+    for (int i = 0; i != 200; ++i) {
+	Xapian::Document doc;
+	doc.add_term("all");
+	doc.add_term(i % 2 ? "odd" : "even");
+	// Values in a scrambled order, with some repeats and a few missing.
+	if (i % 17 != 3)
+	    doc.add_value(0, Xapian::sortable_serialise((i * 37) % 150));
+	doc.set_data(str(i));
+	db.add_document(doc);
+    }
+}
+
+// Test Compactor::set_sort_by_value().
+DEFINE_TESTCASE(compactsortbyvalue1, compact) {
+    Xapian::Database indb = get_database("compactsortbyvalue1",
+					 make_sortbyvalue_db);
+    string outdbpath = get_compaction_output_path("compactsortbyvalue1");
+    rm_rf(outdbpath);
+
+    if (get_dbtype().find("glass") != string::npos) {
+	Xapian::Compactor compactor;
+	compactor.set_sort_by_value(0, true);
+	TEST_EXCEPTION(Xapian::InvalidArgumentError,
+		       indb.compact(outdbpath, 0, 0, compactor));
+	rm_rf(outdbpath);
+    }
+
+    for (bool reverse : { true, false }) {
+	rm_rf(outdbpath);
+	ReorderCompactor compactor(false);
+	compactor.set_sort_by_value(0, reverse);
+	indb.compact(outdbpath, Xapian::DB_BACKEND_HONEY, 0, compactor);
+	TEST_EQUAL(compactor.new_docids.size(), indb.get_doccount());
+
+	Xapian::Database outdb(outdbpath);
+	dbcheck(outdb, indb.get_doccount(), indb.get_doccount());
+	string prev = reverse ? string(1, '\xff') : string();
+	for (Xapian::docid did = 1; did <= outdb.get_doccount(); ++did) {
+	    string value = outdb.get_document(did).get_value(0);
+	    TEST(reverse ? value <= prev : value >= prev);
+	    prev = value;
+	}
+
+	// Sorted searches should give the same results as on the input,
+	// including with early termination.
+	for (const char* term : { "all", "even", "odd" }) {
+	    for (Xapian::doccount size : { 1, 7, 10, 200 }) {
+		Xapian::Enquire in_enq(indb), out_enq(outdb);
+		in_enq.set_query(Xapian::Query(term));
+		out_enq.set_query(Xapian::Query(term));
+		in_enq.set_sort_by_value(0, reverse);
+		out_enq.set_sort_by_value(0, reverse);
+		Xapian::MSet in_mset = in_enq.get_mset(0, size);
+		Xapian::MSet out_mset = out_enq.get_mset(0, size);
+		TEST_EQUAL(out_mset.size(), in_mset.size());
+		auto i = in_mset.begin();
+		auto o = out_mset.begin();
+		for ( ; i != in_mset.end(); ++i, ++o) {
+		    TEST_EQUAL(o.get_document().get_value(0),
+			       i.get_document().get_value(0));
+		}
+		if (size >= indb.get_termfreq(term)) {
+		    TEST_EQUAL(out_mset.get_matches_estimated(),
+			       in_mset.get_matches_estimated());
+		}
+	    }
+	}
+
+	// Check the match stops once it has enough results when sorting in
+	// the stored order, but not in the opposite order.
+	for (bool match_reverse : { true, false }) {
+	    Xapian::Enquire enq(outdb);
+	    enq.set_query(Xapian::Query("all"));
+	    enq.set_sort_by_value(0, match_reverse);
+	    Xapian::ValueCountMatchSpy spy(0);
+	    enq.add_matchspy(&spy);
+	    Xapian::MSet mset = enq.get_mset(0, 5);
+	    TEST_EQUAL(mset.size(), 5);
+	    TEST_EQUAL(spy.get_total(),
+		       match_reverse == reverse ? 5 : outdb.get_doccount());
+	}
+
+	// Compacting the output again keeps the order, and doesn't need to
+	// renumber any documents.
+	string outdbpath2 = get_compaction_output_path("compactsortbyvalue1b");
+	rm_rf(outdbpath2);
+	ReorderCompactor compactor2(false);
+	compactor2.set_sort_by_value(0, reverse);
+	outdb.compact(outdbpath2, 0, 0, compactor2);
+	TEST(compactor2.new_docids.empty());
+    }
+}
+
 // Test compacting to an fd.
 DEFINE_TESTCASE(compacttofd1, compact) {
     Xapian::Database indb(get_database("apitest_simpledata"));
@@ -549,6 +549,196 @@ DEFINE_TESTCASE(matchdecider3, backend && !remote) {
     TEST_EQUAL(mset2.get_uncollapsed_matches_upper_bound(), 1);
 }
 
+/// MatchVisitor which records the matches it's passed.
+class RecordingMatchVisitor : public Xapian::MatchVisitor {
+  public:
+    vector<pair<Xapian::docid, double>> matches;
+
+    Xapian::doccount limit = 0;
+
+    bool operator()(Xapian::docid did, double weight) override {
+	matches.emplace_back(did, weight);
+	return limit == 0 || matches.size() < limit;
+    }
+};
+
+/// Test Enquire::visit_matches().
+DEFINE_TESTCASE(visitmatches1, backend && !remote) {
+    Xapian::Database db(get_database("etext"));
+    Xapian::Enquire enquire(db);
+    enquire.set_query(Xapian::Query(Xapian::Query::OP_OR,
+				    Xapian::Query("we"),
+				    Xapian::Query("produc")));
+    Xapian::MSet mset = enquire.get_mset(0, db.get_doccount());
+    TEST_REL(mset.size(), >, 10);
+    map<Xapian::docid, double> expected;
+    for (auto i = mset.begin(); i != mset.end(); ++i) {
+	expected[*i] = i.get_weight();
+    }
+
+    // Without weights.
+    RecordingMatchVisitor visitor;
+    TEST_EQUAL(enquire.visit_matches(visitor), mset.size());
+    TEST_EQUAL(visitor.matches.size(), mset.size());
+    for (size_t i = 1; i < visitor.matches.size(); ++i) {
+	TEST_REL(visitor.matches[i - 1].first, <, visitor.matches[i].first);
+    }
+    for (auto& m : visitor.matches) {
+	TEST(expected.count(m.first));
+	TEST_EQUAL(m.second, 0.0);
+    }
+
+    // With weights.
+    RecordingMatchVisitor wvisitor;
+    TEST_EQUAL(enquire.visit_matches(wvisitor, true), mset.size());
+    for (auto& m : wvisitor.matches) {
+	TEST(expected.count(m.first));
+	TEST_EQUAL_DOUBLE(m.second, expected[m.first]);
+    }
+
+    // Stopping early.
+    RecordingMatchVisitor svisitor;
+    svisitor.limit = 3;
+    TEST_EQUAL(enquire.visit_matches(svisitor), 3);
+    for (size_t i = 0; i != 3; ++i) {
+	TEST_EQUAL(svisitor.matches[i].first, visitor.matches[i].first);
+    }
+
+    // A query matching nothing.
+    enquire.set_query(Xapian::Query("ThisTermDoesNotExist"));
+    RecordingMatchVisitor nvisitor;
+    TEST_EQUAL(enquire.visit_matches(nvisitor), 0);
+    TEST(nvisitor.matches.empty());
+}
+
+/// Test Enquire::visit_matches() merges matches from shards in docid order.
+DEFINE_TESTCASE(visitmatches3, multi && !remote) {
+    Xapian::Database db(get_database("etext"));
+    TEST_REL(db.size(), >, 1);
+    Xapian::Enquire enquire(db);
+    enquire.set_query(Xapian::Query("we"));
+    enquire.set_docid_order(Xapian::Enquire::ASCENDING);
+    enquire.set_weighting_scheme(Xapian::BoolWeight());
+    Xapian::MSet mset = enquire.get_mset(0, db.get_doccount());
+    TEST_REL(mset.size(), >, 10);
+
+    RecordingMatchVisitor visitor;
+    TEST_EQUAL(enquire.visit_matches(visitor), mset.size());
+    TEST_EQUAL(visitor.matches.size(), mset.size());
+    size_t j = 0;
+    for (auto i = mset.begin(); i != mset.end(); ++i, ++j) {
+	TEST_EQUAL(visitor.matches[j].first, *i);
+    }
+
+    // Stopping early should give a prefix of the full sequence.
+    RecordingMatchVisitor svisitor;
+    svisitor.limit = 5;
+    TEST_EQUAL(enquire.visit_matches(svisitor), 5);
+    for (size_t i = 0; i != 5; ++i) {
+	TEST_EQUAL(svisitor.matches[i].first, visitor.matches[i].first);
+    }
+}
+
+/// Test Enquire::visit_matches() with the remote backend fails.
+DEFINE_TESTCASE(visitmatches2, remote) {
+    Xapian::Database db(get_database("apitest_simpledata"));
+    Xapian::Enquire enquire(db);
+    enquire.set_query(Xapian::Query("paragraph"));
+
+    RecordingMatchVisitor visitor;
+    TEST_EXCEPTION(Xapian::UnimplementedError,
+		   enquire.visit_matches(visitor));
+    TEST(visitor.matches.empty());
+
+    // Check the remote connection is still usable.
+    TEST(!enquire.get_mset(0, 10).empty());
+}
+
+/// Test Enquire::get_matches_count().
+DEFINE_TESTCASE(matchescount1, backend) {
+    Xapian::Database db(get_database("etext"));
+    Xapian::Enquire enquire(db);
+    TEST_EQUAL(enquire.get_matches_count(), 0);
+
+    const Xapian::Query queries[] = {
+	Xapian::Query("we"),
+	Xapian::Query::MatchAll,
+	Xapian::Query("ThisTermDoesNotExist"),
+	Xapian::Query(Xapian::Query::OP_OR,
+		      Xapian::Query("we"), Xapian::Query("produc")),
+	Xapian::Query(Xapian::Query::OP_AND,
+		      Xapian::Query("we"), Xapian::Query("produc")),
+	Xapian::Query(Xapian::Query::OP_AND_NOT,
+		      Xapian::Query("we"), Xapian::Query("produc")),
+	Xapian::Query(Xapian::Query::OP_FILTER,
+		      Xapian::Query("we"), Xapian::Query("produc")),
+	Xapian::Query(Xapian::Query::OP_PHRASE,
+		      Xapian::Query("we"), Xapian::Query("produc")),
+	Xapian::Query(Xapian::Query::OP_VALUE_RANGE, 1, "M", "Z"),
+    };
+    for (auto& query : queries) {
+	tout << query.get_description() << '\n';
+	enquire.set_query(query);
+	Xapian::MSet mset = enquire.get_mset(0, 0, db.get_doccount());
+	TEST_EQUAL(enquire.get_matches_count(), mset.get_matches_estimated());
+    }
+}
+
+/// Check the doclength cache gives the same results as not caching.
+DEFINE_TESTCASE(doclengthcache1, backend) {
+    Xapian::Database db(get_database("etext"));
+    Xapian::Enquire enquire(db);
+    enquire.set_query(Xapian::Query(Xapian::Query::OP_OR,
+				    Xapian::Query("we"),
+				    Xapian::Query("produc")));
+    Xapian::MSet expected = enquire.get_mset(0, db.get_doccount());
+    vector<Xapian::termcount> doclens;
+    for (Xapian::docid did = 1; did <= db.get_lastdocid(); ++did) {
+	doclens.push_back(db.get_doclength(did));
+    }
+
+    db.set_doclength_cache();
+    for (Xapian::docid did = 1; did <= db.get_lastdocid(); ++did) {
+	TEST_EQUAL(db.get_doclength(did), doclens[did - 1]);
+    }
+    TEST_EXCEPTION(Xapian::DocNotFoundError,
+		   db.get_doclength(db.get_lastdocid() + 1));
+    Xapian::MSet mset = enquire.get_mset(0, db.get_doccount());
+    TEST_EQUAL(mset.size(), expected.size());
+    for (Xapian::doccount i = 0; i != mset.size(); ++i) {
+	TEST_EQUAL(*mset[i], *expected[i]);
+	TEST_EQUAL_DOUBLE(mset[i].get_weight(), expected[i].get_weight());
+    }
+
+    db.set_doclength_cache(false);
+    TEST_EQUAL(db.get_doclength(1), doclens[0]);
+}
+
+/// Check the doclength cache is updated by reopen().
+DEFINE_TESTCASE(doclengthcache2, writable && !inmemory) {
+    Xapian::WritableDatabase wdb = get_writable_database();
+    Xapian::Document doc;
+    doc.add_term("foo", 3);
+    wdb.add_document(doc);
+    doc.add_term("bar", 7);
+    wdb.add_document(doc);
+    wdb.commit();
+
+    Xapian::Database db = get_writable_database_as_database();
+    db.set_doclength_cache();
+    TEST_EQUAL(db.get_doclength(1), 3);
+    TEST_EQUAL(db.get_doclength(2), 10);
+
+    wdb.delete_document(1);
+    doc.add_term("baz", 100000);
+    wdb.add_document(doc);
+    wdb.commit();
+    TEST(db.reopen());
+    TEST_EXCEPTION(Xapian::DocNotFoundError, db.get_doclength(1));
+    TEST_EQUAL(db.get_doclength(2), 10);
+    TEST_EQUAL(db.get_doclength(3), 100010);
+}
+
 // tests that mset iterators on msets compare correctly.
 DEFINE_TESTCASE(msetiterator1, backend) {
     Xapian::Enquire enquire(get_database("apitest_simpledata"));
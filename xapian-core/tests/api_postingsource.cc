@@ -593,7 +593,13 @@ DEFINE_TESTCASE(emptyvalwtsource1, backend && !remote && !multi) {
     }
 }
 
-#ifdef HAVE_TIMER_CREATE
+/** Posting source which is slow to advance to its second document.
+ *
+ *  The first document is returned immediately, and moving to the second
+ *  takes 2 seconds, so with a time limit of 1 second the match reliably times
+ *  out after the second document, without relying on how long the first
+ *  document takes on a loaded machine.
+ */
 class SlowDecreasingValueWeightPostingSource
     : public Xapian::DecreasingValueWeightPostingSource {
   public:
@@ -607,8 +613,7 @@ class SlowDecreasingValueWeightPostingSource
     }
 
     void next(double min_wt) override {
-	sleep(1);
-	++count;
+	if (++count == 2) sleep(2);
 	return Xapian::DecreasingValueWeightPostingSource::next(min_wt);
     }
 };
@@ -622,15 +627,11 @@ make_matchtimelimit1_db(Xapian::WritableDatabase &db, const string &)
 	db.add_document(doc);
     }
 }
-#endif
 
 // FIXME: This doesn't run for remote databases (we'd need to register
 // SlowDecreasingValueWeightPostingSource on the remote).
 DEFINE_TESTCASE(matchtimelimit1, backend && !remote)
 {
-#ifndef HAVE_TIMER_CREATE
-    SKIP_TEST("Enquire::set_time_limit() not implemented for this platform");
-#else
     Xapian::Database db = get_database("matchtimelimit1",
 				       make_matchtimelimit1_db);
 
@@ -640,12 +641,46 @@ DEFINE_TESTCASE(matchtimelimit1, backend && !remote)
     Xapian::Enquire enquire(db);
     enquire.set_query(Xapian::Query(&src));
 
-    enquire.set_time_limit(1.5);
+    enquire.set_time_limit(1.0);
 
     Xapian::MSet mset = enquire.get_mset(0, 1, 1000);
     TEST_EQUAL(mset.size(), 1);
     TEST_EQUAL(count, 2);
-#endif
+    TEST(!mset.timed_out());
+}
+
+/// Test Enquire::set_time_limit() with stop_match set.
+DEFINE_TESTCASE(matchtimelimit2, backend && !remote)
+{
+    Xapian::Database db = get_database("matchtimelimit1",
+				       make_matchtimelimit1_db);
+
+    int count = 0;
+    SlowDecreasingValueWeightPostingSource src(count);
+    src.reset(db, 0);
+    Xapian::Enquire enquire(db);
+    enquire.set_query(Xapian::Query(&src));
+
+    enquire.set_time_limit(1.0, true);
+
+    // Without stop_match, we'd keep going until we had 10 results.
+    Xapian::MSet mset = enquire.get_mset(0, 10);
+    TEST(mset.timed_out());
+    TEST_EQUAL(count, 2);
+    TEST_EQUAL(mset.size(), 2);
+    TEST_EQUAL(mset.get_docs_checked(), 2);
+    // The bounds shouldn't claim the partial result is exact.
+    TEST_EQUAL(mset.get_matches_upper_bound(), db.get_doccount());
+    TEST_REL(mset.get_matches_lower_bound(), >=, 2);
+    TEST_EQUAL(*mset.begin(), 1);
+
+    // Check a match which completes within the limit doesn't report timing
+    // out, and counts the documents checked.
+    enquire.set_query(Xapian::Query("nosuchterm") |
+		      Xapian::Query(Xapian::Query::OP_VALUE_GE, 0, ""));
+    mset = enquire.get_mset(0, 10, db.get_doccount());
+    TEST(!mset.timed_out());
+    TEST_EQUAL(mset.get_docs_checked(), db.get_doccount());
 }
 
 class CheckBoundsPostingSource
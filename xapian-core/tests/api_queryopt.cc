@@ -149,3 +149,73 @@ DEFINE_TESTCASE(boolandmaybe2, backend) {
 	TEST(ti3 == enquire3.get_matching_terms_end(did));
     }
 }
+
+/// Check pruning in OP_OR with many subqueries doesn't change the results.
+DEFINE_TESTCASE(multior1, backend) {
+    static const char* const terms[] = {
+	"the", "last", "day", "of", "time", "word", "that", "is", "paragraph",
+	"with", "mention", "as", "out", "gutenberg", "etext", "said", "he"
+    };
+    Xapian::Database db(get_database("etext"));
+    Xapian::Enquire enquire(db);
+    vector<Xapian::Query> subqs;
+    for (const char* term : terms) {
+	subqs.emplace_back(term, 1 + subqs.size() % 3);
+    }
+    enquire.set_query(Xapian::Query(Xapian::Query::OP_OR,
+				    subqs.begin(), subqs.end()));
+
+    // With maxitems this large the weight threshold never rises, so nothing
+    // gets pruned.
+    Xapian::MSet full = enquire.get_mset(0, db.get_doccount());
+    TEST_REL(full.size(), >, 20);
+
+    for (Xapian::doccount first : {0, 5}) {
+	Xapian::MSet mset = enquire.get_mset(first, 10);
+	TEST_EQUAL(mset.size(), 10);
+	for (Xapian::doccount i = 0; i != mset.size(); ++i) {
+	    TEST_EQUAL(*mset[i], *full[first + i]);
+	    TEST_EQUAL_DOUBLE(mset[i].get_weight(), full[first + i].get_weight());
+	    TEST_EQUAL(mset[i].get_percent(), full[first + i].get_percent());
+	}
+    }
+}
+
+/// Check the filter cache gives the same results as not caching.
+DEFINE_TESTCASE(filtercache1, backend) {
+    typedef Xapian::Query Q;
+    Q filter_or(Q::OP_OR, Q("paragraph"), Q("mention"));
+    Q filter_and_not(Q::OP_AND_NOT, Q("the"), Q("word"));
+    const Q queries[] = {
+	Q(Q::OP_FILTER, Q("last"), filter_or),
+	Q(Q::OP_FILTER, Q(Q::OP_OR, Q("day"), Q("time")), filter_and_not),
+	Q(Q::OP_FILTER, Q("of"), Q(Q::OP_AND, filter_or, filter_and_not)),
+	Q(Q::OP_FILTER, Q("said"), Q("gutenberg")),
+	Q(Q::OP_FILTER, Q("said"), Q("nosuchterm")),
+	Q(Q::OP_FILTER, Q("he"), Q(Q::OP_OR, Q("gutenberg"), Q("nosuchterm"))),
+    };
+    Xapian::Database db(get_database("etext"));
+    Xapian::Enquire enquire(db);
+    vector<Xapian::MSet> expected;
+    for (auto&& query : queries) {
+	enquire.set_query(query);
+	expected.push_back(enquire.get_mset(0, db.get_doccount()));
+    }
+
+    // Run each query twice with a large enough cache (so the second run uses
+    // the cached bitmaps), then with a cache too small to hold anything, then
+    // with the cache disabled again.
+    for (size_t cache_size : {1 << 20, 1 << 20, 1, 0}) {
+	db.set_filter_cache_size(cache_size);
+	for (size_t q = 0; q != std::size(queries); ++q) {
+	    enquire.set_query(queries[q]);
+	    Xapian::MSet mset = enquire.get_mset(0, db.get_doccount());
+	    TEST_EQUAL(mset.size(), expected[q].size());
+	    for (Xapian::doccount i = 0; i != mset.size(); ++i) {
+		TEST_EQUAL(*mset[i], *expected[q][i]);
+		TEST_EQUAL_DOUBLE(mset[i].get_weight(),
+				  expected[q][i].get_weight());
+	    }
+	}
+    }
+}
@@ -398,3 +398,58 @@ DEFINE_TESTCASE(sort_existing_mset_by_relevance, backend) {
     TEST_EQUAL_DOUBLE(mymset.get_max_attained(), weights[1]);
     TEST_EQUAL_DOUBLE(mymset.get_max_possible(), weights[1]);
 }
+
+/// Test paginating using Enquire::get_mset_after().
+DEFINE_TESTCASE(msetafter1, backend) {
+    Xapian::Database db(get_database("etext"));
+    Xapian::Enquire enquire(db);
+    enquire.set_query(Xapian::Query(Xapian::Query::OP_OR,
+				    Xapian::Query("the"),
+				    Xapian::Query("paragraph")));
+    for (int mode = 0; mode != 6; ++mode) {
+	tout << "mode " << mode << '\n';
+	switch (mode) {
+	    case 0:
+		break;
+	    case 1:
+		enquire.set_docid_order(Xapian::Enquire::DESCENDING);
+		break;
+	    case 2:
+		enquire.set_docid_order(Xapian::Enquire::ASCENDING);
+		enquire.set_sort_by_value(11, true);
+		break;
+	    case 3:
+		enquire.set_sort_by_value_then_relevance(11, false);
+		break;
+	    case 4:
+		enquire.set_sort_by_relevance();
+		enquire.set_weighting_scheme(Xapian::BoolWeight());
+		break;
+	    case 5:
+		enquire.set_docid_order(Xapian::Enquire::DESCENDING);
+		break;
+	}
+	Xapian::MSet full = enquire.get_mset(0, db.get_doccount());
+	Xapian::doccount total = full.size();
+	TEST_REL(total, >, 20);
+
+	Xapian::MSet page = enquire.get_mset(0, 7);
+	Xapian::doccount rank = 0;
+	while (true) {
+	    TEST_REL(page.get_matches_lower_bound(), <=, total);
+	    TEST_REL(page.get_matches_upper_bound(), >=, total);
+	    for (auto i = page.begin(); i != page.end(); ++i) {
+		TEST_EQUAL(*i, *full[rank]);
+		TEST_EQUAL_DOUBLE(i.get_weight(), full[rank].get_weight());
+		++rank;
+	    }
+	    if (page.size() < 7) {
+		// The final page should give exact counts.
+		TEST_EQUAL(page.get_matches_estimated(), total);
+		break;
+	    }
+	    page = enquire.get_mset_after(page[page.size() - 1], 7);
+	}
+	TEST_EQUAL(rank, total);
+    }
+}
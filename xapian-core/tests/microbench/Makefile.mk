@@ -0,0 +1,23 @@
+## Process this file with automake to produce Makefile.in
+
+.PHONY: check-microbench
+
+check-microbench: microbench/microbench$(EXEEXT)
+	VALGRIND= XAPIAN_TESTSUITE_LD_PRELOAD= $(TESTS_ENVIRONMENT) ./microbench/microbench$(EXEEXT)
+
+## Programs to build
+check_PROGRAMS += microbench/microbench
+
+## Sources:
+
+# The decoding kernels aren't exported from the library, so we build the
+# ones which don't depend on backend internals into the benchmark directly.
+microbench_microbench_SOURCES = \
+	microbench/microbench.cc \
+	../common/bitstream.cc \
+	../common/blockpositions.cc \
+	../common/errno_to_string.cc \
+	../common/str.cc \
+	harness/unixcmds.cc
+microbench_microbench_LDFLAGS = $(NO_INSTALL)
+microbench_microbench_LDADD = ../libgetopt.la ../$(libxapian_la)
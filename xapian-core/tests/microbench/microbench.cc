@@ -0,0 +1,657 @@
+/** @file
+ * @brief Microbenchmarks for postlist, position and value decoding.
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <config.h>
+
+#include <xapian.h>
+
+#include "bitstream.h"
+#include "blockpositions.h"
+#include "gnu_getopt.h"
+#include "pack.h"
+#include "safesysstat.h"
+#include "str.h"
+#include "unixcmds.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#define PROG_NAME "microbench"
+#define PROG_DESC "Time Xapian's postlist, position and value decoding kernels"
+
+#define OPT_HELP 1
+#define OPT_VERSION 2
+
+/// Directory the synthetic databases are built in.
+static const char* SYNTHETIC_DB_DIR = ".microbench";
+
+/// Minimum time in seconds to spend on each benchmark.
+static double min_time = 0.5;
+
+/// Substrings of benchmark names to run (all are run if empty).
+static vector<string> filters;
+
+/** Sink for values computed by the kernels.
+ *
+ *  Storing into this stops the compiler discarding the work we're trying to
+ *  time.
+ */
+static volatile unsigned long long sink;
+
+static void show_usage() {
+    cout << "Usage: " PROG_NAME " [OPTIONS] [BENCHMARK_SUBSTRING...]\n\n"
+"Options:\n"
+"  -d, --db=DATABASE   also time decoding of data taken from DATABASE\n"
+"  -n, --docs=N        number of documents in the synthetic databases\n"
+"                      (default 10000)\n"
+"  -t, --min-time=SECS minimum time to spend on each benchmark (default 0.5)\n"
+"      --help          display this help and exit\n"
+"      --version       output version information and exit\n\n"
+"Each benchmark reports the best time per item in nanoseconds and the\n"
+"corresponding throughput in MB/s of encoded data.  For benchmarks which\n"
+"go through a database the encoded size is that of the equivalent glass\n"
+"chunk payload (i.e. excluding keys, chunk headers and B-tree overhead).\n";
+}
+
+static bool
+wanted(const string& name)
+{
+    if (filters.empty()) return true;
+    for (auto&& f : filters) {
+	if (name.find(f) != string::npos) return true;
+    }
+    return false;
+}
+
+/** Time a benchmark and report the results.
+ *
+ *  @param name	    Name of the benchmark.
+ *  @param items    Number of items decoded by each call to @a pass.
+ *  @param bytes    Number of bytes of encoded data decoded by each call to
+ *		    @a pass.
+ *  @param pass	    Function object performing one pass over the data and
+ *		    returning a checksum.
+ */
+template<typename F>
+static void
+run(const string& name, size_t items, size_t bytes, F pass)
+{
+    if (!wanted(name) || items == 0) return;
+
+    using clock = chrono::steady_clock;
+    double best = HUGE_VAL;
+    double total = 0.0;
+    unsigned reps = 0;
+    do {
+	auto start = clock::now();
+	sink = sink + pass();
+	chrono::duration<double> elapsed = clock::now() - start;
+	best = min(best, elapsed.count());
+	total += elapsed.count();
+	++reps;
+    } while (total < min_time || reps < 3);
+
+    double ns_per_item = best * 1e9 / double(items);
+    double mb_per_sec = double(bytes) / best / 1e6;
+    cout << left << setw(40) << name << right
+	 << setw(10) << items << " items "
+	 << fixed << setprecision(2)
+	 << setw(10) << ns_per_item << " ns/item "
+	 << setw(10) << mb_per_sec << " MB/s" << endl;
+    cout.unsetf(ios::floatfield);
+}
+
+/// A set of values encoded with pack_uint().
+struct PackedUInts {
+    string data;
+    size_t count = 0;
+
+    void add(Xapian::termcount value) {
+	pack_uint(data, value);
+	++count;
+    }
+};
+
+static void
+bench_unpack_uint(const string& name, const PackedUInts& packed)
+{
+    run("unpack_uint/" + name, packed.count, packed.data.size(),
+	[&]() {
+	    const char* p = packed.data.data();
+	    const char* end = p + packed.data.size();
+	    unsigned long long sum = 0;
+	    while (p != end) {
+		Xapian::termcount v;
+		if (!unpack_uint(&p, end, &v)) abort();
+		sum += v;
+	    }
+	    return sum;
+	});
+}
+
+/// A set of position lists encoded as the glass backend does.
+struct EncodedPositions {
+    vector<string> lists;
+    size_t count = 0;
+    size_t bytes = 0;
+
+    /** Positions to skip_to() in each list.
+     *
+     *  We pick a few spread through the list, as a phrase check might.
+     */
+    vector<vector<Xapian::termpos>> skips;
+    size_t n_skips = 0;
+
+    void add_skips(const Xapian::VecCOW<Xapian::termpos>& pos) {
+	vector<Xapian::termpos> v;
+	for (size_t i = 1; i <= 4; ++i) {
+	    v.push_back(pos[pos.size() * i / 5]);
+	}
+	n_skips += v.size();
+	skips.push_back(std::move(v));
+    }
+
+    void add(const Xapian::VecCOW<Xapian::termpos>& pos) {
+	// Single entry lists don't use interpolative coding.
+	if (pos.size() < 2) return;
+	string s;
+	pack_uint(s, pos.back());
+	BitWriter wr(s);
+	wr.encode(pos[0], pos.back());
+	wr.encode(pos.size() - 2, pos.back() - pos[0]);
+	wr.encode_interpolative(pos, 0, pos.size() - 1);
+	lists.push_back(std::move(wr.freeze()));
+	bytes += lists.back().size();
+	count += pos.size();
+	add_skips(pos);
+    }
+};
+
+/// The same position lists block-packed (as DBCOMPACT_BLOCK_POSITIONS does).
+struct BlockEncodedPositions : public EncodedPositions {
+    void add(const Xapian::VecCOW<Xapian::termpos>& pos) {
+	if (pos.size() < 2) return;
+	string s;
+	if (!encode_block_positions(s, pos)) abort();
+	bytes += s.size();
+	lists.push_back(std::move(s));
+	count += pos.size();
+	add_skips(pos);
+    }
+};
+
+static void
+bench_interpolative(const string& name, const EncodedPositions& enc)
+{
+    run("decode_interpolative/" + name, enc.count, enc.bytes,
+	[&]() {
+	    BitReader rd;
+	    unsigned long long sum = 0;
+	    for (auto&& s : enc.lists) {
+		const char* p = s.data();
+		const char* end = p + s.size();
+		Xapian::termpos last;
+		if (!unpack_uint(&p, end, &last)) abort();
+		rd.init(p, end);
+		Xapian::termpos first = rd.decode(last);
+		Xapian::termpos size = rd.decode(last - first) + 2;
+		rd.decode_interpolative(0, size - 1, first, last);
+		sum += first;
+		for (Xapian::termpos i = 2; i < size; ++i) {
+		    sum += rd.decode_interpolative_next();
+		}
+		sum += last;
+	    }
+	    return sum;
+	});
+
+    // Skipping with interpolative coding has to decode every position up to
+    // the target.
+    run("skip_interpolative/" + name, enc.n_skips, enc.bytes,
+	[&]() {
+	    BitReader rd;
+	    unsigned long long sum = 0;
+	    for (size_t j = 0; j != enc.lists.size(); ++j) {
+		const string& s = enc.lists[j];
+		const char* p = s.data();
+		const char* end = p + s.size();
+		Xapian::termpos last;
+		if (!unpack_uint(&p, end, &last)) abort();
+		rd.init(p, end);
+		Xapian::termpos cur = rd.decode(last);
+		Xapian::termpos size = rd.decode(last - cur) + 2;
+		rd.decode_interpolative(0, size - 1, cur, last);
+		for (auto target : enc.skips[j]) {
+		    while (cur < target) {
+			cur = (cur == last) ? last + 1 :
+			    rd.decode_interpolative_next();
+		    }
+		    sum += cur;
+		}
+	    }
+	    return sum;
+	});
+}
+
+static void
+bench_block_positions(const string& name, const BlockEncodedPositions& enc)
+{
+    run("decode_block/" + name, enc.count, enc.bytes,
+	[&]() {
+	    BlockPositionReader rd;
+	    unsigned long long sum = 0;
+	    for (auto&& s : enc.lists) {
+		Xapian::termcount size;
+		Xapian::termpos last;
+		rd.init(s.data(), s.data() + s.size(), size, last);
+		sum += rd.get_position();
+		for (Xapian::termcount i = 1; i < size; ++i) {
+		    sum += rd.next();
+		}
+	    }
+	    return sum;
+	});
+
+    run("skip_block/" + name, enc.n_skips, enc.bytes,
+	[&]() {
+	    BlockPositionReader rd;
+	    unsigned long long sum = 0;
+	    for (size_t j = 0; j != enc.lists.size(); ++j) {
+		const string& s = enc.lists[j];
+		Xapian::termcount size;
+		Xapian::termpos last;
+		rd.init(s.data(), s.data() + s.size(), size, last);
+		Xapian::termpos cur = rd.get_position();
+		for (auto target : enc.skips[j]) {
+		    if (cur < target) cur = rd.skip_to(target);
+		    sum += cur;
+		}
+	    }
+	    return sum;
+	});
+}
+
+/// Report the encoded sizes of a set of position lists with each codec.
+static void
+report_position_sizes(const string& name,
+		      const EncodedPositions& interp,
+		      const BlockEncodedPositions& block)
+{
+    if (!wanted("size/" + name) || interp.count == 0) return;
+    cout << left << setw(40) << ("size/" + name) << right
+	 << setw(10) << interp.count << " items "
+	 << fixed << setprecision(2)
+	 << setw(10) << double(interp.bytes) * 8 / double(interp.count)
+	 << " bits/item interpolative "
+	 << setw(6) << double(block.bytes) * 8 / double(block.count)
+	 << " bits/item block" << endl;
+    cout.unsetf(ios::floatfield);
+}
+
+/// Synthetic pack_uint() encoded data with a few different distributions.
+static void
+bench_synthetic_kernels(mt19937& gen)
+{
+    const size_t N = 1000000;
+
+    PackedUInts small, deltas, wide;
+    uniform_int_distribution<Xapian::termcount> small_dist(0, 127);
+    // Docid deltas in a postlist for a term in about 1 in 10 documents.
+    geometric_distribution<Xapian::termcount> delta_dist(0.1);
+    uniform_int_distribution<Xapian::termcount> wide_dist;
+    for (size_t i = 0; i != N; ++i) {
+	small.add(small_dist(gen));
+	deltas.add(delta_dist(gen));
+	wide.add(wide_dist(gen));
+    }
+    bench_unpack_uint("synthetic-1byte", small);
+    bench_unpack_uint("synthetic-deltas", deltas);
+    bench_unpack_uint("synthetic-32bit", wide);
+
+    // Position lists for terms in a 1000 word document, with the number of
+    // occurrences varying from 2 (typical) to 200 (a stopword), and for
+    // stopwords in a 20000 word document.
+    struct {
+	const char* name;
+	int lists;
+	size_t min_n, n_range;
+	Xapian::termpos doc_len;
+    } sets[] = {
+	{ "synthetic-sparse", 20000, 2, 6, 1000 },
+	{ "synthetic-dense", 20000, 50, 150, 1000 },
+	{ "synthetic-long", 1000, 500, 1500, 20000 },
+    };
+    for (auto&& set : sets) {
+	EncodedPositions interp;
+	BlockEncodedPositions block;
+	uniform_int_distribution<Xapian::termpos> pos_dist(1, set.doc_len);
+	for (int i = 0; i != set.lists; ++i) {
+	    size_t n = set.min_n + i % set.n_range;
+	    vector<Xapian::termpos> v;
+	    while (v.size() < n) {
+		v.push_back(pos_dist(gen));
+		if (v.size() == n) {
+		    sort(v.begin(), v.end());
+		    v.erase(unique(v.begin(), v.end()), v.end());
+		}
+	    }
+	    Xapian::VecCOW<Xapian::termpos> pos;
+	    for (auto p : v) pos.push_back(p);
+	    interp.add(pos);
+	    block.add(pos);
+	}
+	report_position_sizes(set.name, interp, block);
+	bench_interpolative(set.name, interp);
+	bench_block_positions(set.name, block);
+    }
+}
+
+/** Benchmark decoding data taken from database @a db.
+ *
+ *  As well as timing iteration through the public API (which exercises the
+ *  backend's chunk readers, e.g. PostlistChunkReader and ValueChunkReader
+ *  for glass), we take real postings and positions from the database and
+ *  time the underlying decoding kernels on them in isolation.
+ *
+ *  @param with_positions  Whether to time decoding positional data.
+ */
+static void
+bench_database(const string& label, const Xapian::Database& db,
+	       bool with_positions = true)
+{
+    // Pick the terms with the longest postlists, which dominate query time.
+    vector<pair<Xapian::doccount, string>> terms;
+    for (auto t = db.allterms_begin(); t != db.allterms_end(); ++t) {
+	terms.emplace_back(t.get_termfreq(), *t);
+    }
+    const size_t MAX_TERMS = 100;
+    if (terms.size() > MAX_TERMS) {
+	nth_element(terms.begin(), terms.begin() + MAX_TERMS, terms.end(),
+		    [](const auto& a, const auto& b) {
+			return a.first > b.first;
+		    });
+	terms.resize(MAX_TERMS);
+    }
+
+    // Collect postings, encoded as in a glass postlist chunk.
+    PackedUInts postings;
+    size_t n_postings = 0;
+    for (auto&& t : terms) {
+	Xapian::docid prev = 0;
+	for (auto p = db.postlist_begin(t.second);
+	     p != db.postlist_end(t.second);
+	     ++p) {
+	    postings.add(*p - prev - 1);
+	    postings.add(p.get_wdf());
+	    prev = *p;
+	    ++n_postings;
+	}
+    }
+    bench_unpack_uint(label, postings);
+
+    run("postlist/" + label, n_postings, postings.data.size(),
+	[&]() {
+	    unsigned long long sum = 0;
+	    for (auto&& t : terms) {
+		for (auto p = db.postlist_begin(t.second);
+		     p != db.postlist_end(t.second);
+		     ++p) {
+		    sum += *p + p.get_wdf();
+		}
+	    }
+	    return sum;
+	});
+
+    if (with_positions) {
+	// Collect position lists for (a sample of) the postings.  We read them
+	// via the PostingIterator as that's how phrase matching accesses them.
+	const size_t MAX_POSITIONS = 1000000;
+	EncodedPositions positions;
+	BlockEncodedPositions block_positions;
+	size_t n_positions = 0;
+	size_t position_bytes = 0;
+	vector<Xapian::doccount> postings_used;
+	for (auto&& t : terms) {
+	    Xapian::doccount n = 0;
+	    for (auto p = db.postlist_begin(t.second);
+		 p != db.postlist_end(t.second) && n_positions < MAX_POSITIONS;
+		 ++p) {
+		Xapian::VecCOW<Xapian::termpos> pos;
+		for (auto i = p.positionlist_begin(); i != p.positionlist_end();
+		     ++i) {
+		    pos.push_back(*i);
+		}
+		++n;
+		if (pos.empty()) continue;
+		n_positions += pos.size();
+		if (pos.size() == 1) {
+		    string enc;
+		    pack_uint(enc, pos[0]);
+		    position_bytes += enc.size();
+		} else {
+		    positions.add(pos);
+		    block_positions.add(pos);
+		    position_bytes += positions.lists.back().size();
+		}
+	    }
+	    postings_used.push_back(n);
+	}
+	report_position_sizes(label, positions, block_positions);
+	bench_interpolative(label, positions);
+	bench_block_positions(label, block_positions);
+
+	run("positionlist/" + label, n_positions, position_bytes,
+	    [&]() {
+		unsigned long long sum = 0;
+		for (size_t j = 0; j != terms.size(); ++j) {
+		    const string& term = terms[j].second;
+		    auto p = db.postlist_begin(term);
+		    for (auto n = postings_used[j]; n; --n, ++p) {
+			for (auto i = p.positionlist_begin();
+			     i != p.positionlist_end();
+			     ++i) {
+			    sum += *i;
+			}
+		    }
+		}
+		return sum;
+	    });
+
+	// Phrase and NEAR queries on pairs of frequent terms, which need to
+	// check positions in many documents.
+	vector<Xapian::Query> queries;
+	for (size_t j = 0; j + 1 < terms.size() && j < 20; j += 2) {
+	    const string& a = terms[j].second;
+	    const string& b = terms[j + 1].second;
+	    queries.emplace_back(Xapian::Query::OP_PHRASE,
+				 Xapian::Query(a), Xapian::Query(b));
+	    queries.emplace_back(Xapian::Query::OP_NEAR,
+				 Xapian::Query(a), Xapian::Query(b));
+	}
+	Xapian::Enquire enq(db);
+	run("phrase/" + label, queries.size(), 0,
+	    [&]() {
+		unsigned long long sum = 0;
+		for (auto&& q : queries) {
+		    enq.set_query(q);
+		    // Check all the candidates so we time the whole match.
+		    Xapian::MSet mset = enq.get_mset(0, 10, db.get_doccount());
+		    sum += mset.get_matches_estimated();
+		}
+		return sum;
+	    });
+    }
+
+    // Stream all the values in each slot.
+    size_t n_values = 0;
+    size_t value_bytes = 0;
+    vector<Xapian::valueno> slots;
+    for (Xapian::valueno slot = 0; slot != 256; ++slot) {
+	Xapian::docid prev = 0;
+	for (auto v = db.valuestream_begin(slot);
+	     v != db.valuestream_end(slot);
+	     ++v) {
+	    string enc;
+	    pack_uint(enc, v.get_docid() - prev - 1);
+	    pack_string(enc, *v);
+	    value_bytes += enc.size();
+	    prev = v.get_docid();
+	    ++n_values;
+	}
+	if (prev) slots.push_back(slot);
+    }
+
+    run("valuestream/" + label, n_values, value_bytes,
+	[&]() {
+	    unsigned long long sum = 0;
+	    for (auto slot : slots) {
+		for (auto v = db.valuestream_begin(slot);
+		     v != db.valuestream_end(slot);
+		     ++v) {
+		    sum += v.get_docid() + (*v).size();
+		}
+	    }
+	    return sum;
+	});
+}
+
+/// Build a synthetic glass database with a Zipfian term distribution.
+static Xapian::Database
+build_synthetic_db(mt19937& gen, Xapian::doccount n_docs)
+{
+    const unsigned VOCAB_SIZE = 20000;
+    vector<double> weights;
+    weights.reserve(VOCAB_SIZE);
+    for (unsigned i = 1; i <= VOCAB_SIZE; ++i) {
+	weights.push_back(1.0 / i);
+    }
+    discrete_distribution<unsigned> term_dist(weights.begin(), weights.end());
+    uniform_int_distribution<unsigned> length_dist(50, 500);
+    uniform_int_distribution<unsigned> date_dist(19700101, 20261231);
+
+    string path = SYNTHETIC_DB_DIR;
+    path += "/glass";
+    Xapian::WritableDatabase wdb(path,
+				 Xapian::DB_CREATE_OR_OVERWRITE |
+				 Xapian::DB_BACKEND_GLASS);
+    for (Xapian::doccount did = 1; did <= n_docs; ++did) {
+	Xapian::Document doc;
+	unsigned len = length_dist(gen);
+	for (Xapian::termpos pos = 1; pos <= len; ++pos) {
+	    doc.add_posting("t" + str(term_dist(gen)), pos);
+	}
+	doc.add_boolean_term("Q" + str(did));
+	doc.add_value(0, str(date_dist(gen)));
+	doc.add_value(1, Xapian::sortable_serialise(len));
+	wdb.replace_document(did, doc);
+    }
+    wdb.commit();
+    return Xapian::Database(path);
+}
+
+int
+main(int argc, char** argv)
+{
+    const char* opts = "d:n:t:";
+    static const struct option long_opts[] = {
+	{"db",		required_argument, 0, 'd'},
+	{"docs",	required_argument, 0, 'n'},
+	{"min-time",	required_argument, 0, 't'},
+	{"help",	no_argument, 0, OPT_HELP},
+	{"version",	no_argument, 0, OPT_VERSION},
+	{NULL,		0, 0, 0}
+    };
+
+    vector<string> dbpaths;
+    Xapian::doccount n_docs = 10000;
+
+    int c;
+    while ((c = gnu_getopt_long(argc, argv, opts, long_opts, 0)) != -1) {
+	switch (c) {
+	    case 'd':
+		dbpaths.push_back(optarg);
+		break;
+	    case 'n':
+		n_docs = Xapian::doccount(atoi(optarg));
+		break;
+	    case 't':
+		min_time = atof(optarg);
+		break;
+	    case OPT_HELP:
+		cout << PROG_NAME " - " PROG_DESC "\n\n";
+		show_usage();
+		exit(0);
+	    case OPT_VERSION:
+		cout << PROG_NAME " - " PACKAGE_STRING "\n";
+		exit(0);
+	    default:
+		show_usage();
+		exit(1);
+	}
+    }
+
+    while (optind < argc) {
+	filters.push_back(argv[optind++]);
+    }
+
+    try {
+	// Use a fixed seed so runs are comparable.
+	mt19937 gen(42);
+
+	bench_synthetic_kernels(gen);
+
+	rm_rf(SYNTHETIC_DB_DIR);
+	if (mkdir(SYNTHETIC_DB_DIR, 0755) < 0) {
+	    cerr << argv[0] << ": Failed to create directory '"
+		 << SYNTHETIC_DB_DIR << "'\n";
+	    exit(1);
+	}
+	Xapian::Database glass_db = build_synthetic_db(gen, n_docs);
+	bench_database("synthetic-glass", glass_db);
+#ifdef XAPIAN_HAS_HONEY_BACKEND
+	string honey_path = SYNTHETIC_DB_DIR;
+	honey_path += "/honey";
+	glass_db.compact(honey_path, Xapian::DB_BACKEND_HONEY);
+	// Honey's position table index currently only discriminates on the
+	// first byte of the key, so each position list lookup is a linear
+	// scan of a large part of the table - that would dominate the run
+	// time so skip positional data here.
+	bench_database("synthetic-honey", Xapian::Database(honey_path), false);
+#endif
+
+	for (auto&& path : dbpaths) {
+	    bench_database(path, Xapian::Database(path));
+	}
+    } catch (const Xapian::Error& e) {
+	cerr << argv[0] << ": " << e.get_description() << '\n';
+	exit(1);
+    }
+}
@@ -573,6 +573,51 @@ static void test_shard1()
     }
 }
 
+static void test_shard2()
+{
+    // Interleaved ShardDocIdMap should match the functions.
+    for (Xapian::doccount n = 1; n != 10; ++n) {
+	ShardDocIdMap docid_map(n);
+	TEST(!docid_map.is_contiguous());
+	for (Xapian::docid did = 1; did != 30; ++did) {
+	    Xapian::doccount shard = docid_map.shard_number(did);
+	    TEST_EQUAL(shard, shard_number(did, n));
+	    TEST_EQUAL(docid_map.shard_docid(did), shard_docid(did, n));
+	    for (Xapian::doccount i = 0; i != n; ++i) {
+		// Count the docids in shard i which map to a docid <= did.
+		Xapian::docid count = 0;
+		for (Xapian::docid d = 1; d <= did; ++d) {
+		    if (shard_number(d, n) == i) ++count;
+		}
+		TEST_EQUAL(docid_map.shard_docid_upto(did, i), count);
+	    }
+	}
+    }
+
+    // Contiguous ShardDocIdMap, with last docids 3, 0, 4 and 2 in the shards
+    // (so shard 1 is empty).
+    vector<Xapian::docid> offsets = { 0, 3, 3, 7 };
+    ShardDocIdMap docid_map(std::move(offsets));
+    TEST(docid_map.is_contiguous());
+    TEST_EQUAL(docid_map.size(), 4);
+    static const Xapian::doccount shards[] = { 0, 0, 0, 2, 2, 2, 2, 3, 3 };
+    for (Xapian::docid did = 1; did != 10; ++did) {
+	Xapian::doccount shard = docid_map.shard_number(did);
+	TEST_EQUAL(shard, shards[did - 1]);
+	Xapian::docid s_did = docid_map.shard_docid(did);
+	TEST(s_did != 0);
+	TEST_EQUAL(docid_map.unshard(s_did, shard), did);
+    }
+    // Docids after the last shard's range are in the last shard.
+    TEST_EQUAL(docid_map.shard_number(100), 3);
+    TEST_EQUAL(docid_map.shard_docid(100), 93);
+    TEST_EQUAL(docid_map.shard_docid_upto(2, 0), 2);
+    TEST_EQUAL(docid_map.shard_docid_upto(2, 2), 0);
+    TEST_EQUAL(docid_map.shard_docid_upto(3, 2), 0);
+    TEST_EQUAL(docid_map.shard_docid_upto(5, 2), 2);
+    TEST_EQUAL(docid_map.shard_docid_upto(7, 3), 0);
+}
+
 static void test_uuid1()
 {
     Uuid uuid, uuid2;
@@ -1031,6 +1076,7 @@ static const test_desc tests[] = {
     TESTCASE(strbool1),
     TESTCASE(closefrom1),
     TESTCASE(shard1),
+    TESTCASE(shard2),
     TESTCASE(uuid1),
     TESTCASE(movesupport1),
     TESTCASE(addoverflows1),
@@ -106,7 +106,7 @@ class Feature::Internal : public Xapian::Internal::intrusive_base {
     }
 
     /// Set the inverse_doc_freq to use for Feature building.
-    void set_inverse_doc_freq(std::map<std::string, double>&& idf) {
+    void set_inverse_doc_freq(const std::map<std::string, double>& idf) {
 	inverse_doc_freq = idf;
     }
 
@@ -119,14 +119,14 @@ class Feature::Internal : public Xapian::Internal::intrusive_base {
     }
 
     /// Set the collection_length to use for Feature building.
-    void set_collection_length(std::map<std::string,
-					Xapian::termcount>&& collection_len) {
+    void set_collection_length(
+	    const std::map<std::string, Xapian::termcount>& collection_len) {
 	collection_length = collection_len;
     }
 
     /// Set the collection_termfreq to use for Feature building.
-    void set_collection_termfreq(std::map<std::string,
-					  Xapian::termcount>&& collection_tf) {
+    void set_collection_termfreq(
+	    const std::map<std::string, Xapian::termcount>& collection_tf) {
 	collection_termfreq = collection_tf;
     }
 };
@@ -30,6 +30,9 @@
 
 #include "debuglog.h"
 #include "omassert.h"
+#include "str.h"
+
+#include <cstdlib>
 
 using namespace std;
 
@@ -81,7 +84,7 @@ FeatureList::normalise(std::vector<FeatureVector>& fvec) const
 	// Find the maximum value of this feature.
 	double max_fval = 0.0;
 	for (const auto& v : fvec) {
-	    max_fval = max(max_fval, v.get_fvals()[j]);
+	    max_fval = max(max_fval, v.get_feature_value(j));
 	}
 
 	if (max_fval == 0.0) {
@@ -107,10 +110,13 @@ FeatureList::create_feature_vectors(const Xapian::MSet & mset,
     std::vector<FeatureVector> fvec;
     Assert(!internal->feature.empty());
 
+    // Statistics which only depend on the query and database are computed
+    // once here rather than for every document.
+    internal->set_data(letor_query, letor_db);
     for (Xapian::MSetIterator i = mset.begin(); i != mset.end(); ++i) {
 	Xapian::Document doc = i.get_document();
 	std::vector<double> fvals;
-	internal->set_data(letor_query, letor_db, doc);
+	internal->set_doc(doc);
 	auto internal_feature = new Feature::Internal(letor_db,
 						      letor_query, doc);
 	// Computes and populates the Feature::Internal with required stats.
@@ -133,4 +139,42 @@ FeatureList::create_feature_vectors(const Xapian::MSet & mset,
     return fvec;
 }
 
+void
+FeatureList::update_collection_stats(Xapian::WritableDatabase & db,
+				     const Xapian::Document & doc,
+				     bool deleting)
+{
+    LOGCALL_STATIC_VOID(API, "FeatureList::update_collection_stats", db | doc | deleting);
+    string title_len_str = db.get_metadata("collection_len_title");
+    if (title_len_str.empty()) {
+	// The statistics will be calculated from scratch when needed.
+	return;
+    }
+
+    Xapian::totallength doc_title_len = 0;
+    Xapian::totallength doc_len = 0;
+    for (auto t = doc.termlist_begin(); t != doc.termlist_end(); ++t) {
+	Xapian::termcount wdf = t.get_wdf();
+	if ((*t)[0] == 'S') doc_title_len += wdf;
+	doc_len += wdf;
+    }
+
+    Xapian::totallength title_len = strtoull(title_len_str.c_str(), NULL, 10);
+    Xapian::totallength whole_len =
+	strtoull(db.get_metadata("collection_len_whole").c_str(), NULL, 10);
+    if (deleting) {
+	title_len -= min(title_len, doc_title_len);
+	whole_len -= min(whole_len, doc_len);
+    } else {
+	title_len += doc_title_len;
+	whole_len += doc_len;
+    }
+    Xapian::totallength body_len =
+	whole_len > title_len ? whole_len - title_len : 0;
+
+    db.set_metadata("collection_len_title", str(title_len));
+    db.set_metadata("collection_len_body", str(body_len));
+    db.set_metadata("collection_len_whole", str(whole_len));
+}
+
 }
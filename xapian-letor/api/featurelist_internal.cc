@@ -38,12 +38,23 @@ using namespace Xapian;
 
 void
 FeatureList::Internal::set_data(const Xapian::Query & letor_query,
-				const Xapian::Database & letor_db,
-				const Xapian::Document & letor_doc)
+				const Xapian::Database & letor_db)
 {
     set_query(letor_query);
-    set_doc(letor_doc);
     set_database(letor_db);
+
+    query_terms.assign(featurelist_query.get_unique_terms_begin(),
+		       featurelist_query.get_terms_end());
+
+    if (stats_needed & INVERSE_DOCUMENT_FREQUENCY) {
+	query_inverse_doc_freq = compute_inverse_doc_freq();
+    }
+    if (stats_needed & COLLECTION_LENGTH) {
+	query_collection_length = compute_collection_length();
+    }
+    if (stats_needed & COLLECTION_TERM_FREQ) {
+	query_collection_termfreq = compute_collection_termfreq();
+    }
 }
 
 std::map<std::string, Xapian::termcount>
@@ -52,11 +63,12 @@ FeatureList::Internal::compute_termfreq() const
     std::map<std::string, Xapian::termcount> tf;
 
     Xapian::TermIterator docterms = featurelist_doc.termlist_begin();
-    for (Xapian::TermIterator qt = featurelist_query.get_unique_terms_begin();
-	 qt != featurelist_query.get_terms_end(); ++qt) {
-	docterms.skip_to(*qt);
-	if (docterms != featurelist_doc.termlist_end() && *qt == *docterms)
-	    tf[*qt] = docterms.get_wdf();
+    for (const string& qt : query_terms) {
+	docterms.skip_to(qt);
+	if (docterms == featurelist_doc.termlist_end())
+	    break;
+	if (qt == *docterms)
+	    tf[qt] = docterms.get_wdf();
     }
     return tf;
 }
@@ -67,11 +79,10 @@ FeatureList::Internal::compute_inverse_doc_freq() const
     std::map<std::string, double> idf;
     Xapian::doccount totaldocs = featurelist_db.get_doccount();
 
-    for (Xapian::TermIterator qt = featurelist_query.get_unique_terms_begin();
-	 qt != featurelist_query.get_terms_end(); ++qt) {
-	Xapian::doccount df = featurelist_db.get_termfreq(*qt);
+    for (const string& qt : query_terms) {
+	Xapian::doccount df = featurelist_db.get_termfreq(qt);
 	if (df != 0)
-	    idf[*qt] = log10((double)totaldocs / (double)(1 + df));
+	    idf[qt] = log10((double)totaldocs / (double)(1 + df));
     }
     return idf;
 }
@@ -105,29 +116,23 @@ FeatureList::Internal::compute_collection_length() const
 {
     std::map<std::string, Xapian::termcount> len;
 
-    if (!featurelist_db.get_metadata("collection_len_title").empty() &&
-	!featurelist_db.get_metadata("collection_len_body").empty() &&
-	!featurelist_db.get_metadata("collection_len_whole").empty()) {
-	len["title"] =
-	    atol(featurelist_db.get_metadata("collection_len_title").c_str());
-	len["body"] =
-	    atol(featurelist_db.get_metadata("collection_len_body").c_str());
-	len["whole"] =
-	    atol(featurelist_db.get_metadata("collection_len_whole").c_str());
+    Xapian::termcount title_len = 0;
+    string title_len_str = featurelist_db.get_metadata("collection_len_title");
+    if (!title_len_str.empty()) {
+	title_len = atol(title_len_str.c_str());
     } else {
-	Xapian::termcount title_len = 0;
 	Xapian::TermIterator dt = featurelist_db.allterms_begin("S");
 	for ( ; dt != featurelist_db.allterms_end("S"); ++dt) {
 	    //  because we don't want the unique terms so we want their
 	    // original frequencies and i.e. the total size of the title collection.
 	    title_len += featurelist_db.get_collection_freq(*dt);
 	}
-	len["title"] = title_len;
-	Xapian::termcount whole_len = featurelist_db.get_avlength() *
-		featurelist_db.get_doccount();
-	len["whole"] = whole_len;
-	len["body"] = whole_len - title_len;
     }
+    len["title"] = title_len;
+    // The total length is tracked by the database, so is always current.
+    Xapian::termcount whole_len = featurelist_db.get_total_length();
+    len["whole"] = whole_len;
+    len["body"] = whole_len > title_len ? whole_len - title_len : 0;
     return len;
 }
 
@@ -136,11 +141,10 @@ FeatureList::Internal::compute_collection_termfreq() const
 {
     std::map<std::string, Xapian::termcount> tf;
 
-    for (Xapian::TermIterator qt = featurelist_query.get_unique_terms_begin();
-	 qt != featurelist_query.get_terms_end(); ++qt) {
-	Xapian::termcount coll_tf = featurelist_db.get_collection_freq(*qt);
+    for (const string& qt : query_terms) {
+	Xapian::termcount coll_tf = featurelist_db.get_collection_freq(qt);
 	if (coll_tf != 0)
-	    tf[*qt] = coll_tf;
+	    tf[qt] = coll_tf;
     }
     return tf;
 }
@@ -153,16 +157,15 @@ FeatureList::Internal::populate_feature_internal(Feature::Internal*
 	internal_feature->set_termfreq(compute_termfreq());
     }
     if (stats_needed & INVERSE_DOCUMENT_FREQUENCY) {
-	internal_feature->set_inverse_doc_freq(compute_inverse_doc_freq());
+	internal_feature->set_inverse_doc_freq(query_inverse_doc_freq);
     }
     if (stats_needed & DOCUMENT_LENGTH) {
 	internal_feature->set_doc_length(compute_doc_length());
     }
     if (stats_needed & COLLECTION_LENGTH) {
-	internal_feature->set_collection_length(compute_collection_length());
+	internal_feature->set_collection_length(query_collection_length);
     }
     if (stats_needed & COLLECTION_TERM_FREQ) {
-	internal_feature->set_collection_termfreq(
-			  compute_collection_termfreq());
+	internal_feature->set_collection_termfreq(query_collection_termfreq);
     }
 }
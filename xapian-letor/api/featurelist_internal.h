@@ -28,6 +28,8 @@
 #include "api/feature_internal.h"
 
 #include <map>
+#include <string>
+#include <vector>
 
 namespace Xapian {
 
@@ -61,6 +63,23 @@ class FeatureList::Internal : public Xapian::Internal::intrusive_base {
     /// Xapian::Document using which features will be calculated.
     Document featurelist_doc;
 
+    /// The unique terms in the query, in ascending order.
+    std::vector<std::string> query_terms;
+
+    /** Inverse document frequencies of the query terms.
+     *
+     *  This and the other statistics which only depend on the query and
+     *  database are calculated once by set_data() and shared by the
+     *  features of all the documents.
+     */
+    std::map<std::string, double> query_inverse_doc_freq;
+
+    /// Collection lengths of the database.
+    std::map<std::string, Xapian::termcount> query_collection_length;
+
+    /// Collection frequencies of the query terms.
+    std::map<std::string, Xapian::termcount> query_collection_termfreq;
+
     /** This method finds the frequency of the query terms in the
      *  specified documents.
      *
@@ -107,9 +126,11 @@ class FeatureList::Internal : public Xapian::Internal::intrusive_base {
     /** This method calculates the length of the collection in number of terms
      *  for different parts like 'title', 'body' and 'whole'.
      *
-     *  This is calculated as a stored user metadata in omindex otherwise
-     *  it is calculated out of scratch
-     *  (this might take some time depending upon the size of the database).
+     *  The length of the titles is read from the user metadata stored by
+     *  xapian-letor-update (and kept up to date by
+     *  FeatureList::update_collection_stats()) if it's present, otherwise
+     *  it is calculated from scratch (this might take some time depending
+     *  upon the size of the database).
      *
      *  This method is a helper method and statistics gathered through
      *  this method are used in feature value calculation.
@@ -152,14 +173,6 @@ class FeatureList::Internal : public Xapian::Internal::intrusive_base {
 	featurelist_query = query;
     }
 
-    /** Specify the document to use for feature building.
-     *
-     *  This will be used by the Internal class.
-     */
-    void set_doc(const Xapian::Document& doc) {
-	featurelist_doc = doc;
-    }
-
     /// Computes and populates the stats needed by a Feature.
     void populate_feature_internal(Feature::Internal* internal_feature);
 
@@ -170,10 +183,19 @@ class FeatureList::Internal : public Xapian::Internal::intrusive_base {
      */
     std::vector<Feature *> feature;
 
-    /// This method sets all the data members required for computing stats.
+    /** Set the query and database, and compute the statistics which only
+     *  depend on them.
+     */
     void set_data(const Xapian::Query& query,
-		  const Xapian::Database& db,
-		  const Xapian::Document& doc);
+		  const Xapian::Database& db);
+
+    /** Specify the document to use for feature building.
+     *
+     *  This will be used by the Internal class.
+     */
+    void set_doc(const Xapian::Document& doc) {
+	featurelist_doc = doc;
+    }
 };
 
 }
@@ -203,10 +203,11 @@ try {
 	cout << *i << ": [" << i.get_weight() << "]\n" << data << "\n";
     }
 
-    // Initialise Ranker object with ListNETRanker instance, db path and query.
+    // Initialise Ranker object with ListNETRanker instance, db and query.
     // See Ranker documentation for available Ranker subclass options.
     Xapian::Ranker * ranker = new Xapian::ListNETRanker();
     ranker->set_database_path(db_path);
+    ranker->set_database(db);
     ranker->set_query(query);
 
     // Re-rank the existing mset using the letor model.
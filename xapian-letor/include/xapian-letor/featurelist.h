@@ -90,6 +90,26 @@ class XAPIAN_VISIBILITY_DEFAULT FeatureList {
 			   const Xapian::Query & letor_query,
 			   const Xapian::Database & letor_db) const;
 
+    /** Update the collection statistics stored in a database for a document.
+     *
+     *  xapian-letor-update stores collection statistics as user metadata so
+     *  that create_feature_vectors() doesn't need to scan the database to
+     *  calculate them.  Calling this method for each document added to or
+     *  deleted from the database keeps the stored statistics up to date
+     *  without having to rerun xapian-letor-update.  If the statistics
+     *  haven't been stored in @a db, this method does nothing.
+     *
+     *  To replace a document, call this method for the old version with
+     *  @a deleting true, and then for the new version.
+     *
+     *  @param db	The database being updated.
+     *  @param doc	The document being added or deleted.
+     *  @param deleting	true if @a doc is being deleted (default: false).
+     */
+    static void update_collection_stats(Xapian::WritableDatabase & db,
+					const Xapian::Document & doc,
+					bool deleting = false);
+
   private:
     /// Perform query-level normalisation of FeatureVectors.
     void normalise(std::vector<FeatureVector> & fvec) const;
@@ -93,8 +93,16 @@ prepare_training_file(const std::string & db_path,
 class XAPIAN_VISIBILITY_DEFAULT Ranker : public Xapian::Internal::intrusive_base {
     /// Path to Xapian::Database instance to be used.
     std::string db_path;
+    /// Open Xapian::Database to use (if set_database() has been called).
+    Xapian::Database ranker_db;
+    /// Has set_database() been called?
+    bool have_db = false;
     /// Xapian::Query to be ranked using Ranking model.
     Xapian::Query letor_query;
+    /// Metadata key of the currently loaded model.
+    std::string loaded_model_key;
+    /// Is a model currently loaded?
+    bool model_loaded = false;
 
   public:
     /// Default constructor
@@ -115,6 +123,16 @@ class XAPIAN_VISIBILITY_DEFAULT Ranker : public Xapian::Internal::intrusive_base
      */
     std::string get_database_path();
 
+    /** Specify an open Xapian::Database to be used for ranking.
+     *
+     *  Without this, rank() opens the database at the path specified by
+     *  set_database_path() each time it's called.  The path is still used
+     *  to save the model in train_model().
+     *
+     *  @param  db	Xapian::Database to be used.
+     */
+    void set_database(const Xapian::Database & db);
+
     /** Specify Xapian::Query that is to be used for ranking.
      *
      *  @param  query      Xapian::Query to be ranked using ranking model.
@@ -138,6 +156,21 @@ class XAPIAN_VISIBILITY_DEFAULT Ranker : public Xapian::Internal::intrusive_base
     void train_model(const std::string & input_filename,
 		     const std::string & model_key = std::string());
 
+    /** Load the model from the database's metadata.
+     *
+     *  rank() loads the model the first time it's needed, and then reuses it
+     *  for further calls with the same @a model_key, so it's only necessary
+     *  to call this method to load a model which has been updated since.
+     *  If you've specified a database with set_database(), you'll need to
+     *  call Xapian::Database::reopen() on it first to see the update.
+     *
+     *  @param  model_key	Metadata key using which the model is to be
+     *				loaded. If no model_key is supplied, ranker
+     *				subclass uses its default key
+     *				e.g. ListNET_default_key.
+     */
+    void load_model(const std::string & model_key = std::string());
+
     /** Ranking function.
      *
      *  Re-ranks the initial mset using trained model.
@@ -191,6 +224,13 @@ class XAPIAN_VISIBILITY_DEFAULT Ranker : public Xapian::Internal::intrusive_base
 	       const Xapian::FeatureList & flist = Xapian::FeatureList());
 
   protected:
+    /** Get the Xapian::Database to use.
+     *
+     *  This is the database set by set_database() if there is one, or else
+     *  the database at the path set by set_database_path().
+     */
+    Xapian::Database get_database() const;
+
     /// Method to train the model. Overridden in ranker subclass.
     virtual void
     train(const std::vector<std::vector<FeatureVector>>& training_data) = 0;
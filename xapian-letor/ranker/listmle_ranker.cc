@@ -54,9 +54,37 @@ label_comparer(const FeatureVector& firstfv,
     return firstfv.get_label() > secondfv.get_label();
 }
 
+namespace {
+
+/** The training data for one query, with the feature values contiguous.
+ *
+ *  The documents are sorted by descending label, which only needs doing
+ *  once rather than on every iteration.
+ */
+struct QueryList {
+    /// Number of documents.
+    size_t size;
+
+    /// Feature values of the documents, one row of fcount per document.
+    vector<double> fvals;
+
+    QueryList(vector<FeatureVector> feature_vectors, size_t fcount)
+	: size(feature_vectors.size())
+    {
+	sort(feature_vectors.begin(), feature_vectors.end(), label_comparer);
+	fvals.reserve(size * fcount);
+	for (auto&& v : feature_vectors) {
+	    const vector<double>& v_fvals = v.get_fvals();
+	    fvals.insert(fvals.end(), v_fvals.begin(), v_fvals.end());
+	}
+    }
+};
+
+}
+
 static double
 calculate_inner_product(const vector<double>& parameters,
-			const vector<double>& feature_sets)
+			const double* feature_sets)
 {
     double inner_product = 0.0;
     for (size_t i = 0; i < parameters.size(); ++i) {
@@ -65,40 +93,42 @@ calculate_inner_product(const vector<double>& parameters,
     return inner_product;
 }
 
-static vector<double>
-calculate_gradient(const vector<FeatureVector>& sorted_feature_vectors,
-		   const vector<double>& new_parameters)
+static void
+calculate_gradient(const QueryList& sorted_list,
+		   const vector<double>& new_parameters,
+		   vector<double>& exponents,
+		   vector<double>& gradient)
 {
-    vector<double> gradient(sorted_feature_vectors[0].get_fcount(), 0);
+    size_t fcount = gradient.size();
+    fill(gradient.begin(), gradient.end(), 0.0);
 
-    size_t list_length = sorted_feature_vectors.size();
+    size_t list_length = sorted_list.size;
 
-    vector<double> exponents;
+    exponents.resize(list_length);
     double expsum = 0.0;
 
+    const double* fvals = sorted_list.fvals.data();
     for (size_t i = 0; i < list_length; ++i) {
-	const auto& fvals = sorted_feature_vectors[i].get_fvals();
 	double exponent = exp(calculate_inner_product(new_parameters, fvals));
-	exponents.push_back(exponent);
+	exponents[i] = exponent;
 	expsum += exponent;
+	fvals += fcount;
     }
 
+    fvals = sorted_list.fvals.data();
     for (size_t i = 0; i < list_length; ++i) {
-	vector<double> feature_sets = sorted_feature_vectors[i].get_fvals();
-	for (size_t j = 0; j < feature_sets.size() - 1; ++j) {
-	    gradient[j] += feature_sets[j] * exponents[i] / expsum;
+	for (size_t j = 0; j < fcount - 1; ++j) {
+	    gradient[j] += fvals[j] * exponents[i] / expsum;
 	}
+	fvals += fcount;
     }
 
-    vector<double> first_place_in_ground_truth_feature_sets =
-	    sorted_feature_vectors[0].get_fvals();
+    const double* first_place_in_ground_truth_feature_sets =
+	    sorted_list.fvals.data();
 
-    for (size_t i = 0; i < first_place_in_ground_truth_feature_sets.size() - 1;
-	 ++i) {
+    for (size_t i = 0; i < fcount - 1; ++i) {
 	gradient[i] -= first_place_in_ground_truth_feature_sets[i];
     }
-
-    return gradient;
 }
 
 static void
@@ -112,19 +142,6 @@ update_parameters(vector<double>& new_parameters,
     }
 }
 
-/* Updates new_parameters after calculating the gradient.
- * new_parameters(w) is updated as: w = w - gradient * learningRate
- */
-static void
-batch_learning(vector<FeatureVector> feature_vectors,
-	       vector<double> & new_parameters,
-	       double learning_rate)
-{
-    sort(feature_vectors.begin(), feature_vectors.end(), label_comparer);
-    const auto& gradient = calculate_gradient(feature_vectors, new_parameters);
-    update_parameters(new_parameters, gradient, learning_rate);
-}
-
 void
 ListMLERanker::train(const vector<vector<FeatureVector>>& training_data)
 {
@@ -150,9 +167,23 @@ ListMLERanker::train(const vector<vector<FeatureVector>>& training_data)
 	}
     }
 
+    // Convert the training data to contiguous arrays sorted by label once,
+    // rather than copying and sorting the FeatureVectors on every
+    // iteration.
+    vector<QueryList> lists;
+    lists.reserve(training_data.size());
+    for (auto& item : training_data) {
+	if (!item.empty())
+	    lists.emplace_back(item, feature_cnt);
+    }
+
+    vector<double> exponents;
+    vector<double> gradient(feature_cnt);
     for (int iter_num = 1; iter_num <= iterations; ++iter_num) {
-	for (auto& item : training_data) {
-	    batch_learning(item, new_parameters, learning_rate);
+	for (auto& list : lists) {
+	    // Update new_parameters(w) as: w = w - gradient * learningRate
+	    calculate_gradient(list, new_parameters, exponents, gradient);
+	    update_parameters(new_parameters, gradient, learning_rate);
 	}
     }
 
@@ -178,7 +209,7 @@ void
 ListMLERanker::load_model_from_metadata(const string& model_key)
 {
     LOGCALL_VOID(API, "ListMLERanker::load_model_from_metadata", model_key);
-    Database letor_db(get_database_path());
+    Database letor_db = get_database();
     string key = model_key;
     if (key.empty()) {
 	key = "ListMLE.model.default";
@@ -45,75 +45,95 @@
 using namespace std;
 using namespace Xapian;
 
-/// A vector holding ground truth and prediction score probability distribution vectors.
-typedef vector<vector<double>> prob_distrib_vector;
-
 ListNETRanker::~ListNETRanker() {
     LOGCALL_DTOR(API, "ListNETRanker");
 }
 
+namespace {
+
+/// The training data for one query, with the feature values contiguous.
+struct QueryList {
+    /// Number of documents.
+    size_t size;
+
+    /// Feature values of the documents, one row of fcount per document.
+    vector<double> fvals;
+
+    /** Ground truth probability distribution.
+     *
+     *  This only depends on the labels, so is calculated once.
+     */
+    vector<double> prob_y;
+
+    QueryList(const vector<FeatureVector>& feature_vectors, size_t fcount)
+	: size(feature_vectors.size())
+    {
+	fvals.reserve(size * fcount);
+	prob_y.reserve(size);
+	double expsum_y = 0.0;
+	for (auto&& v : feature_vectors) {
+	    const vector<double>& v_fvals = v.get_fvals();
+	    fvals.insert(fvals.end(), v_fvals.begin(), v_fvals.end());
+	    expsum_y += exp(v.get_label());
+	}
+	for (auto&& v : feature_vectors) {
+	    prob_y.push_back(exp(v.get_label()) / expsum_y);
+	}
+    }
+};
+
+}
+
 static double
-calculate_inner_product(const vector<double> &parameters, const vector<double> &fvals) {
-    LOGCALL_STATIC_VOID(API, "calculate_inner_product", parameters | fvals);
+calculate_inner_product(const vector<double> &parameters, const double* fvals) {
     double inner_product = 0.0;
-    for (size_t i = 0; i < fvals.size(); ++i)
+    for (size_t i = 0; i < parameters.size(); ++i)
 	inner_product += parameters[i] * fvals[i];
     return inner_product;
 }
 
 // From Theorem (8) in Cao et al. "Learning to rank: from pairwise approach to listwise approach."
-static prob_distrib_vector
-init_probability(const vector<FeatureVector> &feature_vectors, const vector<double> &new_parameters) {
-    LOGCALL_STATIC_VOID(API, "init_probability", feature_vectors | new_parameters);
-
-    // probability distribution, y is ground truth, while z is predict score
-    vector<double> prob_y;
-    vector<double> prob_z;
-    double expsum_y = 0.0;
+static void
+calculate_prob_z(const QueryList& list, const vector<double> &new_parameters,
+		 vector<double>& prob_z) {
+    // Probability distribution of the predicted scores.
+    size_t fcount = new_parameters.size();
+    prob_z.resize(list.size);
     double expsum_z = 0.0;
-
-    for (auto&& v : feature_vectors) {
-	expsum_y += exp(v.get_label());
-	expsum_z += exp(calculate_inner_product(new_parameters, v.get_fvals()));
+    const double* fvals = list.fvals.data();
+    for (size_t i = 0; i < list.size; ++i) {
+	prob_z[i] = exp(calculate_inner_product(new_parameters, fvals));
+	expsum_z += prob_z[i];
+	fvals += fcount;
     }
-    for (auto&& v : feature_vectors) {
-	prob_y.push_back(exp(v.get_label()) / expsum_y);
-	prob_z.push_back(exp(calculate_inner_product(new_parameters, v.get_fvals())) / expsum_z);
+    for (auto& z : prob_z) {
+	z /= expsum_z;
     }
-    vector<vector<double>> prob;
-    prob.push_back(prob_y);
-    prob.push_back(prob_z);
-    return prob;
 }
 
 // Equation (6) in paper Cao et al. "Learning to rank: from pairwise approach to listwise approach."
-static vector<double>
-calculate_gradient(const vector<FeatureVector> &feature_vectors, const prob_distrib_vector &prob) {
-    LOGCALL_STATIC_VOID(API, "calculate_gradient", feature_vectors | prob);
-
-    vector<double> gradient(feature_vectors[0].get_fcount(), 0);
-
-    // Hold ground truth probability distribution
-    const vector<double> prob_y(prob[0]);
-    // Hold prediction score probability distribution
-    const vector<double> prob_z(prob[1]);
-
-    for (size_t i = 0; i < feature_vectors.size(); ++i) {
-	vector<double> fvals = feature_vectors[i].get_fvals();
-	for (size_t k = 0; k < fvals.size(); ++k) {
-	    double first_term = - prob_y[i] * fvals[k];
+static void
+calculate_gradient(const QueryList& list, const vector<double> &prob_z,
+		   vector<double>& gradient) {
+    size_t fcount = gradient.size();
+    fill(gradient.begin(), gradient.end(), 0.0);
+    const double* fvals = list.fvals.data();
+    for (size_t i = 0; i < list.size; ++i) {
+	double y = list.prob_y[i];
+	double z = prob_z[i];
+	for (size_t k = 0; k < fcount; ++k) {
+	    double first_term = - y * fvals[k];
 	    gradient[k] += first_term;
 
-	    double second_term = prob_z[i] * fvals[k];
+	    double second_term = z * fvals[k];
 	    gradient[k] += second_term;
 	}
+	fvals += fcount;
     }
-    return gradient;
 }
 
 static void
 update_parameters(vector<double> &new_parameters, const vector<double> &gradient, double learning_rate) {
-    LOGCALL_STATIC_VOID(API, "update_parameters", new_parameters | gradient | learning_rate);
     for (size_t i = 0; i < new_parameters.size(); ++i) {
 	new_parameters[i] -= gradient[i] * learning_rate;
     }
@@ -147,15 +167,28 @@ ListNETRanker::train(const vector<vector<Xapian::FeatureVector>>& training_data)
 	    }
 	}
     }
+
+    // Convert the training data to contiguous arrays once, rather than
+    // copying the feature values out of each FeatureVector on every
+    // iteration.
+    vector<QueryList> lists;
+    lists.reserve(training_data.size());
+    for (auto& item : training_data) {
+	if (!item.empty())
+	    lists.emplace_back(item, feature_cnt);
+    }
+
+    vector<double> prob_z;
+    vector<double> gradient(feature_cnt);
     // iterations
     for (int iter_num = 1; iter_num <= iterations; ++iter_num) {
-	for (auto& item : training_data) {
-	    // Initialize probability distributions of y and z.
-	    prob_distrib_vector prob = init_probability(item, new_parameters);
+	for (auto& list : lists) {
+	    // Calculate the probability distribution of the predicted scores.
+	    calculate_prob_z(list, new_parameters, prob_z);
 	    // Compute gradient
-	    vector<double> gradient = calculate_gradient(item, prob);
+	    calculate_gradient(list, prob_z, gradient);
 	    // Normalize gradient
-	    normalize(gradient, item.size());
+	    normalize(gradient, list.size);
 	    // Update parameters: w = w - gradient * learningRate
 	    update_parameters(new_parameters, gradient, learning_rate);
 	}
@@ -180,7 +213,7 @@ ListNETRanker::save_model_to_metadata(const string & model_key) {
 void
 ListNETRanker::load_model_from_metadata(const string & model_key) {
     LOGCALL_VOID(API, "ListNETRanker::load_model_from_metadata", model_key);
-    Xapian::Database letor_db(get_database_path());
+    Xapian::Database letor_db = get_database();
     string key = model_key;
     if (key.empty()) {
 	key = "ListNET.model.default";
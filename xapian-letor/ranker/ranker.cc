@@ -335,6 +335,25 @@ Ranker::set_database_path(const string & dbpath)
 {
     LOGCALL_VOID(API, "Ranker::set_database_path", dbpath);
     db_path = dbpath;
+    model_loaded = false;
+}
+
+void
+Ranker::set_database(const Xapian::Database & db)
+{
+    LOGCALL_VOID(API, "Ranker::set_database", db);
+    ranker_db = db;
+    have_db = true;
+    model_loaded = false;
+}
+
+Xapian::Database
+Ranker::get_database() const
+{
+    LOGCALL(API, Xapian::Database, "Ranker::get_database", NO_ARGS);
+    if (have_db)
+	RETURN(ranker_db);
+    RETURN(Xapian::Database(db_path));
 }
 
 std::string
@@ -389,8 +408,10 @@ Ranker::rank(Xapian::MSet & mset, const string & model_key, const Xapian::Featur
     if (mset.empty()) {
 	return;
     }
-    std::vector<FeatureVector> fvv = flist.create_feature_vectors(mset, letor_query, Xapian::Database(db_path));
-    load_model_from_metadata(model_key);
+    std::vector<FeatureVector> fvv = flist.create_feature_vectors(mset, letor_query, get_database());
+    if (!model_loaded || model_key != loaded_model_key) {
+	load_model(model_key);
+    }
     std::vector<FeatureVector> rankedfvv = rank_fvv(fvv);
     mset.replace_weights(ScoreIterator(rankedfvv.begin()), ScoreIterator(rankedfvv.end()));
     mset.sort_by_relevance();
@@ -401,8 +422,22 @@ Ranker::train_model(const std::string & input_filename, const std::string & mode
 {
     LOGCALL_VOID(API, "Ranker::train_model", input_filename | model_key);
     vector<vector<FeatureVector>> list_fvecs = load_list_fvecs(input_filename);
+    model_loaded = false;
     train(list_fvecs);
     save_model_to_metadata(model_key);
+    // The model we've just trained is the one stored under model_key.
+    loaded_model_key = model_key;
+    model_loaded = true;
+}
+
+void
+Ranker::load_model(const std::string & model_key)
+{
+    LOGCALL_VOID(API, "Ranker::load_model", model_key);
+    model_loaded = false;
+    load_model_from_metadata(model_key);
+    loaded_model_key = model_key;
+    model_loaded = true;
 }
 
 void
@@ -411,9 +446,9 @@ Ranker::score(const string & query_file, const string & qrel_file,
       Xapian::doccount msetsize, const string & scorer_type, const Xapian::FeatureList & flist)
 {
     // Set db
-    Xapian::Database letor_db(db_path);
+    Xapian::Database score_db = get_database();
     // Load ranker model
-    load_model_from_metadata(model_key);
+    load_model(model_key);
     // Set scorer
     Xapian::Internal::intrusive_ptr<Scorer> scorer;
     if (scorer_type == "NDCGScore") {
@@ -424,7 +459,7 @@ Ranker::score(const string & query_file, const string & qrel_file,
 	throw LetorInternalError("Invalid Scorer type.");
     }
 
-    Xapian::QueryParser parser = initialise_queryparser(letor_db);
+    Xapian::QueryParser parser = initialise_queryparser(score_db);
 
     qrel = load_relevance(qrel_file);
 
@@ -462,12 +497,12 @@ Ranker::score(const string & query_file, const string & qrel_file,
 	// Combine queries
 	Xapian::Query query = Xapian::Query(Xapian::Query::OP_OR, query_no_prefix, query_default_prefix);
 
-	Xapian::Enquire enquire(letor_db);
+	Xapian::Enquire enquire(score_db);
 	enquire.set_query(query);
 	Xapian::MSet mset = enquire.get_mset(0, msetsize);
 
 	rank(mset, model_key, flist);
-	std::vector<FeatureVector> fvv_mset = flist.create_feature_vectors(mset, query, letor_db);
+	std::vector<FeatureVector> fvv_mset = flist.create_feature_vectors(mset, query, score_db);
 	std::vector<FeatureVector> rankedfvv_qrel;
 
 	int k = 0;
@@ -33,6 +33,7 @@
 #include "apitest.h"
 #include "filetests.h"
 #include "safeunistd.h"
+#include "str.h"
 #include "testutils.h"
 
 using namespace std;
@@ -513,6 +514,46 @@ DEFINE_TESTCASE(preparetrainingfilethree, path)
     unlink("training_output_three_correct.txt");
 }
 
+/// Check a Ranker can be reused with an open database.
+DEFINE_TESTCASE(ranker_reuse1, path && writable)
+{
+    string db_path = get_database_path("db_index_two_documents",
+				       db_index_two_documents);
+    string training_data = test_driver::get_srcdir() +
+			   "/testdata/training_data.txt";
+    {
+	Xapian::ListNETRanker trainer;
+	trainer.set_database_path(db_path);
+	trainer.train_model(training_data, "ListNet_Ranker");
+    }
+
+    Xapian::Database db(db_path);
+    Xapian::Enquire enquire(db);
+    enquire.set_query(Xapian::Query("lions"));
+    Xapian::MSet expected = enquire.get_mset(0, 10);
+    Xapian::ListNETRanker fresh;
+    fresh.set_database_path(db_path);
+    fresh.set_query(Xapian::Query("lions"));
+    fresh.rank(expected, "ListNet_Ranker");
+
+    Xapian::ListNETRanker ranker;
+    ranker.set_database(db);
+    ranker.set_query(Xapian::Query("lions"));
+    // No model is stored under this key.
+    TEST_EXCEPTION(Xapian::LetorInternalError,
+		   ranker.load_model("no_such_model"));
+    ranker.load_model("ListNet_Ranker");
+    for (int i = 0; i != 3; ++i) {
+	Xapian::MSet mset = enquire.get_mset(0, 10);
+	ranker.rank(mset, "ListNet_Ranker");
+	TEST_EQUAL(mset.size(), expected.size());
+	for (Xapian::doccount j = 0; j != mset.size(); ++j) {
+	    TEST_EQUAL(*mset[j], *expected[j]);
+	    TEST_EQUAL_DOUBLE(mset[j].get_weight(), expected[j].get_weight());
+	}
+    }
+}
+
 // ListNet_Ranker check
 DEFINE_TESTCASE(listnet_ranker, path && writable)
 {
@@ -1415,6 +1456,62 @@ class CustomFeature : public Xapian::Feature {
     }
 };
 
+/// Check stored collection statistics are used and kept up to date.
+DEFINE_TESTCASE(collectionstats1, writable && !multi) {
+    Xapian::WritableDatabase db = get_writable_database();
+    db_index_three_documents(db, string());
+
+    // No statistics are stored yet, so this should do nothing.
+    Xapian::Document doc;
+    doc.add_term("Sscore", 2);
+    doc.add_term("score", 3);
+    Xapian::FeatureList::update_collection_stats(db, doc);
+    TEST(db.get_metadata("collection_len_title").empty());
+
+    vector<Xapian::Feature*> f;
+    f.push_back(new Xapian::CollTfCollLenFeature());
+    Xapian::FeatureList fl(f);
+    Xapian::Query query(Xapian::Query::OP_OR,
+			Xapian::Query("Sscore"), Xapian::Query("score"));
+    Xapian::Enquire enquire(db);
+    enquire.set_query(query);
+    Xapian::MSet mset = enquire.get_mset(0, 10);
+    auto fv_scan = fl.create_feature_vectors(mset, query, db);
+
+    // Store the statistics as xapian-letor-update does.
+    Xapian::termcount title_len = 0;
+    for (auto t = db.allterms_begin("S"); t != db.allterms_end("S"); ++t) {
+	title_len += db.get_collection_freq(*t);
+    }
+    Xapian::totallength total_len = db.get_total_length();
+    db.set_metadata("collection_len_title", str(title_len));
+    db.set_metadata("collection_len_body", str(total_len - title_len));
+    db.set_metadata("collection_len_whole", str(total_len));
+    db.commit();
+
+    auto fv_stored = fl.create_feature_vectors(mset, query, db);
+    TEST_EQUAL(fv_stored.size(), fv_scan.size());
+    for (size_t i = 0; i != fv_scan.size(); ++i) {
+	TEST(fv_stored[i].get_fvals() == fv_scan[i].get_fvals());
+    }
+
+    // Adding a document updates the stored statistics.
+    Xapian::FeatureList::update_collection_stats(db, doc);
+    db.add_document(doc);
+    TEST_EQUAL(db.get_metadata("collection_len_title"), str(title_len + 2));
+    TEST_EQUAL(db.get_metadata("collection_len_whole"), str(total_len + 5));
+    TEST_EQUAL(db.get_metadata("collection_len_body"),
+	       str(total_len - title_len + 3));
+
+    // And deleting it restores them.
+    Xapian::FeatureList::update_collection_stats(db, doc, true);
+    db.delete_document(db.get_lastdocid());
+    TEST_EQUAL(db.get_metadata("collection_len_title"), str(title_len));
+    TEST_EQUAL(db.get_metadata("collection_len_whole"), str(total_len));
+    TEST_EQUAL(db.get_metadata("collection_len_body"),
+	       str(total_len - title_len));
+}
+
 DEFINE_TESTCASE(populatefeature, backend) {
     XFAIL_FOR_BACKEND("multi", "Testcase fails with multidatabase");
     vector<Xapian::Feature*> f;